@@ -0,0 +1,57 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "OrderBook.h"
+
+// Usage: BenchArenaStartup [arena size in MB]
+// Builds an OrderBook per paging/warmup combination and reports what the arena cost at startup
+// so the trade off can be picked per instrument
+int main(int argc, char* argv[]) {
+    const size_t arenaMegabytes {argc > 1 ? std::stoull(argv[1]) : 1024};
+
+    constexpr std::array<std::pair<ArenaPaging, const char*>, 3> pagings{{
+        {ArenaPaging::Default, "4K"},
+        {ArenaPaging::TransparentHugePages, "THP"},
+        {ArenaPaging::HugePages, "HUGETLB"},
+    }};
+
+    constexpr std::array<std::pair<ArenaWarmup, const char*>, 3> warmups{{
+        {ArenaWarmup::None, "none"},
+        {ArenaWarmup::Prefault, "prefault"},
+        {ArenaWarmup::PrefaultAndLock, "prefault+mlock"},
+    }};
+
+    std::cout << std::format("Arena size: {} MB\n", arenaMegabytes);
+    std::cout << std::format("{:>8} | {:>15} | {:>12} | {:>12} | {:>12} | {:>5} | {:>6}\n",
+        "Paging", "Warmup", "Setup (ms)", "Minor faults", "Major faults", "Huge", "Locked");
+    std::cout << std::string(90, '-') << "\n";
+
+    for (const auto& [paging, pagingName] : pagings) {
+        for (const auto& [warmup, warmupName] : warmups) {
+            OrderBookConfig config{};
+            config.arenaSize = arenaMegabytes * 1024 * 1024;
+            config.arenaPaging = paging;
+            config.arenaWarmup = warmup;
+
+            try {
+                OrderBook orderBook{config};
+                const ArenaStats& stats {orderBook.getArenaStats()};
+                std::cout << std::format("{:>8} | {:>15} | {:>12.3f} | {:>12} | {:>12} | {:>5} | {:>6}\n",
+                    pagingName, warmupName,
+                    std::chrono::duration<double, std::milli>(stats.setupTime).count(),
+                    stats.minorFaults, stats.majorFaults,
+                    stats.hugePages ? "yes" : "no", stats.locked ? "yes" : "no");
+            }
+            catch (const std::exception& e) {
+                std::cout << std::format("{:>8} | {:>15} | failed: {}\n", pagingName, warmupName, e.what());
+            }
+        }
+    }
+
+    return 0;
+}
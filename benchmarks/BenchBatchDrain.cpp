@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Pipeline.h"
+#include "BookManager.h"
+#include "Command.h"
+#include "MarketDepth.h"
+
+// Usage: BenchBatchDrain [orders] [symbols]
+// Pushes an order stream through the Matching stage as fast as the queue takes it with maxBatch = 1, 4, 16...
+// Every batch ends with a 5 level depth snapshot of each book it touched, what a market data publisher would send,
+// so batch 1 is the old one update per order. Reports orders/sec and enqueue to matched latency percentiles
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct TimedOrder{
+	NewOrderCommand order;
+	Clock::rep sentAt;
+};
+
+class BatchedMatcher : public Pipeline<BatchedMatcher, TimedOrder>{
+	private:
+		friend class Pipeline<BatchedMatcher, TimedOrder>;
+
+		BookManager books_;
+		std::vector<SymbolId> updated_ {};
+		std::vector<Clock::rep> latencies_ {};
+		MarketDepth<5> depth_ {};
+		size_t batches_ {};
+		size_t published_ {};
+
+		void handleMessage(const Stage&, size_t, const TimedOrder& timed){
+			const NewOrderCommand& newOrder {timed.order};
+			const Order order{newOrder.side, newOrder.price, newOrder.orderId, newOrder.type, newOrder.quantity, newOrder.quantity};
+			if(books_.getBook(newOrder.symbol).processOrder(order)
+				&& std::find(updated_.begin(), updated_.end(), newOrder.symbol) == updated_.end()){
+				updated_.push_back(newOrder.symbol);
+			}
+			latencies_.push_back(Clock::now().time_since_epoch().count() - timed.sentAt);
+		}
+
+		void handleBatchEnd(const Stage&, size_t){
+			for(SymbolId symbol : updated_){
+				books_.getBook(symbol).getDepth(depth_);
+				++published_;
+			}
+			updated_.clear();
+			++batches_;
+		}
+
+	public:
+		BatchedMatcher(const PipelineConfig& config, const BookManagerConfig& books, size_t orders)
+			: Pipeline(config)
+			, books_{books}
+		{
+			latencies_.reserve(orders);
+		}
+
+		~BatchedMatcher(){
+			Pipeline::stop();
+		}
+
+		void send(const NewOrderCommand& order){
+			submit(Stage::Matching, TimedOrder{order, Clock::now().time_since_epoch().count()});
+		}
+
+		// Joins the workers, the counters are safe to read afterwards
+		void drain(){ Pipeline::stop(); }
+
+		[[nodiscard]] std::vector<Clock::rep>& getLatencies() noexcept { return latencies_; }
+		[[nodiscard]] size_t getBatches() const noexcept { return batches_; }
+		[[nodiscard]] size_t getPublished() const noexcept { return published_; }
+};
+
+[[nodiscard]] Clock::rep percentile(const std::vector<Clock::rep>& sorted, double p){
+	return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	const size_t orders {argc > 1 ? std::stoull(argv[1]) : 1'000'000};
+	const size_t symbols {argc > 2 ? std::stoull(argv[2]) : 16};
+
+	std::mt19937_64 rng {11};
+	std::vector<NewOrderCommand> stream{};
+	stream.reserve(orders);
+	for(size_t i {}; i < orders; ++i){
+		const SymbolId symbol {static_cast<SymbolId>(rng() % symbols)};
+		const Side side {rng() % 2 == 0 ? Side::Buy : Side::Sell};
+		const Price price {static_cast<Price>(1000 + rng() % 20 - 10)};
+		const Quantity quantity {static_cast<Quantity>(1 + rng() % 100)};
+		stream.push_back(NewOrderCommand{symbol, static_cast<OrderId>(i + 1), side, OrderType::Limit, price, quantity, 0});
+	}
+
+	BookManagerConfig books{};
+	books.maxSymbols = symbols;
+	books.defaultBook.arenaSize = 16 * 1024 * 1024;
+
+	std::cout << std::format("{} orders over {} symbols, {} cores\n", orders, symbols, std::thread::hardware_concurrency());
+	std::cout << std::format("{:>6} | {:>12} | {:>9} | {:>10} | {:>10} | {:>11} | {:>11}\n",
+		"Batch", "Orders/s", "Avg batch", "Updates", "p50 (us)", "p99 (us)", "p99.9 (us)");
+	std::cout << std::string(88, '-') << "\n";
+
+	for(size_t maxBatch : std::array<size_t, 6>{1, 4, 16, 64, 256, 1024}){
+		PipelineConfig config{};
+		config.queueCapacity = 1 << 16;
+		config.matching.maxBatch = maxBatch;
+
+		BatchedMatcher matcher{config, books, orders};
+
+		const auto start {Clock::now()};
+		for(const NewOrderCommand& order : stream){
+			matcher.send(order);
+		}
+		matcher.drain();
+		const double seconds {std::chrono::duration<double>(Clock::now() - start).count()};
+
+		std::vector<Clock::rep>& latencies {matcher.getLatencies()};
+		std::sort(latencies.begin(), latencies.end());
+		const auto micros {[&latencies](double p){
+			return std::chrono::duration<double, std::micro>(Clock::duration{percentile(latencies, p)}).count();
+		}};
+
+		std::cout << std::format("{:>6} | {:>12.0f} | {:>9.1f} | {:>10} | {:>10.1f} | {:>11.1f} | {:>11.1f}\n",
+			maxBatch, orders / seconds, static_cast<double>(orders) / static_cast<double>(std::max<size_t>(matcher.getBatches(), 1)),
+			matcher.getPublished(), micros(0.5), micros(0.99), micros(0.999));
+	}
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OrderEntryServer.h"
+
+using boost::asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+// Usage: BenchConnectionScaling [messages] [max connections]
+// Order entry over loopback with 1, 10, 100... persistent sessions sending the same total number of messages round
+// robin, then the old way of one connection per message. The server runs on its own thread like TradingSystem's
+// network thread and only counts messages, so this is the cost of connections, reads and framing
+
+namespace {
+
+template <typename Fn>
+auto onServer(boost::asio::io_context& ioContext, Fn fn){
+	std::packaged_task<decltype(fn())()> task{fn};
+	auto result {task.get_future()};
+	boost::asio::post(ioContext, [&task]{ task(); });
+	return result.get();
+}
+
+void waitFor(const std::atomic<uint64_t>& counter, uint64_t target){
+	while(counter.load(std::memory_order_acquire) < target){
+		std::this_thread::yield();
+	}
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	const size_t messages {argc > 1 ? std::stoull(argv[1]) : 500'000};
+	const size_t maxConnections {argc > 2 ? std::stoull(argv[2]) : 4000};
+
+	boost::asio::io_context serverContext{1};
+	std::atomic<uint64_t> received {0};
+	OrderEntryServer server{serverContext, OrderEntryConfig{.address = "127.0.0.1", .port = 0, .maxSessions = maxConnections + 16},
+		[&received](Session&, std::string_view){ received.fetch_add(1, std::memory_order_release); }};
+	const tcp::endpoint endpoint {boost::asio::ip::make_address("127.0.0.1"), server.getPort()};
+	std::thread network{[&serverContext]{ serverContext.run(); }};
+
+	constexpr std::string_view order {"AAPL BUY LIMIT 100 50\n"};
+	boost::asio::io_context clientContext;
+
+	std::cout << std::format("{} messages of {} bytes per row, loopback port {}\n", messages, order.size(), endpoint.port());
+	std::cout << std::format("{:>12} | {:>14} | {:>12} | {:>10}\n", "Connections", "Connect (us)", "Msgs/s", "Msgs/read");
+	std::cout << std::string(58, '-') << "\n";
+
+	for(size_t connections {1}; connections <= maxConnections; connections *= 10){
+		std::vector<tcp::socket> sockets;
+		sockets.reserve(connections);
+		const auto connectStart {Clock::now()};
+		for(size_t i {}; i < connections; ++i){
+			sockets.emplace_back(clientContext).connect(endpoint);
+			sockets.back().set_option(tcp::no_delay{true});
+		}
+		const double connectMicros {std::chrono::duration<double, std::micro>(Clock::now() - connectStart).count() / connections};
+
+		const OrderEntryStats before {onServer(serverContext, [&server]{ return server.getStats(); })};
+		const uint64_t target {received.load() + messages};
+		const auto start {Clock::now()};
+		for(size_t i {}; i < messages; ++i){
+			boost::asio::write(sockets[i % connections], boost::asio::buffer(order));
+		}
+		waitFor(received, target);
+		const double seconds {std::chrono::duration<double>(Clock::now() - start).count()};
+		const OrderEntryStats after {onServer(serverContext, [&server]{ return server.getStats(); })};
+
+		const double perRead {static_cast<double>(after.messages - before.messages) / std::max<uint64_t>(after.reads - before.reads, 1)};
+		std::cout << std::format("{:>12} | {:>14.1f} | {:>12.0f} | {:>10.1f}\n", connections, connectMicros, messages / seconds, perRead);
+
+		for(tcp::socket& socket : sockets){
+			socket.close();
+		}
+		while(onServer(serverContext, [&server]{ return server.getSessionCount(); }) != 0){
+			std::this_thread::yield();
+		}
+	}
+
+	// What every order paid before sessions stayed open, a handshake and teardown per message
+	const size_t oneShot {std::min<size_t>(messages, 20'000)};
+	const uint64_t target {received.load() + oneShot};
+	const auto start {Clock::now()};
+	for(size_t i {}; i < oneShot; ++i){
+		tcp::socket socket{clientContext};
+		socket.connect(endpoint);
+		boost::asio::write(socket, boost::asio::buffer(order));
+	}
+	waitFor(received, target);
+	const double seconds {std::chrono::duration<double>(Clock::now() - start).count()};
+	std::cout << std::format("{:>12} | {:>14} | {:>12.0f} | {:>10.1f}\n", "per message", "-", oneShot / seconds, 1.0);
+
+	onServer(serverContext, [&server]{ server.stop(); });
+	serverContext.stop();
+	network.join();
+	return 0;
+}
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "Journal.h"
+
+// Usage: BenchJournal [records] [records per commit] [path]
+// Sustained append throughput of the journal for every fsync policy. A commit every N records stands in for the end of
+// a Logger batch. Runs against a real file (default in the temp directory) so the numbers include the page cache and disk
+
+int main(int argc, char* argv[]) {
+	const size_t records {argc > 1 ? std::stoull(argv[1]) : 2'000'000};
+	const size_t perCommit {argc > 2 ? std::stoull(argv[2]) : 256};
+	const std::string path {argc > 3 ? argv[3] : (std::filesystem::temp_directory_path() / "bench_journal.bin").string()};
+
+	constexpr std::array<std::pair<JournalFsync, const char*>, 3> policies {{
+		{JournalFsync::Never, "Never"},
+		{JournalFsync::Interval, "Interval"},
+		{JournalFsync::EveryCommit, "EveryCommit"},
+	}};
+
+	std::cout << std::format("{} records of {} bytes, commit every {}, {}\n", records, sizeof(JournalRecord), perCommit, path);
+	std::cout << std::format("{:>12} | {:>12} | {:>8} | {:>9} | {:>8} | {:>12}\n", "Fsync", "Records/s", "MB/s", "Commits", "Syncs", "ns/commit");
+	std::cout << std::string(76, '-') << "\n";
+
+	for(const auto& [policy, name] : policies){
+		JournalConfig config{};
+		config.path = path;
+		config.truncate = true;
+		config.fsync = policy;
+
+		// Every commit syncs with EveryCommit, fewer records keep the run short on slow disks
+		const size_t count {policy == JournalFsync::EveryCommit ? std::min<size_t>(records, perCommit * 2000) : records};
+
+		JournalStats stats{};
+		const auto start {std::chrono::steady_clock::now()};
+		{
+			Journal journal{config};
+			for(size_t i {1}; i <= count; ++i){
+				journal.append(JournalRecord::fromCommand(Command::makeNewOrder(
+					NewOrderCommand{static_cast<SymbolId>(i % 64), i, i % 2 == 0 ? Side::Buy : Side::Sell, OrderType::Limit, static_cast<Price>(1000 + i % 20), 10, 0})));
+				if(i % perCommit == 0){
+					journal.commit();
+				}
+			}
+			journal.commit();
+			stats = journal.getStats();
+		}
+		const double seconds {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+		std::cout << std::format("{:>12} | {:>12.0f} | {:>8.1f} | {:>9} | {:>8} | {:>12.0f}\n",
+			name, count / seconds, stats.bytesWritten / seconds / 1e6, stats.commits, stats.syncs, seconds * 1e9 / static_cast<double>(std::max<uint64_t>(stats.commits, 1)));
+	}
+
+	std::filesystem::remove(path);
+	return 0;
+}
@@ -0,0 +1,151 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <string>
+
+#include "OrderBook.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Usage: BenchLevelSweep [levels] [orders per level] [rounds]
+// Rests orders round robin across the ask levels (so neighbours in a level aren't neighbours in memory)
+// then sweeps the whole side with one market order. Reports time and hardware cache misses for the sweep only
+// Cache counters need perf_event_open, they print n/a where it isn't allowed (containers, perf_event_paranoid > 2)
+
+namespace {
+
+// One hardware counter for this thread, user space only
+class PerfCounter{
+	private:
+		int fd_ {-1};
+
+	public:
+		PerfCounter(uint32_t type, uint64_t config){
+#if defined(__linux__)
+			perf_event_attr attr{};
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = type;
+			attr.config = config;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+			(void)type;
+			(void)config;
+#endif
+		}
+
+		~PerfCounter(){
+#if defined(__linux__)
+			if(fd_ >= 0){
+				close(fd_);
+			}
+#endif
+		}
+
+		PerfCounter(const PerfCounter& other) = delete;
+		PerfCounter& operator=(const PerfCounter& other) = delete;
+
+		[[nodiscard]] bool valid() const noexcept { return fd_ >= 0; }
+
+		void start() noexcept {
+#if defined(__linux__)
+			if(fd_ >= 0){
+				ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+		}
+
+		[[nodiscard]] uint64_t stop() noexcept {
+			uint64_t count {};
+#if defined(__linux__)
+			if(fd_ >= 0){
+				ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+				if(read(fd_, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))){
+					count = 0;
+				}
+			}
+#endif
+			return count;
+		}
+};
+
+std::string show(const PerfCounter& counter, uint64_t count, size_t orders){
+	if(!counter.valid()){
+		return "n/a";
+	}
+	return std::format("{} ({:.3f}/order)", count, static_cast<double>(count) / orders);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	const size_t levels {argc > 1 ? std::stoull(argv[1]) : 256};
+	const size_t ordersPerLevel {argc > 2 ? std::stoull(argv[2]) : 1024};
+	const size_t rounds {argc > 3 ? std::stoull(argv[3]) : 5};
+	const size_t orders {levels * ordersPerLevel};
+
+#if defined(__linux__)
+	PerfCounter cacheMisses {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+	PerfCounter l1Misses {PERF_TYPE_HW_CACHE,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+#else
+	PerfCounter cacheMisses {0, 0};
+	PerfCounter l1Misses {0, 0};
+#endif
+
+	std::cout << std::format("{} levels x {} orders per level, {} rounds\n", levels, ordersPerLevel, rounds);
+	std::cout << std::format("{:>6} | {:>10} | {:>10} | {:>28} | {:>28}\n", "Round", "Sweep (ms)", "ns/order", "LLC misses", "L1D read misses");
+	std::cout << std::string(94, '-') << "\n";
+
+	OrderBookConfig config{};
+	config.arenaSize = 2048ull * 1024 * 1024;
+	config.expectedOpenOrders = orders;
+	config.recentTrades = 0; // Only the sweep itself, trades still go through the (empty) sink
+	config.statusRetention = 1024;
+	OrderBook orderBook{config};
+	OrderId nextId {1};
+
+	for(size_t round {}; round < rounds; ++round){
+		for(size_t i {}; i < orders; ++i){
+			const Price price {static_cast<Price>(1000 + i % levels)};
+			if(!orderBook.processOrder(Order{Side::Sell, price, nextId++, OrderType::Limit, 1 + static_cast<Quantity>(i % 3), 1 + static_cast<Quantity>(i % 3)})){
+				std::cerr << "resting order rejected\n";
+				return 1;
+			}
+		}
+
+		const Quantity total {orderBook.getQuantityOfAsks()};
+		const Order sweep {Side::Buy, 0, nextId++, OrderType::Market, total, total};
+
+		cacheMisses.start();
+		l1Misses.start();
+		const auto start {std::chrono::steady_clock::now()};
+		const bool filled {orderBook.processOrder(sweep)};
+		const auto elapsed {std::chrono::steady_clock::now() - start};
+		const uint64_t l1 {l1Misses.stop()};
+		const uint64_t llc {cacheMisses.stop()};
+
+		if(!filled || orderBook.getQuantityOfAsks() != 0){
+			std::cerr << "sweep didn't clear the book\n";
+			return 1;
+		}
+
+		const double nanos {std::chrono::duration<double, std::nano>(elapsed).count()};
+		std::cout << std::format("{:>6} | {:>10.3f} | {:>10.2f} | {:>28} | {:>28}\n",
+			round, nanos / 1e6, nanos / orders, show(cacheMisses, llc, orders), show(l1Misses, l1, orders));
+	}
+
+	return 0;
+}
@@ -0,0 +1,224 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "OrderBook.h"
+#include "OrderPolicy.h"
+
+// Usage: BenchMatchKernel [orders]
+// 1. Kernel only: sweeps the same flat book with a kernel that branches on side/type every level (what fillOrders used to do)
+//    and with one specialized per side and policy at compile time, dispatched once per order like OrderBook::processOrder
+// 2. End to end: OrderBook::processOrder throughput per order type
+
+namespace {
+
+struct Level{
+	Price price;
+	Quantity quantity;
+};
+
+struct Taker{
+	Side side;
+	OrderType type;
+	Price price;
+	Quantity quantity;
+};
+
+// Both sides best first, asks going up from 1001 and bids going down from 999
+struct FlatBook{
+	std::vector<Level> asks;
+	std::vector<Level> bids;
+};
+
+FlatBook makeBook(size_t levels){
+	FlatBook book{};
+	for(size_t i {}; i < levels; ++i){
+		book.asks.push_back({static_cast<Price>(1001 + i), static_cast<Quantity>(10 + i % 7)});
+		book.bids.push_back({static_cast<Price>(999 - i), static_cast<Quantity>(10 + i % 7)});
+	}
+	return book;
+}
+
+// Returns the filled quantity, the book isn't consumed so every run sees the same levels
+[[gnu::noinline]] Quantity matchRuntime(const FlatBook& book, const Taker& taker){
+	const std::vector<Level>& levels {taker.side == Side::Buy ? book.asks : book.bids};
+	Quantity remaining {taker.quantity};
+
+	if(taker.type == OrderType::PostOnly){
+		return 0;
+	}
+	if(taker.type == OrderType::Market || taker.type == OrderType::FillOrKill){
+		Quantity available {};
+		for(const Level& level : levels){
+			if(taker.type != OrderType::Market &&
+					((taker.side == Side::Buy && level.price > taker.price) ||
+					 (taker.side == Side::Sell && level.price < taker.price))){
+				break;
+			}
+			available += level.quantity;
+		}
+		if(available < remaining){
+			return 0;
+		}
+	}
+
+	for(const Level& level : levels){
+		if(remaining == 0){
+			break;
+		}
+		if(taker.type != OrderType::Market &&
+				((taker.side == Side::Buy && level.price > taker.price) ||
+				 (taker.side == Side::Sell && level.price < taker.price))){
+			break;
+		}
+		remaining -= std::min(remaining, level.quantity);
+	}
+	return taker.quantity - remaining;
+}
+
+template <Side TakerSide>
+constexpr bool crosses(Price restingPrice, Price limitPrice){
+	if constexpr (TakerSide == Side::Buy){ return restingPrice <= limitPrice; } else { return restingPrice >= limitPrice; }
+}
+
+template <Side TakerSide, typename Policy>
+Quantity matchSpecialized(const FlatBook& book, const Taker& taker){
+	const std::vector<Level>& levels {TakerSide == Side::Buy ? book.asks : book.bids};
+	Quantity remaining {taker.quantity};
+
+	if constexpr (Policy::postOnly){
+		return 0;
+	} else {
+		if constexpr (Policy::allOrNothing){
+			Quantity available {};
+			for(const Level& level : levels){
+				if constexpr (Policy::priceLimited){
+					if(!crosses<TakerSide>(level.price, taker.price)){ break; }
+				}
+				available += level.quantity;
+			}
+			if(available < remaining){
+				return 0;
+			}
+		}
+
+		for(const Level& level : levels){
+			if(remaining == 0){
+				break;
+			}
+			if constexpr (Policy::priceLimited){
+				if(!crosses<TakerSide>(level.price, taker.price)){ break; }
+			}
+			remaining -= std::min(remaining, level.quantity);
+		}
+		return taker.quantity - remaining;
+	}
+}
+
+template <Side TakerSide>
+Quantity dispatchType(const FlatBook& book, const Taker& taker){
+	switch(taker.type){
+		case OrderType::Market:            return matchSpecialized<TakerSide, MarketPolicy>(book, taker);
+		case OrderType::Limit:             return matchSpecialized<TakerSide, LimitPolicy>(book, taker);
+		case OrderType::ImmediateOrCancel: return matchSpecialized<TakerSide, ImmediateOrCancelPolicy>(book, taker);
+		case OrderType::PostOnly:          return matchSpecialized<TakerSide, PostOnlyPolicy>(book, taker);
+		case OrderType::FillOrKill:        return matchSpecialized<TakerSide, FillOrKillPolicy>(book, taker);
+		default:                           return 0;
+	}
+}
+
+[[gnu::noinline]] Quantity matchSpecializedEntry(const FlatBook& book, const Taker& taker){
+	return taker.side == Side::Buy ? dispatchType<Side::Buy>(book, taker) : dispatchType<Side::Sell>(book, taker);
+}
+
+template <typename Kernel>
+void runKernel(const char* name, const FlatBook& book, const std::vector<Taker>& takers, Kernel&& kernel){
+	Quantity checksum {};
+	const auto start {std::chrono::steady_clock::now()};
+	for(const Taker& taker : takers){
+		checksum += kernel(book, taker);
+	}
+	const auto elapsed {std::chrono::steady_clock::now() - start};
+	const double nanos {std::chrono::duration<double, std::nano>(elapsed).count()};
+	std::cout << std::format("{:>14} | {:>10.2f} | {:>14}\n", name, nanos / takers.size(), checksum);
+}
+
+constexpr std::array<std::pair<OrderType, const char*>, 5> orderTypes{{
+	{OrderType::Market, "Market"},
+	{OrderType::Limit, "Limit"},
+	{OrderType::ImmediateOrCancel, "IOC"},
+	{OrderType::PostOnly, "PostOnly"},
+	{OrderType::FillOrKill, "FOK"},
+}};
+
+// Every taker is preceded by a resting order it can fully fill against so the book stays the same size
+// (post only takers are priced behind the resting order so they rest and get cancelled instead)
+void runOrderBook(OrderType type, const char* name, size_t orders){
+	OrderBookConfig config{};
+	config.arenaSize = 256 * 1024 * 1024;
+	OrderBook orderBook{config};
+	OrderId nextId {1};
+	size_t accepted {};
+
+	const auto start {std::chrono::steady_clock::now()};
+	for(size_t i {}; i < orders; ++i){
+		const Side takerSide {i % 2 == 0 ? Side::Buy : Side::Sell};
+		const Side makerSide {takerSide == Side::Buy ? Side::Sell : Side::Buy};
+		const Price makerPrice {static_cast<Price>(1000 + (i % 8))};
+
+		accepted += orderBook.processOrder(Order{makerSide, makerPrice, nextId++, OrderType::Limit, 10, 10});
+
+		if(type == OrderType::PostOnly){
+			const Price passive {takerSide == Side::Buy ? makerPrice - 1 : makerPrice + 1};
+			const OrderId takerId {nextId++};
+			accepted += orderBook.processOrder(Order{takerSide, passive, takerId, type, 10, 10});
+			accepted += orderBook.cancelOrder(takerId);
+			accepted += orderBook.cancelOrder(takerId - 1);
+		} else {
+			const Price takerPrice {type == OrderType::Market ? Price{} : makerPrice}; // Market orders ignore the price
+			accepted += orderBook.processOrder(Order{takerSide, takerPrice, nextId++, type, 10, 10});
+		}
+	}
+	const auto elapsed {std::chrono::steady_clock::now() - start};
+	const double seconds {std::chrono::duration<double>(elapsed).count()};
+	std::cout << std::format("{:>14} | {:>10.0f} | {:>10} | {:>12}\n", name, orders / seconds, accepted, orderBook.getQuantityOfAsks() + orderBook.getQuantityOfBids());
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	const size_t orders {argc > 1 ? std::stoull(argv[1]) : 2'000'000};
+
+	// Random side and type per order so the runtime kernel's branches can't be learned by the predictor
+	const FlatBook book {makeBook(16)};
+	std::mt19937_64 rng {42};
+	std::vector<Taker> takers{};
+	takers.reserve(orders);
+	for(size_t i {}; i < orders; ++i){
+		const Side side {rng() % 2 == 0 ? Side::Buy : Side::Sell};
+		const OrderType type {orderTypes[rng() % orderTypes.size()].first};
+		const Price offset {static_cast<Price>(rng() % 6)};
+		const Price price {side == Side::Buy ? static_cast<Price>(1001 + offset) : static_cast<Price>(999 - offset)};
+		takers.push_back({side, type, price, static_cast<Quantity>(1 + rng() % 60)});
+	}
+
+	std::cout << std::format("Kernel only, {} takers against 16 levels per side\n", orders);
+	std::cout << std::format("{:>14} | {:>10} | {:>14}\n", "Kernel", "ns/order", "Filled");
+	std::cout << std::string(44, '-') << "\n";
+	runKernel("runtime", book, takers, matchRuntime);
+	runKernel("specialized", book, takers, matchSpecializedEntry);
+
+	std::cout << std::format("\nOrderBook::processOrder, {} maker/taker pairs per type\n", orders);
+	std::cout << std::format("{:>14} | {:>10} | {:>10} | {:>12}\n", "Type", "pairs/s", "Accepted", "Left resting");
+	std::cout << std::string(55, '-') << "\n";
+	for(const auto& [type, name] : orderTypes){
+		runOrderBook(type, name, orders);
+	}
+
+	return 0;
+}
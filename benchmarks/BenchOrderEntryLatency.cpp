@@ -0,0 +1,189 @@
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "TradingSystem.h"
+#include "BinaryProtocol.h"
+#include "LatencyHistogram.h"
+
+using boost::asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+// Usage: BenchOrderEntryLatency [round trips]
+// End to end latency of one order over loopback, text protocol against binary, on a whole TradingSystem. A client
+// sends a resting buy on an open session and the clock stops when its level shows up on the market data socket, so
+// it covers the session read, framing, parsing or decoding in the Sequencer, matching and the Logger's publish. Then
+// the order is cancelled and timed the same way. Text and binary take turns so both see the same machine state. The
+// execution reports are read after each round trip, outside the timing
+
+namespace {
+
+// Blocking reader of the market data socket, see MarketDataPublisher.h for the wire format
+class Subscriber{
+	private:
+		int fd_;
+		std::vector<char> buffer_;
+
+	public:
+		explicit Subscriber(const std::string& path)
+		: fd_{socket(AF_UNIX, SOCK_SEQPACKET, 0)}
+		, buffer_(64 * 1024)
+		{
+			sockaddr_un address{};
+			address.sun_family = AF_UNIX;
+			std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+			if(connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0){
+				throw std::runtime_error(std::format("Could not subscribe to {}: {}", path, std::strerror(errno)));
+			}
+		}
+
+		~Subscriber(){
+			::close(fd_);
+		}
+
+		// Until a packet carries this total for the level, snapshot or not
+		void waitFor(Price price, Quantity quantity){
+			while(true){
+				const ssize_t size {recv(fd_, buffer_.data(), buffer_.size(), 0)};
+				if(size < static_cast<ssize_t>(sizeof(MarketDataHeader))){
+					throw std::runtime_error("Market data socket closed");
+				}
+				MarketDataHeader header;
+				std::memcpy(&header, buffer_.data(), sizeof(header));
+				for(uint32_t i {}; i < header.count; ++i){
+					MarketDataLevel level;
+					std::memcpy(&level, buffer_.data() + sizeof(header) + i * sizeof(level), sizeof(level));
+					if(level.side == static_cast<uint8_t>(Side::Buy) && level.price == price && level.quantity == quantity){
+						return;
+					}
+				}
+			}
+		}
+};
+
+struct Client{
+	std::string_view name;
+	tcp::socket socket;
+	LatencyHistogram newOrders {};
+	LatencyHistogram cancels {};
+	std::string replies {};
+};
+
+// Every order and cancel gets exactly one report back, read off the clock so sessions never back up
+void readReport(Client& client, bool binary){
+	if(binary){
+		BinaryReport report;
+		boost::asio::read(client.socket, boost::asio::buffer(&report, sizeof(report)));
+	} else {
+		const size_t length {boost::asio::read_until(client.socket, boost::asio::dynamic_buffer(client.replies), '\n')};
+		client.replies.erase(0, length);
+	}
+}
+
+template <typename Send>
+uint64_t timed(Subscriber& subscriber, Price price, Quantity quantity, Send&& send){
+	const auto start {Clock::now()};
+	send();
+	subscriber.waitFor(price, quantity);
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+void printHistogram(std::string_view name, const LatencyHistogram& histogram){
+	std::cout << std::format("{:>16} | {:>9.1f} | {:>9.1f} | {:>9.1f} | {:>9.1f} | {:>9.1f}\n", name, histogram.getMean() / 1e3,
+		histogram.percentile(0.50) / 1e3, histogram.percentile(0.99) / 1e3, histogram.percentile(0.999) / 1e3, histogram.getMax() / 1e3);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	const size_t roundTrips {argc > 1 ? std::stoull(argv[1]) : 20'000};
+	const size_t warmup {std::min<size_t>(roundTrips / 10, 1000)};
+
+	const std::string socketPath {(std::filesystem::temp_directory_path() / std::format("bench_order_entry_{}.sock", getpid())).string()};
+	TradingSystemConfig config{};
+	config.orderEntry.address = "127.0.0.1";
+	config.orderEntry.port = 0;
+	config.binaryEntry.address = "127.0.0.1";
+	config.binaryEntry.port = 0;
+	config.marketData.socketPath = socketPath;
+	config.recover = false;
+
+	TradingSystem tradingSystem{config};
+	std::thread network{[&tradingSystem]{ tradingSystem.startServer(); }};
+	while(tradingSystem.getListeningPort() == 0){
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	boost::asio::io_context clientContext;
+	const auto connect {[&clientContext](std::string_view name, uint16_t port){
+		Client client{name, tcp::socket{clientContext}};
+		client.socket.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port));
+		client.socket.set_option(tcp::no_delay{true});
+		return client;
+	}};
+	Client text {connect("text", tradingSystem.getListeningPort())};
+	Client binary {connect("binary", tradingSystem.getBinaryListeningPort())};
+	Subscriber subscriber{socketPath};
+
+	// Every new order rests and gets the next order id, one book and one level the whole way through
+	constexpr Price price {1000};
+	OrderId nextOrderId {1};
+	const std::string textOrder {std::format("LAT BUY LIMIT {} 1\n", price)};
+	const BinaryNewOrder binaryOrder {makeBinaryNewOrder(1, "LAT", Side::Buy, OrderType::Limit, price, 1)};
+
+	const auto roundTrip {[&](Client& client, bool record){
+		const OrderId orderId {nextOrderId++};
+		const uint64_t newOrder {timed(subscriber, price, 1, [&]{
+			if(&client == &text){
+				boost::asio::write(client.socket, boost::asio::buffer(textOrder));
+			} else {
+				boost::asio::write(client.socket, boost::asio::buffer(asBytes(binaryOrder)));
+			}
+		})};
+		const uint64_t cancel {timed(subscriber, price, 0, [&]{
+			if(&client == &text){
+				boost::asio::write(client.socket, boost::asio::buffer(std::format("LAT CANCEL {}\n", orderId)));
+			} else {
+				boost::asio::write(client.socket, boost::asio::buffer(asBytes(makeBinaryCancel(orderId, "LAT", orderId))));
+			}
+		})};
+		readReport(client, &client == &binary);
+		readReport(client, &client == &binary);
+		if(record){
+			client.newOrders.record(newOrder);
+			client.cancels.record(cancel);
+		}
+	}};
+
+	for(size_t i {}; i < warmup; ++i){
+		roundTrip(text, false);
+		roundTrip(binary, false);
+	}
+	for(size_t i {}; i < roundTrips; ++i){
+		roundTrip(text, true);
+		roundTrip(binary, true);
+	}
+
+	std::cout << std::format("{} round trips per protocol after {} warmup, {} byte text order against {} byte binary, in microseconds\n",
+		roundTrips, warmup, textOrder.size(), sizeof(BinaryNewOrder));
+	std::cout << std::format("{:>16} | {:>9} | {:>9} | {:>9} | {:>9} | {:>9}\n", "", "Mean", "p50", "p99", "p99.9", "Max");
+	std::cout << std::string(74, '-') << "\n";
+	for(const Client* client : {&text, &binary}){
+		printHistogram(std::format("{} new", client->name), client->newOrders);
+		printHistogram(std::format("{} cancel", client->name), client->cancels);
+	}
+
+	tradingSystem.stopServer();
+	network.join();
+	std::filesystem::remove(socketPath);
+	return 0;
+}
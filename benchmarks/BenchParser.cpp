@@ -0,0 +1,188 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OrderParser.h"
+#include "BinaryProtocol.h"
+
+// Usage: BenchParser [messages]
+// Order entry text parsing on one core. The stringstream row is how the Sequencer used to parse (copy into a string,
+// stream out more strings, compare), the others are parseMessage on the same messages, then framing plus parsing of
+// one big receive buffer, decodeBinary on the same orders in the binary protocol, then just the newline scan per
+// implementation. Heap allocations are counted per row
+
+namespace {
+
+size_t allocations {0};
+
+using Clock = std::chrono::steady_clock;
+
+// What handleSequencing did before, kept here to compare against
+bool parseWithStringStream(std::string_view message, ParsedMessage& parsed){
+	std::stringstream ss{std::string(message)};
+	std::string symbolStr, verbStr, typeStr;
+	if(!(ss >> verbStr)){
+		return false;
+	}
+	if(verbStr != "BUY" && verbStr != "SELL" && verbStr != "CANCEL" && verbStr != "MODIFY"){
+		symbolStr = std::move(verbStr);
+		if(!(ss >> verbStr)){
+			return false;
+		}
+	}
+	if(verbStr == "CANCEL"){
+		parsed.kind = MessageKind::Cancel;
+		return static_cast<bool>(ss >> parsed.orderId);
+	}
+	if(verbStr == "MODIFY"){
+		parsed.kind = MessageKind::Modify;
+		return static_cast<bool>(ss >> parsed.orderId >> parsed.price >> parsed.quantity);
+	}
+	if(!(ss >> typeStr >> parsed.price >> parsed.quantity)){
+		return false;
+	}
+	parsed.kind = MessageKind::NewOrder;
+	parsed.side = verbStr == "BUY" ? Side::Buy : Side::Sell;
+	parsed.type = typeStr == "LIMIT" ? OrderType::Limit : OrderType::Market;
+	return true;
+}
+
+template <typename Fn>
+void row(std::string_view name, size_t messages, Fn&& fn){
+	const size_t allocationsBefore {allocations};
+	const auto start {Clock::now()};
+	const uint64_t checksum {fn()};
+	const double seconds {std::chrono::duration<double>(Clock::now() - start).count()};
+	std::cout << std::format("{:>22} | {:>14.0f} | {:>10.1f} | {:>12} | {:>10}\n",
+		name, messages / seconds, seconds * 1e9 / messages, allocations - allocationsBefore, checksum % 1000);
+}
+
+}
+
+void* operator new(size_t size){
+	++allocations;
+	if(void* memory = std::malloc(size == 0 ? 1 : size)){
+		return memory;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	std::free(memory);
+}
+
+int main(int argc, char* argv[]) {
+	const size_t count {argc > 1 ? std::stoull(argv[1]) : 2'000'000};
+
+	// Roughly what clients send, mostly new orders with and without a symbol, some cancels and modifies
+	std::mt19937_64 rng{11};
+	constexpr std::array<std::string_view, 5> symbols {"AAPL", "MSFT", "GOOG", "TSLA", ""};
+	constexpr std::array<std::string_view, 5> types {"LIMIT", "MARKET", "IOC", "POST", "FOK"};
+	std::vector<std::string> messages;
+	std::vector<std::string> binaryMessages;
+	messages.reserve(count);
+	binaryMessages.reserve(count);
+	std::string buffer;
+	for(size_t i {}; i < count; ++i){
+		const std::string_view symbol {symbols[rng() % symbols.size()]};
+		const std::string prefix {symbol.empty() ? std::string{} : std::format("{} ", symbol)};
+		const uint64_t roll {rng() % 10};
+		if(roll < 8){
+			messages.push_back(std::format("{}{} {} {} {}", prefix, rng() % 2 ? "BUY" : "SELL", types[rng() % types.size()], 9000 + rng() % 2000, 1 + rng() % 500));
+		} else if(roll < 9){
+			messages.push_back(std::format("{}CANCEL {}", prefix, 1 + rng() % 10'000'000));
+		} else {
+			messages.push_back(std::format("{}MODIFY {} {} {}", prefix, 1 + rng() % 10'000'000, 9000 + rng() % 2000, 1 + rng() % 500));
+		}
+		buffer += messages.back();
+		buffer += '\n';
+	}
+
+	// The same orders as binary messages, built from what the text parses to
+	for(const std::string& message : messages){
+		ParsedMessage parsed{};
+		(void)parseMessage(message, parsed);
+		switch(parsed.kind){
+			case MessageKind::NewOrder: binaryMessages.emplace_back(asBytes(makeBinaryNewOrder(1, parsed.symbol, parsed.side, parsed.type, parsed.price, parsed.quantity))); break;
+			case MessageKind::Cancel:   binaryMessages.emplace_back(asBytes(makeBinaryCancel(1, parsed.symbol, parsed.orderId))); break;
+			case MessageKind::Modify:   binaryMessages.emplace_back(asBytes(makeBinaryModify(1, parsed.symbol, parsed.orderId, parsed.price, parsed.quantity))); break;
+		}
+	}
+
+	std::cout << std::format("{} messages, {:.1f} bytes on average\n", count, static_cast<double>(buffer.size()) / count);
+	std::cout << std::format("{:>22} | {:>14} | {:>10} | {:>12} | {:>10}\n", "Parser", "Msgs/s", "ns/msg", "Allocations", "Check");
+	std::cout << std::string(80, '-') << "\n";
+
+	row("stringstream", count, [&]{
+		uint64_t sum {};
+		ParsedMessage parsed{};
+		for(const std::string& message : messages){
+			sum += parseWithStringStream(message, parsed) ? parsed.quantity : 0;
+		}
+		return sum;
+	});
+
+	row("parseMessage", count, [&]{
+		uint64_t sum {};
+		ParsedMessage parsed{};
+		for(const std::string& message : messages){
+			sum += parseMessage(message, parsed) == ParseError::None ? parsed.quantity : 0;
+		}
+		return sum;
+	});
+
+	row("framing + parseMessage", count, [&]{
+		uint64_t sum {};
+		ParsedMessage parsed{};
+		(void)forEachMessage(buffer, [&](std::string_view line){
+			sum += parseMessage(line, parsed) == ParseError::None ? parsed.quantity : 0;
+		});
+		return sum;
+	});
+
+	row("decodeBinary", count, [&]{
+		uint64_t sum {};
+		ParsedMessage parsed{};
+		for(const std::string& message : binaryMessages){
+			sum += decodeBinary(message, parsed) == ParseError::None ? parsed.quantity : 0;
+		}
+		return sum;
+	});
+
+	// Only the delimiter search, over the whole buffer
+	const auto scan {[&](auto find){
+		uint64_t lines {};
+		const char* position {buffer.data()};
+		const char* const end {position + buffer.size()};
+		while((position = find(position, end)) != end){
+			++lines;
+			++position;
+		}
+		return lines;
+	}};
+	std::cout << "\n";
+	row("newline scan: scalar", count, [&]{ return scan(findNewlineScalar); });
+	row("newline scan: memchr", count, [&]{
+		return scan([](const char* begin, const char* end){
+			const void* found {std::memchr(begin, '\n', static_cast<size_t>(end - begin))};
+			return found == nullptr ? end : static_cast<const char*>(found);
+		});
+	});
+#if defined(__SSE2__)
+	row("newline scan: SSE2", count, [&]{ return scan(findNewlineSse2); });
+#endif
+	return 0;
+}
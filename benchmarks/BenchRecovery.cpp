@@ -0,0 +1,83 @@
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "BookManager.h"
+#include "Journal.h"
+#include "JournalReplay.h"
+
+// Usage: BenchRecovery [orders] [symbols] [path]
+// Builds a day's worth of journal the way the Logger stage does (accepted orders, cancels, modifies and their trades),
+// then times replaying it into empty books. Roughly 70% limit orders around a moving mid, 20% cancels, 10% modifies
+
+int main(int argc, char* argv[]) {
+	const size_t orders {argc > 1 ? std::stoull(argv[1]) : 5'000'000};
+	const SymbolId symbols {argc > 2 ? static_cast<SymbolId>(std::stoul(argv[2])) : 64};
+	const std::string path {argc > 3 ? argv[3] : (std::filesystem::temp_directory_path() / "bench_recovery.bin").string()};
+
+	const BookManagerConfig booksConfig{.maxSymbols = symbols, .defaultBook = OrderBookConfig{.arenaSize = 64 * 1024 * 1024}};
+
+	std::cout << std::format("{} commands over {} symbols, {}\n", orders, symbols, path);
+
+	const auto writeStart {std::chrono::steady_clock::now()};
+	{
+		JournalConfig config{};
+		config.path = path;
+		config.truncate = true;
+		config.fsync = JournalFsync::Never;
+		Journal journal{config};
+
+		BookManager live{booksConfig};
+		live.setTradeSink([&journal](SymbolId symbol, const Trade& trade){
+			journal.append(JournalRecord::fromCommand(Command::makeTradeReport(symbol, trade)));
+		});
+
+		std::mt19937_64 rng{7};
+		OrderId nextOrderId {1};
+		for(size_t i {}; i < orders; ++i){
+			const SymbolId symbol {static_cast<SymbolId>(rng() % symbols)};
+			OrderBook& book {live.getBook(symbol)};
+			const uint64_t roll {rng() % 10};
+			if(roll < 7 || nextOrderId < 100){
+				const NewOrderCommand order{symbol, nextOrderId++, rng() % 2 == 0 ? Side::Buy : Side::Sell, OrderType::Limit,
+					static_cast<Price>(1000 + rng() % 40), static_cast<Quantity>(1 + rng() % 100), 0};
+				if(book.processOrder(Order(order.side, order.price, order.orderId, order.type, order.quantity, order.quantity))){
+					journal.append(JournalRecord::fromCommand(Command::makeNewOrder(order)));
+				}
+			} else if(roll < 9){
+				const CancelCommand cancel{symbol, nextOrderId - 1 - rng() % 100, 0};
+				if(book.cancelOrder(cancel.orderId)){
+					journal.append(JournalRecord::fromCommand(Command::makeCancel(cancel)));
+				}
+			} else {
+				const ModifyCommand modify{symbol, nextOrderId - 1 - rng() % 100, static_cast<Price>(1000 + rng() % 40), static_cast<Quantity>(1 + rng() % 100), 0};
+				if(book.modifyOrder(modify.orderId, modify.quantity, modify.price)){
+					journal.append(JournalRecord::fromCommand(Command::makeModify(modify)));
+				}
+			}
+			if(i % 256 == 0){
+				journal.commit();
+			}
+		}
+		journal.commit();
+	}
+	const double writeSeconds {std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count()};
+	const uintmax_t bytes {std::filesystem::file_size(path)};
+	std::cout << std::format("Live run + journal: {:.2f} s, {:.1f} MB\n", writeSeconds, bytes / 1e6);
+
+	BookManager recovered{booksConfig};
+	const ReplayStats stats {replayJournal(path, [&recovered](SymbolId symbol) -> OrderBook& { return recovered.getBook(symbol); })};
+	const double seconds {std::chrono::duration<double>(stats.elapsed).count()};
+
+	std::cout << std::format("Replay: {} records ({} orders, {} cancels, {} modifies, {} trades skipped) in {:.3f} s\n",
+		stats.records, stats.newOrders, stats.cancels, stats.modifies, stats.trades, seconds);
+	std::cout << std::format("{:.0f} records/s, {:.0f} commands/s, {:.1f} MB/s, {} mismatches, next order id {}\n",
+		stats.records / seconds, (stats.newOrders + stats.cancels + stats.modifies) / seconds, bytes / seconds / 1e6,
+		stats.mismatches, stats.lastOrderId + 1);
+
+	std::filesystem::remove(path);
+	return stats.mismatches == 0 ? 0 : 1;
+}
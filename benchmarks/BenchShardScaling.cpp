@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Pipeline.h"
+#include "BookManager.h"
+#include "Command.h"
+
+// Usage: BenchShardScaling [orders] [symbols] [max shards]
+// Feeds the same order stream over many symbols through the Matching stage with 1, 2, 4... shards
+// (each shard pinned to its own core when there are enough) and reports orders/sec until every shard is drained
+// Scaling can only show up to the number of cores that are free besides the feeding thread
+
+namespace {
+
+// Owns a BookManager per shard the same way TradingSystem does, the benchmark thread plays the Sequencer
+class ShardedMatcher : public Pipeline<ShardedMatcher, Command>{
+	private:
+		friend class Pipeline<ShardedMatcher, Command>;
+
+		std::vector<std::unique_ptr<BookManager>> shards_;
+		std::atomic<size_t> accepted_ {};
+
+		void handleMessage(const Stage&, size_t shard, const Command& command){
+			const NewOrderCommand& newOrder {command.newOrder};
+			const Order order{newOrder.side, newOrder.price, newOrder.orderId, newOrder.type, newOrder.quantity, newOrder.quantity};
+			if(shards_[shard]->getBook(newOrder.symbol).processOrder(order)){
+				accepted_.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+	public:
+		explicit ShardedMatcher(const PipelineConfig& config, const BookManagerConfig& books)
+			: Pipeline(config)
+		{
+			for(size_t shard {}; shard < getMatchingShards(); ++shard){
+				shards_.push_back(std::make_unique<BookManager>(books));
+			}
+		}
+
+		~ShardedMatcher(){
+			Pipeline::stop();
+		}
+
+		[[nodiscard]] size_t shardFor(SymbolId symbol) const noexcept {
+			return static_cast<size_t>((static_cast<uint64_t>(symbol) * 0x9E3779B97F4A7C15ull) >> 32) % shards_.size();
+		}
+
+		void route(const NewOrderCommand& newOrder){
+			submit(Stage::Matching, shardFor(newOrder.symbol), Command::makeNewOrder(newOrder));
+		}
+
+		void drain(){ Pipeline::stop(); }
+
+		[[nodiscard]] size_t getAccepted() const noexcept { return accepted_.load(); }
+};
+
+}
+
+int main(int argc, char* argv[]) {
+	const size_t orders {argc > 1 ? std::stoull(argv[1]) : 1'000'000};
+	const size_t symbols {argc > 2 ? std::stoull(argv[2]) : 512};
+	const size_t cores {std::max<size_t>(std::thread::hardware_concurrency(), 1)};
+	const size_t maxShards {argc > 3 ? std::stoull(argv[3]) : std::max<size_t>(cores - 1, 1)};
+
+	// Limit orders around a mid price per symbol so roughly half of them trade
+	std::mt19937_64 rng {7};
+	std::vector<NewOrderCommand> stream{};
+	stream.reserve(orders);
+	for(size_t i {}; i < orders; ++i){
+		const SymbolId symbol {static_cast<SymbolId>(rng() % symbols)};
+		const Side side {rng() % 2 == 0 ? Side::Buy : Side::Sell};
+		const Price price {static_cast<Price>(1000 + rng() % 20 - 10)};
+		const Quantity quantity {static_cast<Quantity>(1 + rng() % 100)};
+		stream.push_back(NewOrderCommand{symbol, static_cast<OrderId>(i + 1), side, OrderType::Limit, price, quantity, 0});
+	}
+
+	BookManagerConfig books{};
+	books.maxSymbols = symbols;
+	books.defaultBook.arenaSize = 16 * 1024 * 1024;
+
+	std::cout << std::format("{} orders over {} symbols, {} cores\n", orders, symbols, cores);
+	std::cout << std::format("{:>7} | {:>12} | {:>10} | {:>8}\n", "Shards", "Orders/s", "Accepted", "Speedup");
+	std::cout << std::string(48, '-') << "\n";
+
+	double baseline {};
+	for(size_t shards {1}; shards <= maxShards; shards *= 2){
+		PipelineConfig config{};
+		config.matchingShards = shards;
+		config.queueCapacity = 1 << 16;
+		if(shards < cores){
+			for(size_t shard {}; shard < shards; ++shard){
+				config.matchingCores.push_back(static_cast<int>(shard + 1)); // Core 0 is left to the feeding thread
+			}
+		}
+
+		ShardedMatcher matcher{config, books};
+
+		const auto start {std::chrono::steady_clock::now()};
+		for(const NewOrderCommand& newOrder : stream){
+			matcher.route(newOrder);
+		}
+		matcher.drain();
+		const auto elapsed {std::chrono::steady_clock::now() - start};
+
+		const double rate {orders / std::chrono::duration<double>(elapsed).count()};
+		if(shards == 1){
+			baseline = rate;
+		}
+		std::cout << std::format("{:>7} | {:>12.0f} | {:>10} | {:>7.2f}x\n", shards, rate, matcher.getAccepted(), rate / baseline);
+	}
+
+	return 0;
+}
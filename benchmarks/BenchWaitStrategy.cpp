@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <format>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Pipeline.h"
+
+// Usage: BenchWaitStrategy [pings] [gap us] [matching core]
+// For each wait strategy of the Matching stage (the other stages block so they cost nothing):
+//  - Idle cost: CPU time the process burns per second of wall time while every queue is empty
+//  - Wake up latency: a ping is sent after the worker has sat idle for the gap, time until Matching sees it
+// BusySpin wants the matching core to itself, on a shared core its numbers mostly measure the scheduler
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Ping{
+	Clock::rep sentAt;
+};
+
+class PingPipeline : public Pipeline<PingPipeline, Ping>{
+	private:
+		friend class Pipeline<PingPipeline, Ping>;
+
+		std::vector<Clock::rep> latencies_; // Matching thread only until drain
+		std::atomic<size_t> received_ {};
+
+		void handleMessage(const Stage&, size_t, const Ping& ping){
+			latencies_.push_back(Clock::now().time_since_epoch().count() - ping.sentAt);
+			received_.fetch_add(1, std::memory_order_release);
+		}
+
+	public:
+		PingPipeline(const PipelineConfig& config, size_t pings)
+			: Pipeline(config)
+		{
+			latencies_.reserve(pings);
+		}
+
+		~PingPipeline(){
+			Pipeline::stop();
+		}
+
+		void ping(){
+			submit(Stage::Matching, Ping{Clock::now().time_since_epoch().count()});
+		}
+
+		void waitForReceived(size_t count) const {
+			while(received_.load(std::memory_order_acquire) < count){
+				std::this_thread::yield();
+			}
+		}
+
+		// Joins the workers so the latencies can be read from this thread
+		[[nodiscard]] std::vector<Clock::rep> drain(){
+			Pipeline::stop();
+			return std::move(latencies_);
+		}
+};
+
+[[nodiscard]] double processCpuSeconds(){
+	timespec now{};
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+	return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) / 1e9;
+}
+
+[[nodiscard]] Clock::rep percentile(const std::vector<Clock::rep>& sorted, double p){
+	return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	const size_t pings {argc > 1 ? std::stoull(argv[1]) : 2000};
+	const auto gap {std::chrono::microseconds(argc > 2 ? std::stoll(argv[2]) : 500)};
+	const int core {argc > 3 ? std::stoi(argv[3]) : -1};
+
+	constexpr std::array<std::pair<WaitStrategy, const char*>, 4> strategies {{
+		{WaitStrategy::BusySpin, "BusySpin"},
+		{WaitStrategy::SpinYield, "SpinYield"},
+		{WaitStrategy::SpinPark, "SpinPark"},
+		{WaitStrategy::Blocking, "Blocking"},
+	}};
+
+	std::cout << std::format("{} pings, {} us apart, {} cores\n", pings, gap.count(), std::thread::hardware_concurrency());
+	std::cout << std::format("{:>10} | {:>14} | {:>10} | {:>10} | {:>10}\n", "Strategy", "Idle CPU (%)", "p50 (ns)", "p99 (ns)", "Max (ns)");
+	std::cout << std::string(66, '-') << "\n";
+
+	for(const auto& [strategy, name] : strategies){
+		PipelineConfig config{};
+		config.sequencer.waitStrategy = WaitStrategy::Blocking;
+		config.logger.waitStrategy = WaitStrategy::Blocking;
+		config.matching.waitStrategy = strategy;
+		config.matching.core = core;
+
+		PingPipeline pipeline{config, pings};
+
+		// Idle cost, the feeding thread sleeps so whatever is burnt is the workers
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		const double cpuStart {processCpuSeconds()};
+		const auto wallStart {Clock::now()};
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		const double idleCpu {(processCpuSeconds() - cpuStart) / std::chrono::duration<double>(Clock::now() - wallStart).count()};
+
+		// Wake up latency, one ping at a time after the worker has gone idle again
+		for(size_t i {}; i < pings; ++i){
+			std::this_thread::sleep_for(gap);
+			pipeline.ping();
+			pipeline.waitForReceived(i + 1);
+		}
+
+		std::vector<Clock::rep> latencies {pipeline.drain()};
+		std::sort(latencies.begin(), latencies.end());
+		std::cout << std::format("{:>10} | {:>14.1f} | {:>10} | {:>10} | {:>10}\n",
+			name, idleCpu * 100.0, percentile(latencies, 0.5), percentile(latencies, 0.99), latencies.back());
+	}
+
+	return 0;
+}
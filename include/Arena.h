@@ -0,0 +1,59 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// How the arena pages are backed
+enum class ArenaPaging : uint8_t
+{
+    Default,                // Regular 4K pages
+    TransparentHugePages,   // Regular mapping with a THP hint (madvise)
+    HugePages               // Explicit MAP_HUGETLB, falls back to THP if the system has no huge pages reserved
+};
+
+// What the arena does before the first order shows up
+enum class ArenaWarmup : uint8_t
+{
+    None,               // Reserve only, pages get faulted in on first touch
+    Prefault,           // Touch every page up front
+    PrefaultAndLock     // Touch and mlock so nothing gets paged out (latency critical books)
+};
+
+struct ArenaStats
+{
+    std::chrono::nanoseconds setupTime {};
+    long minorFaults {};
+    long majorFaults {};
+    bool hugePages {false};   // Got MAP_HUGETLB pages
+    bool locked {false};      // mlock succeeded
+};
+
+// Big block of memory reserved straight from the OS. Nothing is zeroed or touched unless a warmup mode asks for it
+class Arena{
+    private:
+        std::byte* memory_;
+        size_t size_;
+        ArenaStats stats_;
+
+        void prefault() noexcept;
+
+    public:
+        explicit Arena(size_t size, ArenaPaging paging = ArenaPaging::Default, ArenaWarmup warmup = ArenaWarmup::None);
+        ~Arena();
+
+        [[nodiscard]] std::byte* data() const noexcept { return memory_; }
+        [[nodiscard]] size_t size() const noexcept { return size_; }
+        [[nodiscard]] const ArenaStats& getStats() const noexcept { return stats_; }
+
+        // No Copying 
+        Arena(const Arena& other) = delete;
+        Arena& operator=(const Arena& other) = delete;
+
+        // No Moving 
+        Arena(Arena&& other) = delete;
+        Arena& operator=(Arena&& other) = delete;
+};
+
+#endif
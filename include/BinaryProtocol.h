@@ -0,0 +1,135 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "Using.h"
+#include "Side.h"
+#include "OrderType.h"
+#include "OrderParser.h"
+#include "ExecutionReport.h"
+
+// Fixed width order entry, the binary sibling of the text commands (same fields, no text). Every message is one
+// BinaryHeader followed by the fields of its type, integers are little endian and every field sits at its natural
+// alignment so a message is just the struct's bytes. Messages are back to back on the connection, header.length
+// frames them. Symbols are left aligned and padded with spaces or zeros, all padding means the default book. What's
+// before the padding has to pass isValidSymbol (OrderParser.h)
+//
+//   'O' new order   header side type -- clientOrderId symbol[16] price quantity           40 bytes
+//   'X' cancel      header ----------- clientOrderId symbol[16] orderId                  40 bytes
+//   'U' modify      header ----------- clientOrderId symbol[16] orderId price quantity   48 bytes
+//
+// clientOrderId is whatever the client wants to know the request by, orderId is the id the exchange gave the order
+//
+// The engine answers with BinaryReport messages, 40 bytes each, one per ExecutionReport:
+//   'A' accepted  'J' rejected  'D' expired  'E' fill  'C' cancelled  'M' modified
+static_assert(std::endian::native == std::endian::little, "Binary messages are decoded by copying their bytes as is");
+
+enum class BinaryMessageType : uint8_t
+{
+    NewOrder = 'O',
+    Cancel = 'X',
+    Modify = 'U'
+};
+
+enum class BinaryReportType : uint8_t
+{
+    Accepted = 'A',
+    Rejected = 'J',
+    Expired = 'D',
+    Fill = 'E',
+    Cancelled = 'C',
+    Modified = 'M'
+};
+
+struct BinaryHeader
+{
+    uint16_t length;            // Whole message, header included
+    BinaryMessageType type;     // BinaryReportType for what the engine sends
+    uint8_t reserved;
+};
+
+struct BinaryNewOrder
+{
+    BinaryHeader header;
+    uint8_t side;               // 'B' or 'S'
+    uint8_t orderType;          // 'L'imit, 'M'arket, 'I'OC, 'P'ost only, 'F'OK
+    uint16_t reserved;
+    uint64_t clientOrderId;
+    char symbol[maxSymbolLength];
+    Price price;
+    Quantity quantity;
+};
+
+struct BinaryCancel
+{
+    BinaryHeader header;
+    uint32_t reserved;
+    uint64_t clientOrderId;
+    char symbol[maxSymbolLength];
+    OrderId orderId;
+};
+
+struct BinaryModify
+{
+    BinaryHeader header;
+    uint32_t reserved;
+    uint64_t clientOrderId;
+    char symbol[maxSymbolLength];
+    OrderId orderId;
+    Price price;
+    Quantity quantity;
+};
+
+// Same fields as ExecutionReport, see there
+struct BinaryReport
+{
+    BinaryHeader header;
+    uint8_t reason;             // RejectReason
+    uint8_t parseError;         // ParseError when reason is Malformed
+    uint16_t reserved;
+    uint64_t clientOrderId;
+    OrderId orderId;
+    Price price;
+    Quantity quantity;
+    Quantity leaves;
+    uint32_t padding;
+};
+
+static_assert(sizeof(BinaryHeader) == 4 && sizeof(BinaryNewOrder) == 40 && sizeof(BinaryCancel) == 40 && sizeof(BinaryModify) == 48, "Wire layout");
+static_assert(sizeof(BinaryReport) == 40, "Wire layout");
+static_assert(std::is_trivially_copyable_v<BinaryNewOrder> && std::is_trivially_copyable_v<BinaryCancel> && std::is_trivially_copyable_v<BinaryModify>);
+
+inline constexpr size_t maxBinaryMessageLength {sizeof(BinaryModify)};
+
+static_assert(offsetof(BinaryNewOrder, clientOrderId) == offsetof(BinaryCancel, clientOrderId) && offsetof(BinaryCancel, clientOrderId) == offsetof(BinaryModify, clientOrderId));
+
+// Every client message has clientOrderId at the same place, so one that doesn't decode (or doesn't fit a Command)
+// can still be answered with it. 0 when the message is too short to have one
+[[nodiscard]] uint64_t peekClientOrderId(std::string_view message) noexcept;
+
+// One whole message, exactly header.length bytes as framed off the connection. Checks the length against the type,
+// copies the bytes into the struct (a plain load, the receive buffer has no alignment to speak of) and validates the
+// enum fields and the symbol. The symbol points into message with its padding cut off
+[[nodiscard]] ParseError decodeBinary(std::string_view message, ParsedMessage& parsed) noexcept;
+
+// Client side, a zeroed message with its header filled in. Symbols longer than maxSymbolLength are cut
+[[nodiscard]] BinaryNewOrder makeBinaryNewOrder(uint64_t clientOrderId, std::string_view symbol, Side side, OrderType type, Price price, Quantity quantity) noexcept;
+[[nodiscard]] BinaryCancel makeBinaryCancel(uint64_t clientOrderId, std::string_view symbol, OrderId orderId) noexcept;
+[[nodiscard]] BinaryModify makeBinaryModify(uint64_t clientOrderId, std::string_view symbol, OrderId orderId, Price price, Quantity quantity) noexcept;
+
+// Engine side, a report as it goes to a binary session
+[[nodiscard]] BinaryReport makeBinaryReport(const ExecutionReport& report) noexcept;
+
+// The bytes that go on the wire
+template <typename Message>
+[[nodiscard]] std::string_view asBytes(const Message& message) noexcept {
+    static_assert(std::is_trivially_copyable_v<Message>);
+    return {reinterpret_cast<const char*>(&message), sizeof(Message)};
+}
+
+#endif
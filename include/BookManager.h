@@ -0,0 +1,104 @@
+#ifndef BOOKMANAGER_H
+#define BOOKMANAGER_H
+
+#include <memory>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <stdexcept>
+#include <format>
+
+#include "Using.h"
+#include "Trade.h"
+#include "OrderBook.h"
+#include "OrderBookConfig.h"
+
+using SymbolTradeSink = std::function<void(SymbolId, const Trade&)>;
+
+struct BookManagerConfig{
+	size_t maxSymbols {1024}; // Symbol ids go from 0 to maxSymbols - 1
+	// Used for every symbol that wasn't given its own config, small enough that hundreds of books fit in one process
+	OrderBookConfig defaultBook {
+		.arenaSize = 64 * 1024 * 1024,
+		.statusRetention = 1 << 14,
+		.expectedOpenOrders = 10'000,
+		.recentTrades = 1024,
+	};
+};
+
+// Owns one OrderBook per symbol. Books are created the first time their symbol is used so only traded symbols pay for an arena
+// Symbol ids index straight into a vector, finding the book for an order is one load
+// Not thread safe, everything goes through the matching thread
+class BookManager{
+	private:
+		BookManagerConfig config_;
+		std::vector<std::unique_ptr<OrderBook>> books_; // nullptr until the symbol's first order
+		std::vector<std::optional<OrderBookConfig>> bookConfigs_; // Per symbol overrides of config_.defaultBook
+		size_t bookCount_;
+		SymbolTradeSink tradeSink_;
+
+		OrderBook& createBook(SymbolId symbol);
+		void connectTradeSink(SymbolId symbol, OrderBook& book);
+
+	public:
+		BookManager()
+		: BookManager(BookManagerConfig{})
+		{}
+
+		explicit BookManager(const BookManagerConfig& config)
+		: config_{config}
+		, books_(config.maxSymbols)
+		, bookConfigs_(config.maxSymbols)
+		, bookCount_{}
+		, tradeSink_{}
+		{}
+
+		// Arena size, ladder, index sizing... for one symbol. Has to happen before the symbol's book exists
+		void configureBook(SymbolId symbol, const OrderBookConfig& config);
+
+		// Book for the symbol, created on first use. Throws std::out_of_range for ids past maxSymbols
+		[[nodiscard]] OrderBook& getBook(SymbolId symbol){
+			if(symbol >= books_.size()){
+				throw std::out_of_range(std::format("Symbol({}) is past the max of {} symbols", symbol, books_.size()));
+			}
+			if(OrderBook* book {books_[symbol].get()}; book != nullptr){
+				return *book;
+			}
+			return createBook(symbol);
+		}
+
+		// Book for the symbol or nullptr if it hasn't been created
+		[[nodiscard]] OrderBook* findBook(SymbolId symbol) noexcept {
+			return symbol < books_.size() ? books_[symbol].get() : nullptr;
+		}
+
+		[[nodiscard]] const OrderBook* findBook(SymbolId symbol) const noexcept {
+			return symbol < books_.size() ? books_[symbol].get() : nullptr;
+		}
+
+		// visitor(symbol, book) for every book that exists, lowest symbol first
+		template <typename Visitor>
+		void forEachBook(Visitor&& visitor){
+			for(SymbolId symbol {}; symbol < books_.size(); ++symbol){
+				if(books_[symbol] != nullptr){
+					visitor(symbol, *books_[symbol]);
+				}
+			}
+		}
+
+		// Every book's trades come through here tagged with their symbol (called on the matching thread)
+		void setTradeSink(SymbolTradeSink sink);
+
+		[[nodiscard]] size_t getBookCount() const noexcept { return bookCount_; }
+		[[nodiscard]] size_t getMaxSymbols() const noexcept { return books_.size(); }
+
+		// No Copying
+		BookManager(const BookManager& other) = delete;
+		BookManager& operator=(const BookManager& other) = delete;
+
+		// No Moving
+		BookManager(BookManager&& other) = delete;
+		BookManager& operator=(BookManager&& other) = delete;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+
+#include "Side.h"
+#include "Using.h"
+#include "OrderType.h"
+#include "Trade.h"
+
+enum class CommandType : uint8_t{
+	Text,        // Raw client message, network -> Sequencer
+	Binary,      // Raw binary client message (BinaryProtocol.h), network -> Sequencer
+	NewOrder,    // Sequencer -> Matching
+	Cancel,      // Sequencer -> Matching
+	Modify,      // Sequencer -> Matching
+	TradeReport, // Matching -> Logger
+	LevelUpdate,  // Matching -> Logger, one per changed level per matching batch
+	RejectedOrder // Matching -> Logger, a new order the book turned down, journaled so its id and status aren't lost
+};
+
+struct TextCommand{
+	static constexpr size_t capacity {51};
+	uint32_t sequence; // Which message of its session this is (Session::getMessageCount), text reports echo it
+	uint8_t length;
+	char data[capacity];
+
+	[[nodiscard]] std::string_view view() const noexcept { return {data, length}; }
+};
+
+// Same bytes as they came off the wire, the Sequencer decodes them like it parses text
+struct BinaryCommand{
+	static constexpr size_t capacity {55};
+	uint8_t length;
+	char data[capacity];
+
+	[[nodiscard]] std::string_view view() const noexcept { return {data, length}; }
+};
+
+struct NewOrderCommand{
+	SymbolId symbol;
+	OrderId orderId;
+	Side side;
+	OrderType type;
+	Price price;
+	Quantity quantity;
+	uint64_t clientOrderId; // Echoed back in reports, 0 from text clients
+};
+
+struct CancelCommand{
+	SymbolId symbol;
+	OrderId orderId;
+	uint64_t clientOrderId;
+};
+
+struct ModifyCommand{
+	SymbolId symbol;
+	OrderId orderId;
+	Price price;
+	Quantity quantity;
+	uint64_t clientOrderId;
+};
+
+struct LevelUpdateCommand{
+	SymbolId symbol;
+	Side side;
+	Price price;
+	Quantity quantity; // New total, 0 when the level is gone
+};
+
+// Trade isn't default constructible so the report carries the fields
+struct TradeReportCommand{
+	SymbolId symbol;
+	TradeId tradeId;
+	OrderId takerOrderId;
+	OrderId makerOrderId;
+	Quantity quantity;
+	Price price;
+};
+
+// What travels through the Pipeline queues. Fixed size and trivially copyable so it's stored inline in the ring,
+// nothing is allocated per message and every queue slot is exactly one cache line
+struct alignas(64) Command{
+	CommandType type;
+	// Where a client command came from, reports about it go back there. Fits in the padding before the union
+	uint8_t server;     // Which of TradingSystem's order entry servers
+	SessionId session;  // 0 when nobody is waiting for reports (replay, tests)
+	union{
+		TextCommand text;
+		BinaryCommand binary;
+		NewOrderCommand newOrder;
+		CancelCommand cancel;
+		ModifyCommand modify;
+		TradeReportCommand tradeReport;
+		LevelUpdateCommand levelUpdate;
+	};
+
+	// Messages longer than TextCommand::capacity don't fit, callers check fitsText first
+	[[nodiscard]] static constexpr bool fitsText(std::string_view message) noexcept { return message.size() <= TextCommand::capacity; }
+
+	[[nodiscard]] static Command makeText(std::string_view message, uint32_t sequence = 0) noexcept {
+		Command command{};
+		command.type = CommandType::Text;
+		command.text.sequence = sequence;
+		command.text.length = static_cast<uint8_t>(std::min(message.size(), TextCommand::capacity));
+		std::memcpy(command.text.data, message.data(), command.text.length);
+		return command;
+	}
+
+	// Every binary message type fits, the check is for whatever else a client frames
+	[[nodiscard]] static constexpr bool fitsBinary(std::string_view message) noexcept { return message.size() <= BinaryCommand::capacity; }
+
+	[[nodiscard]] static Command makeBinary(std::string_view message) noexcept {
+		Command command{};
+		command.type = CommandType::Binary;
+		command.binary.length = static_cast<uint8_t>(std::min(message.size(), BinaryCommand::capacity));
+		std::memcpy(command.binary.data, message.data(), command.binary.length);
+		return command;
+	}
+
+	[[nodiscard]] static Command makeNewOrder(const NewOrderCommand& newOrder) noexcept {
+		Command command{};
+		command.type = CommandType::NewOrder;
+		command.newOrder = newOrder;
+		return command;
+	}
+
+	[[nodiscard]] static Command makeRejectedOrder(const NewOrderCommand& newOrder) noexcept {
+		Command command{};
+		command.type = CommandType::RejectedOrder;
+		command.newOrder = newOrder;
+		return command;
+	}
+
+	[[nodiscard]] static Command makeCancel(const CancelCommand& cancel) noexcept {
+		Command command{};
+		command.type = CommandType::Cancel;
+		command.cancel = cancel;
+		return command;
+	}
+
+	[[nodiscard]] static Command makeModify(const ModifyCommand& modify) noexcept {
+		Command command{};
+		command.type = CommandType::Modify;
+		command.modify = modify;
+		return command;
+	}
+
+	[[nodiscard]] static Command makeTradeReport(SymbolId symbol, const Trade& trade) noexcept {
+		Command command{};
+		command.type = CommandType::TradeReport;
+		command.tradeReport = TradeReportCommand{symbol, trade.getTradeId(), trade.getTakerOrderId(), trade.getMakerOrderId(), trade.getQuantity(), trade.getPrice()};
+		return command;
+	}
+
+	[[nodiscard]] static Command makeLevelUpdate(SymbolId symbol, Side side, Price price, Quantity quantity) noexcept {
+		Command command{};
+		command.type = CommandType::LevelUpdate;
+		command.levelUpdate = LevelUpdateCommand{symbol, side, price, quantity};
+		return command;
+	}
+};
+
+static_assert(sizeof(Command) == 64, "One command per cache line");
+static_assert(std::is_trivially_copyable_v<Command>, "Commands are copied in and out of the ring as raw bytes");
+
+#endif
@@ -1,11 +1,19 @@
+#ifndef CONTAINERS_H
+#define CONTAINERS_H
+
 #include <vector>
-#include <list> 
+#include <functional>
 #include <memory>
 #include <memory_resource>
 
 #include "Order.h"
 #include "Trade.h"
+#include "OrderQueue.h"
+#include "RingBuffer.h"
+
+using OrderPointer = OrderHandle; // Handle into the OrderBook's OrderStore
+using OrderPointers = OrderQueue;
+using TradeSink = std::function<void(const Trade&)>;
+using Trades = RingBuffer<Trade>; // Recent trades window, the full stream goes to the trade sink
 
-using OrderPointer = std::shared_ptr<Order>;
-using OrderPointers = std::pmr::list<OrderPointer>;
-using Trades = std::pmr::vector<Trade>;
\ No newline at end of file
+#endif
@@ -0,0 +1,44 @@
+#ifndef COUNTINGRESOURCE_H
+#define COUNTINGRESOURCE_H
+
+#include <cstddef>
+#include <memory_resource>
+
+// Pass through resource that records how much memory was pulled from its upstream
+// Sits between the OrderBook's recycling pool and the arena so the arena footprint can be observed
+class CountingResource : public std::pmr::memory_resource{
+	private:
+		std::pmr::memory_resource* upstream_;
+		size_t bytesAllocated_;   // Total ever handed out by upstream (the arena never takes memory back)
+		size_t bytesInUse_;
+		size_t allocationCount_;
+
+		void* do_allocate(size_t bytes, size_t alignment) override {
+			void* memory {upstream_->allocate(bytes, alignment)};
+			bytesAllocated_ += bytes;
+			bytesInUse_ += bytes;
+			++allocationCount_;
+			return memory;
+		}
+
+		void do_deallocate(void* memory, size_t bytes, size_t alignment) override {
+			upstream_->deallocate(memory, bytes, alignment);
+			bytesInUse_ -= bytes;
+		}
+
+		[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	public:
+		explicit CountingResource(std::pmr::memory_resource* upstream) noexcept
+			: upstream_ { upstream }
+			, bytesAllocated_ {}
+			, bytesInUse_ {}
+			, allocationCount_ {}
+			{}
+
+		[[nodiscard]] size_t getBytesAllocated() const noexcept { return bytesAllocated_; }
+		[[nodiscard]] size_t getBytesInUse() const noexcept { return bytesInUse_; }
+		[[nodiscard]] size_t getAllocationCount() const noexcept { return allocationCount_; }
+};
+
+#endif
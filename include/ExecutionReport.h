@@ -0,0 +1,68 @@
+#ifndef EXECUTION_REPORT_H
+#define EXECUTION_REPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "Using.h"
+#include "OrderParser.h"
+
+enum class ReportType : uint8_t
+{
+    Accepted,   // New order taken, its fills (if any) come right after
+    Rejected,   // Didn't parse or the book turned it down, reason says which
+    Expired,    // The rest of an IOC, FOK or market order, nothing of it rests
+    Fill,       // One trade, the taker and the maker each get one
+    Cancelled,
+    Modified
+};
+
+enum class RejectReason : uint8_t
+{
+    None,
+    Malformed,      // parseError has the details
+    NoSymbols,      // Out of symbol ids
+    Refused,        // The book didn't take it (post only crossing, price off the ladder, FOK that can't fill...)
+    UnknownOrder,   // Cancel or modify of an order that isn't resting
+    Busy,           // Shed under overload before it got to a book, nothing happened and it's fine to send again later
+    JournalFailing  // The journal can't write, nothing is taken until it can again
+};
+
+[[nodiscard]] std::string_view toString(RejectReason reason) noexcept;
+
+// What the engine tells a client about one of its commands. Made by the Sequencer (rejects) and the matching
+// threads, handed to the network thread through SPSC lanes and written out in the session's protocol
+struct ExecutionReport
+{
+    ReportType type;
+    RejectReason reason;
+    ParseError parseError;
+    uint8_t server;         // Same as the command's
+    SessionId session;
+    uint64_t clientOrderId;
+    OrderId orderId;        // 0 when the command never got one
+    Price price;            // Fill price, otherwise the order's
+    Quantity quantity;      // Fill quantity, otherwise the order's (what expired for Expired)
+    Quantity leaves;        // Still open after this report
+    bool answer;            // The one report every client command gets (ack, reject, cancel...), it hands back the session's credit
+};
+
+static_assert(std::is_trivially_copyable_v<ExecutionReport>, "Reports are copied through a lock free queue");
+
+// Longest line formatTextReport writes
+inline constexpr size_t maxTextReportLength {96};
+
+// One newline terminated line for text sessions, written into out without allocating. Returns its length
+// <seq> is clientOrderId, for text sessions the number of the message the report is about (1 for the session's first)
+//   ACCEPTED <seq> <order id> <price> <qty>
+//   REJECTED <seq> <order id> <reason>
+//   EXPIRED <seq> <order id> <qty>
+//   FILL <seq> <order id> <price> <qty> <leaves>
+//   CANCELLED <seq> <order id> <qty>
+//   MODIFIED <seq> <order id> <price> <qty>
+[[nodiscard]] size_t formatTextReport(const ExecutionReport& report, std::span<char, maxTextReportLength> out) noexcept;
+
+#endif
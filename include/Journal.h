@@ -0,0 +1,152 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Arena.h"
+#include "Command.h"
+
+// When the journal asks the OS to put written records on disk
+enum class JournalFsync : uint8_t
+{
+    Never,          // Leave it to the page cache, survives a crash of the process but not of the machine
+    EveryCommit,    // fdatasync after every group commit
+    Interval        // fdatasync on a commit once JournalConfig::fsyncInterval has passed since the last one, and
+                    // on Journal::idle so a tail committed just before traffic stops isn't left unsynced for good
+};
+
+struct JournalConfig
+{
+    std::string path {};                                // Empty turns journaling off
+    size_t bufferSize {64 * 1024};                      // Per buffer, rounded up to whole pages
+    size_t bufferCount {8};                             // Buffers that can fill up between two commits, written with one writev
+    JournalFsync fsync {JournalFsync::Interval};
+    std::chrono::milliseconds fsyncInterval {10};
+    bool truncate {false};                              // Start a new journal instead of appending to the file
+};
+
+enum class JournalRecordType : uint8_t
+{
+    NewOrder = 1,
+    Cancel,
+    Modify,
+    Trade
+};
+
+// Fixed width so the file can be read back without framing. Fields are in host byte order (little endian everywhere we run)
+struct JournalRecord
+{
+    uint64_t sequence;          // 1, 2, 3... for the life of the file, filled in by Journal::append
+    JournalRecordType type;
+    uint8_t side;               // Side, NewOrder only
+    uint8_t orderType;          // OrderType, NewOrder only
+    uint8_t rejected;           // NewOrder only, 1 when the book turned it down (it still used up its id and a status)
+    SymbolId symbol;
+    OrderId orderId;            // Taker for trades
+    OrderId makerOrderId;       // Trades only
+    Price price;
+    Quantity quantity;
+    TradeId tradeId;            // Trades only
+    uint32_t padding;
+
+    // Matching's commands and trade reports map one to one onto records, anything else isn't journaled
+    [[nodiscard]] static bool isJournaled(const Command& command) noexcept;
+    [[nodiscard]] static JournalRecord fromCommand(const Command& command) noexcept;
+};
+
+static_assert(sizeof(JournalRecord) == 48, "Journal record layout is part of the file format");
+static_assert(std::is_trivially_copyable_v<JournalRecord>, "Records are written as raw bytes");
+
+struct JournalStats
+{
+    uint64_t records {};
+    uint64_t bytesWritten {};
+    uint64_t commits {};    // writev calls that wrote something
+    uint64_t syncs {};      // fdatasync calls
+};
+
+// Append only binary journal. Records are copied into preallocated page aligned buffers and written out together
+// by commit() (group commit), which is called at the end of every Logger batch or when all the buffers are full
+// Only ever used from one thread (the Logger stage), the matching threads never touch the file
+class Journal{
+    private:
+        JournalConfig config_;
+        int fd_;
+        Arena buffers_;                 // bufferCount buffers of bufferSize bytes back to back
+        size_t bufferSize_;
+        size_t recordsPerBuffer_;
+        std::vector<size_t> used_;      // Bytes used in each buffer
+        size_t current_;                // Buffer being filled
+        size_t written_;                // Bytes of the buffers already in the file, a failed commit resumes after them
+        uint64_t nextSequence_;
+        std::chrono::steady_clock::time_point lastSync_;
+        bool unsynced_;                 // An Interval commit skipped its sync
+        JournalStats stats_;
+
+        void openFile();
+        void writeBuffers();
+        void sync();
+
+    public:
+        explicit Journal(const JournalConfig& config);
+        ~Journal();
+
+        // Never blocks on disk unless every buffer is full, then it commits first. When that commit throws the record
+        // isn't taken (no sequence number is used up), the caller keeps it and tries again
+        void append(JournalRecord record);
+
+        // Writes everything appended so far with a single writev and syncs as the fsync policy says
+        void commit();
+
+        // The caller has nothing more to append for now. Syncs whatever an Interval commit left unsynced, the
+        // interval only spaces syncs out while records keep coming
+        void idle();
+
+        [[nodiscard]] uint64_t getNextSequence() const noexcept { return nextSequence_; }
+        [[nodiscard]] const JournalStats& getStats() const noexcept { return stats_; }
+        [[nodiscard]] const std::string& getPath() const noexcept { return config_.path; }
+
+        // No Copying
+        Journal(const Journal& other) = delete;
+        Journal& operator=(const Journal& other) = delete;
+
+        // No Moving
+        Journal(Journal&& other) = delete;
+        Journal& operator=(Journal&& other) = delete;
+};
+
+// Reads a journal front to back in big chunks. Stops at the end of the file, at a torn last record
+// or at the first sequence gap (nothing after a gap can be trusted to be in order)
+class JournalReader{
+    private:
+        int fd_;
+        std::vector<std::byte> buffer_;
+        size_t filled_;
+        size_t offset_;
+        uint64_t expectedSequence_;
+        bool gap_;
+
+        bool refill();
+
+    public:
+        explicit JournalReader(const std::string& path, size_t chunkSize = 1 << 20);
+        ~JournalReader();
+
+        [[nodiscard]] bool next(JournalRecord& record);
+        [[nodiscard]] bool hitGap() const noexcept { return gap_; }
+
+        // No Copying
+        JournalReader(const JournalReader& other) = delete;
+        JournalReader& operator=(const JournalReader& other) = delete;
+
+        // No Moving
+        JournalReader(JournalReader&& other) = delete;
+        JournalReader& operator=(JournalReader&& other) = delete;
+};
+
+#endif
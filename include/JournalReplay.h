@@ -0,0 +1,74 @@
+#ifndef JOURNAL_REPLAY_H
+#define JOURNAL_REPLAY_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "Journal.h"
+#include "OrderBook.h"
+
+struct ReplayStats
+{
+    uint64_t records {};
+    uint64_t newOrders {};
+    uint64_t cancels {};
+    uint64_t modifies {};
+    uint64_t trades {};         // Skipped, matching the orders again makes the same trades with the same ids
+    uint64_t mismatches {};     // The book answered differently than it did live (took an order it turned down or the other way round), means the journal doesn't fit the books
+    OrderId lastOrderId {};     // Highest order id seen, turned down orders included, the next live order id goes after it
+    uint64_t lastSequence {};
+    bool stoppedAtGap {false};
+    std::chrono::nanoseconds elapsed {};
+};
+
+// Feeds every order, cancel and modify of a journal straight into the books in journal order, no parsing or queues
+// bookFor(symbol) returns the OrderBook& the symbol lives in. Books should have no trade sink while this runs,
+// otherwise the replayed trades are reported a second time
+// Orders the book turned down live are journaled as well and turned down again, so everything that's derived from
+// the order flow (levels, statuses of every order including the turned down ones, trade ids) comes out the same as it was live
+template <typename BookFor>
+ReplayStats replayJournal(const std::string& path, BookFor&& bookFor)
+{
+    const auto start {std::chrono::steady_clock::now()};
+    ReplayStats stats{};
+    JournalReader reader{path};
+    JournalRecord record{};
+
+    while (reader.next(record)) {
+        ++stats.records;
+        stats.lastSequence = record.sequence;
+        bool asLive {true};
+
+        switch (record.type) {
+            case JournalRecordType::NewOrder: {
+                ++stats.newOrders;
+                stats.lastOrderId = std::max(stats.lastOrderId, record.orderId);
+                const Order order{static_cast<Side>(record.side), record.price, record.orderId, static_cast<OrderType>(record.orderType), record.quantity, record.quantity};
+                asLive = bookFor(record.symbol).processOrder(order) == (record.rejected == 0);
+                break;
+            }
+            case JournalRecordType::Cancel:
+                ++stats.cancels;
+                asLive = bookFor(record.symbol).cancelOrder(record.orderId);
+                break;
+            case JournalRecordType::Modify:
+                ++stats.modifies;
+                asLive = bookFor(record.symbol).modifyOrder(record.orderId, record.quantity, record.price);
+                break;
+            case JournalRecordType::Trade:
+                ++stats.trades;
+                break;
+        }
+        if (!asLive) {
+            ++stats.mismatches;
+        }
+    }
+
+    stats.stoppedAtGap = reader.hitGap();
+    stats.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return stats;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// HDR style histogram of latencies in nanoseconds (or any other unsigned count). Values below 2^subBucketBits are
+// counted exactly, above that every power of two is split into 2^(subBucketBits - 1) equal buckets, so any value is
+// off by less than 1 / 2^(subBucketBits - 1) (under 1% with the default). Fixed size, record() is a couple of shifts
+// and an increment, nothing is allocated and any value up to UINT64_MAX fits
+template <unsigned SubBucketBits = 8>
+class BasicLatencyHistogram{
+    private:
+        static constexpr uint64_t subBucketCount_ {uint64_t{1} << SubBucketBits};
+        static constexpr uint64_t halfCount_ {subBucketCount_ / 2};
+        static constexpr size_t bucketCount_ {subBucketCount_ + (64 - SubBucketBits) * halfCount_};
+
+        std::array<uint64_t, bucketCount_> counts_;
+        uint64_t count_;
+        uint64_t min_;
+        uint64_t max_;
+        long double sum_;
+
+        [[nodiscard]] static constexpr size_t indexOf(uint64_t value) noexcept {
+            if(value < subBucketCount_){
+                return static_cast<size_t>(value);
+            }
+            // value >> shift lands in [halfCount_, subBucketCount_), the shift picks the power of two
+            const unsigned shift {static_cast<unsigned>(std::bit_width(value)) - SubBucketBits};
+            return static_cast<size_t>(shift * halfCount_ + (value >> shift));
+        }
+
+        // Largest value that lands in the bucket, what HDR reports as the equivalent value
+        [[nodiscard]] static constexpr uint64_t highestValueOf(size_t index) noexcept {
+            if(index < subBucketCount_){
+                return index;
+            }
+            const uint64_t shift {index / halfCount_ - 1};
+            const uint64_t mantissa {index % halfCount_ + halfCount_};
+            return ((mantissa + 1) << shift) - 1;
+        }
+
+    public:
+        BasicLatencyHistogram() noexcept
+        : counts_{}
+        , count_{}
+        , min_{UINT64_MAX}
+        , max_{}
+        , sum_{}
+        {}
+
+        void record(uint64_t value) noexcept {
+            ++counts_[indexOf(value)];
+            ++count_;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+            sum_ += value;
+        }
+
+        void merge(const BasicLatencyHistogram& other) noexcept {
+            for(size_t i {}; i < bucketCount_; ++i){
+                counts_[i] += other.counts_[i];
+            }
+            count_ += other.count_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+            sum_ += other.sum_;
+        }
+
+        void reset() noexcept { *this = BasicLatencyHistogram{}; }
+
+        // Smallest recorded value that at least fraction (0.0 to 1.0) of the values are at or below, within the
+        // bucket precision and never past the real max. 0 when nothing was recorded
+        [[nodiscard]] uint64_t percentile(double fraction) const noexcept {
+            if(count_ == 0){
+                return 0;
+            }
+            const double clamped {std::clamp(fraction, 0.0, 1.0)};
+            const uint64_t rank {std::max<uint64_t>(1, static_cast<uint64_t>(clamped * static_cast<double>(count_) + 0.5))};
+            uint64_t seen {};
+            for(size_t i {}; i < bucketCount_; ++i){
+                seen += counts_[i];
+                if(seen >= rank){
+                    return std::min(highestValueOf(i), max_);
+                }
+            }
+            return max_;
+        }
+
+        [[nodiscard]] uint64_t getCount() const noexcept { return count_; }
+        [[nodiscard]] uint64_t getMin() const noexcept { return count_ == 0 ? 0 : min_; }
+        [[nodiscard]] uint64_t getMax() const noexcept { return max_; }
+        [[nodiscard]] double getMean() const noexcept { return count_ == 0 ? 0.0 : static_cast<double>(sum_ / count_); }
+};
+
+using LatencyHistogram = BasicLatencyHistogram<>;
+
+#endif
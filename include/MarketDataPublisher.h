@@ -0,0 +1,111 @@
+#ifndef MARKET_DATA_PUBLISHER_H
+#define MARKET_DATA_PUBLISHER_H
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Using.h"
+#include "Side.h"
+
+struct MarketDataConfig
+{
+    std::string socketPath {};      // Unix socket subscribers connect to, empty turns publishing off
+    size_t levelsPerPacket {64};    // Level updates sent per SOCK_SEQPACKET packet
+    size_t maxSubscribers {64};     // Connections past this are closed right away
+};
+
+// What subscribers read. Every packet is one MarketDataHeader followed by header.count MarketDataLevel,
+// fixed width and little endian. A subscriber's first packets are a snapshot of every level (flags & snapshotFlag)
+struct MarketDataHeader
+{
+    static constexpr uint32_t snapshotFlag {1};
+
+    uint64_t sequence;  // Per subscriber packet number starting at 1
+    uint32_t count;
+    uint32_t flags;
+};
+
+struct MarketDataLevel
+{
+    SymbolId symbol;
+    Price price;
+    Quantity quantity;  // New total, 0 when the level is gone
+    uint8_t side;       // Side
+    uint8_t padding[3];
+};
+
+static_assert(sizeof(MarketDataHeader) == 16 && sizeof(MarketDataLevel) == 16, "Wire layout");
+
+struct MarketDataStats
+{
+    uint64_t batches {};        // publish() calls with something new
+    uint64_t levelsSent {};     // Summed over subscribers
+    uint64_t packetsSent {};
+    uint64_t conflated {};      // Pending level updates a newer one replaced before a slow subscriber took them
+    uint64_t disconnects {};
+};
+
+// L2 fan out for the Logger stage. Level updates coming out of matching are conflated per batch, publish() then
+// hands the batch to every subscriber. Each subscriber has its own pending set keyed by level, when its socket is
+// full the rest waits there and newer totals overwrite older ones, so a slow consumer gets the latest state later
+// instead of slowing down everyone else. What didn't fit goes out on the next publish. Sends never block
+// Only ever used from one thread
+class MarketDataPublisher{
+    public:
+        struct LevelKey
+        {
+            SymbolId symbol;
+            Side side;
+            Price price;
+
+            auto operator<=>(const LevelKey& other) const = default;
+        };
+
+    private:
+        struct Subscriber
+        {
+            int fd;
+            uint64_t sequence {};
+            bool snapshot {true};                   // Still sending the snapshot it got when it connected
+            std::map<LevelKey, Quantity> pending;   // Conflated, latest total per level
+        };
+
+        MarketDataConfig config_;
+        int listenFd_;
+        std::map<LevelKey, Quantity> levels_;   // Current L2 state of every symbol, the snapshot for new subscribers
+        std::map<LevelKey, Quantity> batch_;    // Updates since the last publish, conflated
+        std::vector<Subscriber> subscribers_;
+        std::vector<std::byte> packet_;
+        MarketDataStats stats_;
+
+        void acceptSubscribers();
+        bool flush(Subscriber& subscriber); // False once the subscriber is gone
+        void closeSocket(int fd) noexcept;
+
+    public:
+        explicit MarketDataPublisher(const MarketDataConfig& config);
+        ~MarketDataPublisher();
+
+        void update(SymbolId symbol, Side side, Price price, Quantity quantity);
+
+        // End of a batch, picks up new subscribers and sends them what they're missing
+        void publish();
+
+        [[nodiscard]] size_t getSubscriberCount() const noexcept { return subscribers_.size(); }
+        [[nodiscard]] const MarketDataStats& getStats() const noexcept { return stats_; }
+        [[nodiscard]] Quantity getLevel(SymbolId symbol, Side side, Price price) const; // 0 when there is no such level
+
+        // No Copying
+        MarketDataPublisher(const MarketDataPublisher& other) = delete;
+        MarketDataPublisher& operator=(const MarketDataPublisher& other) = delete;
+
+        // No Moving
+        MarketDataPublisher(MarketDataPublisher&& other) = delete;
+        MarketDataPublisher& operator=(MarketDataPublisher&& other) = delete;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef MARKETDEPTH_H
+#define MARKETDEPTH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Using.h"
+#include "Side.h"
+
+// Aggregated view of one price level
+struct LevelSnapshot
+{
+	Price price {};
+	Quantity quantity {};
+	uint32_t orderCount {};
+
+	bool operator==(const LevelSnapshot& other) const = default;
+};
+
+// New total of one price level, quantity 0 means the level is gone
+struct LevelUpdate
+{
+	Side side {};
+	Price price {};
+	Quantity quantity {};
+
+	bool operator==(const LevelUpdate& other) const = default;
+};
+
+// Caller owned L2 snapshot, filled best first on each side by OrderBook::getDepth without allocating
+template <size_t MaxLevels>
+struct MarketDepth
+{
+	std::array<LevelSnapshot, MaxLevels> bids {};
+	std::array<LevelSnapshot, MaxLevels> asks {};
+	size_t bidLevels {};
+	size_t askLevels {};
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include <map>
 #include <vector>
 #include <functional>
+#include <span>
 #include <algorithm>
 #include <stdexcept>
 #include <string>  
@@ -18,94 +19,208 @@
 #include "Order.h"
 #include "Using.h" 
 #include "OrderType.h"
+#include "OrderPolicy.h"
 #include "Side.h"
 #include "Containers.h"
 #include "OrderState.h"
+#include "OrderStatus.h"
+#include "OrderIndex.h"
+#include "MarketDepth.h"
+#include "OrderResult.h"
+#include "PriceLadder.h"
+#include "OrderBookConfig.h"
+#include "OrderStore.h"
+#include "CountingResource.h"
+#include "Arena.h"
 
 class OrderBook{
 	private: 
 		// Preallocated mem
-		size_t bufferSize_;
-		std::unique_ptr<std::byte[]> rawMemory_;
-		std::pmr::monotonic_buffer_resource pool_;
+		Arena rawMemory_;
+		std::pmr::monotonic_buffer_resource arena_; // Hands out fresh memory but never takes it back
+		CountingResource arenaUsage_;
+		std::pmr::unsynchronized_pool_resource pool_; // Size class free lists on top of the arena so freed blocks get reused
 
 		// Containers
-		Trades trades_;
-		std::pmr::map<Price, OrderPointers, std::greater<Price>> bids_; // greatest to smallest
-		std::pmr::map<Price, OrderPointers, std::less<Price>> asks_; // smallest to largest
+		Trades trades_; // Bounded window of the latest trades
+		TradeSink tradeSink_; // Every trade is streamed through here as it happens
+		std::pmr::vector<LevelUpdate> levelUpdates_; // Level totals changed since the last clearLevelUpdates
+		bool recordLevelUpdates_;
+		PriceLadder<OrderPointers, Side::Buy> bids_; // best is the highest price
+		PriceLadder<OrderPointers, Side::Sell> asks_; // best is the lowest price
 
-		struct OrderEntry{
-			OrderPointer order_ { nullptr };
-			OrderPointers::iterator location_;		
-		};
-		std::pmr::unordered_map<OrderId, OrderEntry> orders_;
+		OrderStore orderStore_; // Every resting order lives in here, hot fields and cold fields in separate arrays
 
-		struct OrderStatus
-		{
-			Price price {};
-			OrderType type {};
-			Side side {};
-			OrderState state {OrderState::Processing};
-			Quantity remainingQuantity {};
-			Quantity filledQuantity {0};
-		};
-		std::pmr::unordered_map<OrderId, OrderStatus> statusCache_;
+		OrderIndex index_; // Resting node and status of every order by id
+		using IndexSlot = OrderIndex::Slot;
+
+		// Ids of finished orders oldest first, once full the oldest status is dropped from index_
+		std::pmr::vector<OrderId> retiredIds_;
+		size_t retiredHead_;
+		size_t statusRetention_;
 
 		// Numericals
 		TradeId nextTradeId_; // For simplicity trade ids will start from 1 
+		uint64_t nextSequence_; // Stamped on orders as they join a level
 		Quantity quantityOfBids_;
 		Quantity quantityOfAsks_;
 
-		// Custom Template Helpers 
-		template<typename OrderMap>	       
-		void fillOrders(OrderMap& orderMap, const OrderPointer& incomingOrder);
+		// Side picked at compile time so the match kernel never branches on it
+		template<Side S>
+		[[nodiscard]] auto& ladderFor() noexcept {
+			if constexpr (S == Side::Buy){ return bids_; } else { return asks_; }
+		}
+
+		template<Side S>
+		[[nodiscard]] const auto& ladderFor() const noexcept {
+			if constexpr (S == Side::Buy){ return bids_; } else { return asks_; }
+		}
+
+		template<Side S>
+		[[nodiscard]] Quantity& quantityFor() noexcept {
+			if constexpr (S == Side::Buy){ return quantityOfBids_; } else { return quantityOfAsks_; }
+		}
+
+		// Called whenever a level's total changes, a sweep records each level once after it's done with it
+		template<Side S>
+		void levelChanged(Price price, Quantity quantity){
+			if(recordLevelUpdates_){
+				levelUpdates_.push_back(LevelUpdate{S, price, quantity});
+			}
+		}
+
+		// Custom Template Helpers, one instantiation per taker side and order type policy (see OrderPolicy.h)
+		template<Side TakerSide, typename Policy>
+		void fillOrders(Order& incomingOrder, OrderStatus& incomingStatus);
+
+		template<Side RestingSide>
+		void addOrderToOrderBook(const Order& incomingOrder, IndexSlot& incomingSlot);
+
+		// Put a stored order at the back of its price level / take it out of its level, the store slot itself is never freed here
+		template<Side RestingSide>
+		void linkNode(OrderPointer handle);
 
-		template<typename OrderMap>
-		void addOrderToOrderBook(OrderMap& orderMap, const OrderPointer& incomingOrder);
+		template<Side RestingSide>
+		void unlinkNode(OrderPointer handle);
+
+		template<Side RestingSide>
+		bool modifyRestingOrder(IndexSlot& slot, const Quantity& quantity, const Price& price);
+
+		template<Side TakerSide, bool PriceLimited>
+		[[nodiscard]] bool canFillCompletely(const Order& incomingOrder) const;
+
+		template<Side TakerSide, typename Policy>
+		bool executeOrder(Order& incomingOrder, IndexSlot& slot);
+
+		template<Side TakerSide>
+		bool dispatchOrderType(Order& incomingOrder, IndexSlot& slot);
+
+		void retireStatus(const OrderId& orderId);
+
+		// processOrder, plus the slot the order was matched in (nullptr for invalid or duplicate ids). Slot pointers
+		// hold until the next insert so the caller can read the final status without another lookup
+		[[nodiscard]] bool matchOrder(Order order, IndexSlot*& slot);
+
+		// Blocks up to this size are recycled by pool_
+		// Anything bigger (index table, ladder windows, slabs) is a one off that goes straight to the arena
+		[[nodiscard]] static std::pmr::pool_options poolOptions() noexcept {
+			std::pmr::pool_options options{};
+			options.max_blocks_per_chunk = 4096;
+			options.largest_required_pool_block = 64 * 1024;
+			return options;
+		}
 	
 	public:
 		OrderBook()
-		: bufferSize_ {1024 * 1024 * 1024} // 1 GB
-		, rawMemory_{std::make_unique<std::byte[]>(bufferSize_)}
-		, pool_{rawMemory_.get(), bufferSize_}
-		, trades_(&pool_)
-		, bids_{&pool_}
-		, asks_{&pool_}
-		, orders_{&pool_}
-		, statusCache_{&pool_}
+		: OrderBook(OrderBookConfig{})
+		{}
+
+		explicit OrderBook(const OrderBookConfig& config)
+		: rawMemory_{config.arenaSize, config.arenaPaging, config.arenaWarmup}
+		, arena_{rawMemory_.data(), rawMemory_.size()}
+		, arenaUsage_{&arena_}
+		, pool_{poolOptions(), &arenaUsage_}
+		, trades_(config.recentTrades, &pool_)
+		, tradeSink_{}
+		, levelUpdates_{&pool_}
+		, recordLevelUpdates_{config.levelUpdates}
+		, bids_{config.tickSize, config.ladderLevels, config.maxLadderLevels, &pool_}
+		, asks_{config.tickSize, config.ladderLevels, config.maxLadderLevels, &pool_}
+		, orderStore_{config.expectedOpenOrders, &pool_}
+		, index_{config.expectedOpenOrders + std::max<size_t>(config.statusRetention, 1), &pool_}
+		, retiredIds_{&pool_}
+		, retiredHead_{}
+		, statusRetention_{std::max<size_t>(config.statusRetention, 1)}
 		, nextTradeId_{1}
+		, nextSequence_{}
 		, quantityOfBids_{}
 		, quantityOfAsks_{}
 		{
-			trades_.reserve(100'000);
-			orders_.reserve(100'000);
+			retiredIds_.reserve(statusRetention_);
 		}
         
 		[[nodiscard]] bool processOrder(Order order); // Later down the road have it return the order id 
+		// Burst version of processOrder, outcome i goes to results[i]. Returns how many orders were processed (min of both sizes)
+		size_t processOrders(std::span<const Order> orders, std::span<OrderResult> results);
+		// quantity is the new open quantity. Shrinking at the same price keeps the order's place in the queue,
+		// growing it or changing the price sends it to the back (a new price can trade right away)
 		[[nodiscard]] bool modifyOrder(const OrderId& orderId, const Quantity& quantity, const Price& price);
 		[[nodiscard]] bool cancelOrder(const OrderId& orderId);
 		[[nodiscard]] const OrderStatus reviewOrderStatus(const OrderId& orderId) const;
 		
-		[[nodiscard]] inline const Trades& getTrades() const noexcept {return trades_; }
+		[[nodiscard]] inline const Trades& getTrades() const noexcept {return trades_; } // Only the most recent OrderBookConfig::recentTrades
+		void setTradeSink(TradeSink sink) { tradeSink_ = std::move(sink); } // Called on the matching thread for each trade
+		// Every level total change since the last clear, oldest first. Empty unless OrderBookConfig::levelUpdates is set
+		[[nodiscard]] inline std::span<const LevelUpdate> getLevelUpdates() const noexcept { return levelUpdates_; }
+		inline void clearLevelUpdates() noexcept { levelUpdates_.clear(); }
+
+		// Every level of both sides as a LevelUpdate, best first. A full walk for snapshots, not for the hot path
+		template <typename Visitor>
+		void forEachLevel(Visitor&& visitor) const {
+			bids_.forEachLevelWhile([&visitor](Price price, const OrderPointers& level){
+				visitor(LevelUpdate{Side::Buy, price, level.getTotalQuantity()});
+				return true;
+			});
+			asks_.forEachLevelWhile([&visitor](Price price, const OrderPointers& level){
+				visitor(LevelUpdate{Side::Sell, price, level.getTotalQuantity()});
+				return true;
+			});
+		}
 		[[nodiscard]] inline const Quantity& getQuantityOfAsks() const noexcept { return quantityOfAsks_; }
 		[[nodiscard]] inline const Quantity& getQuantityOfBids() const noexcept { return quantityOfBids_; } 	
+		[[nodiscard]] inline size_t getArenaBytesUsed() const noexcept { return arenaUsage_.getBytesAllocated(); } // How much of the arena the book has claimed so far
+		[[nodiscard]] inline const ArenaStats& getArenaStats() const noexcept { return rawMemory_.getStats(); } // Startup cost of the arena (time, page faults)
 
 		// Public functions 
 		[[nodiscard]] const Price getBestBid() const { 	
 			if(!bids_.empty()){ 
-				return bids_.begin()->first;
+				return bids_.getBestPrice();
 			}		
 			return 0;
 		}
 
 		[[nodiscard]] const Price getBestAsk() const { 
 			if(!asks_.empty()){
-				return asks_.begin()->first;
+				return asks_.getBestPrice();
 			}	
 		
 			return 0;		
 		}
 
+		// Top levels on each side into a caller owned snapshot, O(levels) and no allocation so it's fine to call after every event
+		template <size_t MaxLevels>
+		void getDepth(MarketDepth<MaxLevels>& depth, size_t levels = MaxLevels) const {
+			levels = std::min(levels, MaxLevels);
+			depth.bidLevels = 0;
+			depth.askLevels = 0;
+			bids_.forEachLevel(levels, [&depth](Price price, const OrderPointers& level){
+				depth.bids[depth.bidLevels++] = LevelSnapshot{price, level.getTotalQuantity(), static_cast<uint32_t>(level.size())};
+			});
+			asks_.forEachLevel(levels, [&depth](Price price, const OrderPointers& level){
+				depth.asks[depth.askLevels++] = LevelSnapshot{price, level.getTotalQuantity(), static_cast<uint32_t>(level.size())};
+			});
+		}
+
 		void display(size_t depth = 5) const; // This method is unpractical but it helps to visualize so I'll keep it 
 
 		// No Copying 
@@ -0,0 +1,23 @@
+#ifndef ORDERBOOKCONFIG_H
+#define ORDERBOOKCONFIG_H
+
+#include <cstddef>
+
+#include "Using.h"
+#include "Arena.h"
+
+// Per book tuning knobs. Defaults fit an instrument quoted in whole price units
+struct OrderBookConfig{
+	size_t arenaSize {1024 * 1024 * 1024};           // 1 GB reserved up front, only touched pages cost RSS
+	ArenaPaging arenaPaging {ArenaPaging::Default};
+	ArenaWarmup arenaWarmup {ArenaWarmup::None};     // Prefault/lock for latency critical books
+	Price tickSize {1};                  // Every resting price must be a multiple of this
+	size_t ladderLevels {4096};          // Initial price window per side (in ticks)
+	size_t maxLadderLevels {1 << 22};    // Window is allowed to grow up to this many ticks before orders are rejected
+	size_t statusRetention {1 << 18};    // Finished (filled/cancelled/expired/rejected) statuses kept for reviewOrderStatus
+	size_t expectedOpenOrders {100'000}; // Sizes the order index up front so it doesn't rehash under normal load
+	size_t recentTrades {100'000};       // How many of the latest trades getTrades() keeps, 0 turns the window off
+	bool levelUpdates {false};           // Record every change to a level's total for getLevelUpdates, the owner has to clear them
+};
+
+#endif
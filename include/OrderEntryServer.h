@@ -0,0 +1,170 @@
+#ifndef ORDER_ENTRY_SERVER_H
+#define ORDER_ENTRY_SERVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "Using.h"
+
+// How a session's byte stream is cut into messages
+enum class OrderEntryProtocol : uint8_t
+{
+    Text,       // Newline terminated commands, see OrderParser.h
+    Binary      // Length prefixed fixed width messages, see BinaryProtocol.h
+};
+
+struct OrderEntryConfig
+{
+    std::string address {"0.0.0.0"};
+    uint16_t port {1030};               // 0 picks a free port, see OrderEntryServer::getPort
+    size_t maxSessions {4096};          // Connections past this are closed right away
+    size_t receiveBufferSize {4096};    // Per session, allocated once. Also the longest message a session can send
+    size_t sendBufferSize {64 * 1024};  // Per session, allocated on its first reply. A client that lets this much pile up is cut off
+    OrderEntryProtocol protocol {OrderEntryProtocol::Text};
+    uint32_t creditWindow {0};          // Messages a session can have handed over and not yet released before it stops being read, 0 for no limit
+};
+
+struct OrderEntryStats
+{
+    uint64_t sessionsAccepted {};
+    uint64_t sessionsRefused {};    // Over maxSessions
+    uint64_t sessionsClosed {};
+    uint64_t messages {};
+    uint64_t bytesReceived {};
+    uint64_t reads {};              // Completed async reads, messages / reads is how many messages one read carried
+    uint64_t oversized {};          // Messages longer than the receive buffer, dropped up to their newline
+    uint64_t badFraming {};         // Binary sessions closed over a length that can't be right
+    uint64_t bytesSent {};
+    uint64_t writes {};             // Completed async writes, everything queued on a session while one is out goes in the next
+    uint64_t slowConsumers {};      // Sessions closed because their send buffer filled up
+    uint64_t creditStalls {};       // Times a session ran out of credits and reading it was put off
+};
+
+class OrderEntryServer;
+
+// One client connection. Lives as long as the socket is open and a read is pending on it. Text messages are newline
+// terminated ("\r\n" works too), binary ones start with their length. A read can carry several of them or end in the
+// middle of one, the unfinished part is moved to the front of the buffer and completed by the next read, so nothing
+// is copied per message
+// With a credit window every message handed over takes a credit until OrderEntryServer::release gives it back. Out
+// of credits the session stops framing and reading, what's already in the buffer waits there and TCP flow control
+// pushes back on the client, so a flooding client slows itself down instead of everyone behind it
+// Replies are copied into a ring and written out by flush, the ring's used part is one or two buffers so that's a
+// single gather write however many replies went in. Only one write is out at a time, the next one takes whatever
+// was queued meanwhile
+class Session : public std::enable_shared_from_this<Session>{
+    private:
+        friend class OrderEntryServer;
+
+        OrderEntryServer& server_;
+        boost::asio::ip::tcp::socket socket_;
+        SessionId id_;
+        std::vector<char> buffer_;
+        size_t used_;           // Bytes of an unfinished message at the front of buffer_
+        bool discarding_;       // Dropping an oversized message until its newline
+        std::vector<char> sendBuffer_;
+        size_t sendHead_;       // Oldest unsent byte
+        size_t sendSize_;       // Queued bytes, the first sendInFlight_ of them are being written
+        size_t sendInFlight_;
+        bool dirty_;            // On the server's list of sessions to flush
+        uint32_t inFlight_;     // Messages handed over and not released yet
+        uint32_t messages_;     // Messages handed over since the session started, blank lines don't count
+        bool stalled_;          // Out of credits, no read is pending
+
+        void read();
+        void onRead(const boost::system::error_code& error, size_t bytes);
+        void process(size_t scan, size_t end);
+        // Both hand over every complete message in buffer_[0, end) they have credits for and return where the first
+        // one not handed over starts. New text (the only part that can hold a newline) starts at scan
+        [[nodiscard]] size_t frameText(size_t scan, size_t end);
+        [[nodiscard]] size_t frameBinary(size_t end);
+        [[nodiscard]] bool hasCredit() const noexcept;
+        void deliver(std::string_view message);
+        void release(uint32_t credits);
+        void queue(std::string_view bytes);
+        void flush();
+        void write();
+        void onWrite(const boost::system::error_code& error, size_t bytes);
+
+    public:
+        Session(OrderEntryServer& server, boost::asio::ip::tcp::socket socket, SessionId id, size_t bufferSize);
+
+        void start();
+        void close();
+
+        [[nodiscard]] SessionId getId() const noexcept { return id_; }
+        // Inside the message handler it's the number of the message being handled, the first one is 1
+        [[nodiscard]] uint32_t getMessageCount() const noexcept { return messages_; }
+
+        // No Copying
+        Session(const Session& other) = delete;
+        Session& operator=(const Session& other) = delete;
+
+        // No Moving
+        Session(Session&& other) = delete;
+        Session& operator=(Session&& other) = delete;
+};
+
+// Accepts order entry connections and keeps them open, every session is served asynchronously by whichever thread
+// runs the io_context (epoll on Linux). Run the io_context on one thread only, handlers (and the message handler)
+// are never called concurrently which is what lets the message handler feed the single producer Sequencer queue
+class OrderEntryServer{
+    public:
+        // Called once per complete message, without the newline (binary ones whole, header included)
+        // The view points into the session's buffer
+        using MessageHandler = std::function<void(Session& session, std::string_view message)>;
+
+    private:
+        friend class Session;
+
+        OrderEntryConfig config_;
+        boost::asio::ip::tcp::acceptor acceptor_;
+        MessageHandler handler_;
+        std::unordered_map<SessionId, std::shared_ptr<Session>> sessions_;
+        std::vector<std::shared_ptr<Session>> dirty_; // Sessions with replies queued since the last flush
+        SessionId nextSessionId_;
+        OrderEntryStats stats_;
+
+        void accept();
+        void remove(SessionId id);
+
+    public:
+        // Binds and starts accepting right away, throws boost::system::system_error if the port can't be had
+        OrderEntryServer(boost::asio::io_context& ioContext, const OrderEntryConfig& config, MessageHandler handler);
+        ~OrderEntryServer();
+
+        // Stops accepting and closes every session
+        void stop();
+
+        // Queues a reply on a session, nothing goes out until flush. Sessions that are gone are skipped
+        void send(SessionId id, std::string_view bytes);
+
+        // One write per session that had something queued (unless it's still writing, then it goes after that)
+        void flush();
+
+        // Hands back credits for messages that are done with, a stalled session picks up where it stopped
+        void release(SessionId id, uint32_t credits = 1);
+
+        [[nodiscard]] uint16_t getPort() const;
+        [[nodiscard]] size_t getSessionCount() const noexcept { return sessions_.size(); }
+        [[nodiscard]] const OrderEntryStats& getStats() const noexcept { return stats_; }
+
+        // No Copying
+        OrderEntryServer(const OrderEntryServer& other) = delete;
+        OrderEntryServer& operator=(const OrderEntryServer& other) = delete;
+
+        // No Moving
+        OrderEntryServer(OrderEntryServer&& other) = delete;
+        OrderEntryServer& operator=(OrderEntryServer&& other) = delete;
+};
+
+#endif
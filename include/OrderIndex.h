@@ -0,0 +1,142 @@
+#ifndef ORDERINDEX_H
+#define ORDERINDEX_H
+
+#include <bit>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <memory_resource>
+
+#include "Using.h"
+#include "OrderStore.h"
+#include "OrderStatus.h"
+
+// Single flat lookup for every order the book knows about (resting handle + live/finished status in one slot)
+// Open addressing with linear probing on id & mask, ids handed out sequentially land in consecutive slots so a lookup is one probe
+// Erase leaves a tombstone instead of shifting so slot pointers stay valid until the next insert
+class OrderIndex{
+	public:
+		struct alignas(64) Slot{ // One cache line per order
+			OrderId orderId;
+			OrderHandle handle;   // Set while the order rests in the book
+			OrderStatus status;
+		};
+
+		static constexpr OrderId emptyId {std::numeric_limits<OrderId>::max()};
+		static constexpr OrderId tombstoneId {std::numeric_limits<OrderId>::max() - 1};
+
+		[[nodiscard]] static constexpr bool isValidId(OrderId orderId) noexcept { return orderId < tombstoneId; }
+
+	private:
+		std::pmr::vector<Slot> slots_;
+		std::pmr::vector<Slot> spare_; // Previous table, reused when rehashing only to clear tombstones so the arena isn't hit again
+		size_t mask_;
+		size_t size_;
+		size_t tombstones_;
+
+		[[nodiscard]] static std::pmr::vector<Slot> makeSlots(size_t capacity, std::pmr::memory_resource* resource){
+			return std::pmr::vector<Slot>(capacity, Slot{emptyId, nullOrderHandle, {}}, resource);
+		}
+
+		void rehash(size_t capacity){
+			if(spare_.size() == capacity){
+				std::fill(spare_.begin(), spare_.end(), Slot{emptyId, nullOrderHandle, {}});
+			} else {
+				spare_ = makeSlots(capacity, slots_.get_allocator().resource());
+			}
+
+			std::pmr::vector<Slot>& old {spare_};
+			old.swap(slots_);
+			mask_ = capacity - 1;
+			tombstones_ = 0;
+
+			for(const Slot& slot : old){
+				if(isValidId(slot.orderId)){
+					size_t index {slot.orderId & mask_};
+					while(slots_[index].orderId != emptyId){
+						index = (index + 1) & mask_;
+					}
+					slots_[index] = slot;
+				}
+			}
+		}
+
+	public:
+		explicit OrderIndex(size_t expectedOrders, std::pmr::memory_resource* resource)
+			: slots_ { makeSlots(std::bit_ceil(std::max<size_t>(expectedOrders * 2, 16)), resource) }
+			, spare_ { resource }
+			, mask_ { slots_.size() - 1 }
+			, size_ {}
+			, tombstones_ {}
+			{}
+
+		// Pulls the home slot of an id towards the cache ahead of a lookup/insert
+		void prefetch(OrderId orderId) const noexcept {
+#if defined(__GNUC__)
+			__builtin_prefetch(&slots_[orderId & mask_], 1);
+#else
+			(void)orderId;
+#endif
+		}
+
+		[[nodiscard]] size_t size() const noexcept { return size_; }
+		[[nodiscard]] size_t capacity() const noexcept { return slots_.size(); }
+
+		[[nodiscard]] Slot* find(OrderId orderId) noexcept {
+			return const_cast<Slot*>(std::as_const(*this).find(orderId));
+		}
+
+		[[nodiscard]] const Slot* find(OrderId orderId) const noexcept {
+			for(size_t index {orderId & mask_}; ; index = (index + 1) & mask_){
+				const Slot& slot {slots_[index]};
+				if(slot.orderId == orderId){
+					return &slot;
+				}
+				if(slot.orderId == emptyId){
+					return nullptr;
+				}
+			}
+		}
+
+		// Slot for a new id or nullptr if the id is already known. Invalidates previously returned slot pointers
+		[[nodiscard]] Slot* insert(OrderId orderId, const OrderStatus& status){
+			// Keep at least a quarter of the table empty so probe chains stay short, tombstones count too
+			if((size_ + tombstones_ + 1) * 4 > slots_.size() * 3){
+				rehash(size_ * 2 >= slots_.size() ? slots_.size() * 2 : slots_.size());
+			}
+
+			Slot* reusable {nullptr};
+			for(size_t index {orderId & mask_}; ; index = (index + 1) & mask_){
+				Slot& slot {slots_[index]};
+				if(slot.orderId == orderId){
+					return nullptr;
+				}
+				if(slot.orderId == tombstoneId && reusable == nullptr){
+					reusable = &slot;
+				}
+				if(slot.orderId == emptyId){
+					if(reusable != nullptr){
+						--tombstones_;
+					} else {
+						reusable = &slot;
+					}
+					break;
+				}
+			}
+
+			*reusable = Slot{orderId, nullOrderHandle, status};
+			++size_;
+			return reusable;
+		}
+
+		void erase(Slot* slot) noexcept {
+			slot->orderId = tombstoneId;
+			slot->handle = nullOrderHandle;
+			--size_;
+			++tombstones_;
+		}
+};
+
+#endif
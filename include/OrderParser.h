@@ -0,0 +1,127 @@
+#ifndef ORDER_PARSER_H
+#define ORDER_PARSER_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Using.h"
+#include "Side.h"
+#include "OrderType.h"
+
+// Why a command was turned down, text or binary (BinaryProtocol.h)
+enum class ParseError : uint8_t
+{
+    None,
+    Empty,
+    UnknownVerb,        // Not BUY, SELL, CANCEL or MODIFY (after an optional symbol)
+    UnknownOrderType,   // Not LIMIT, MARKET, IOC, POST or FOK
+    MissingField,
+    BadPrice,           // Not an unsigned number that fits a Price
+    BadQuantity,        // Not an unsigned number that fits a Quantity, or 0
+    BadOrderId,
+    TrailingInput,      // More words after a complete command
+    SymbolTooLong,
+    BadLength,          // Binary message shorter or longer than its type
+    UnknownMessageType,
+    BadSide,            // Binary side other than 'B' or 'S'
+    BadSymbol,          // Anything but printable ASCII, or padding inside a binary symbol
+    TooLong             // Longer than a Command can carry (Command::fitsText / fitsBinary), answered by the network thread
+};
+
+[[nodiscard]] std::string_view toString(ParseError error) noexcept;
+
+enum class MessageKind : uint8_t
+{
+    NewOrder,
+    Cancel,
+    Modify
+};
+
+// Only the fields of the kind are filled in. symbol points into the parsed text, empty for the default book
+struct ParsedMessage
+{
+    MessageKind kind;
+    std::string_view symbol;
+    Side side;
+    OrderType type;
+    Price price;
+    Quantity quantity;
+    OrderId orderId;
+    uint64_t clientOrderId;     // Binary messages carry one, text ones leave it 0 for the Sequencer to number
+};
+
+inline constexpr size_t maxSymbolLength {16};
+
+// Printable ASCII other than space, no longer than maxSymbolLength. Empty is the default book
+// Whatever the protocol, a symbol has to be one the text protocol could send and the symbol file can hold
+[[nodiscard]] bool isValidSymbol(std::string_view symbol) noexcept;
+
+// One command without its newline:  [SYMBOL] BUY|SELL <LIMIT|MARKET|IOC|POST|FOK> <price> <qty>
+//                                    [SYMBOL] CANCEL <order id>
+//                                    [SYMBOL] MODIFY <order id> <price> <qty>
+// Words are split on spaces and tabs in place, numbers go through std::from_chars and words are looked up in fixed
+// tables, nothing is copied or allocated. Case sensitive like it always was
+[[nodiscard]] ParseError parseMessage(std::string_view message, ParsedMessage& parsed) noexcept;
+
+// First '\n' in [begin, end) or end when there is none
+[[nodiscard]] inline const char* findNewlineScalar(const char* begin, const char* end) noexcept {
+    for (; begin != end; ++begin) {
+        if (*begin == '\n') {
+            return begin;
+        }
+    }
+    return end;
+}
+
+#if defined(__SSE2__)
+// 16 bytes per compare, the scalar loop only does the tail
+[[nodiscard]] inline const char* findNewlineSse2(const char* begin, const char* end) noexcept {
+    const __m128i newline {_mm_set1_epi8('\n')};
+    while (end - begin >= 16) {
+        const __m128i chunk {_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin))};
+        const unsigned mask {static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)))};
+        if (mask != 0) {
+            return begin + std::countr_zero(mask);
+        }
+        begin += 16;
+    }
+    return findNewlineScalar(begin, end);
+}
+#endif
+
+// SSE2 wherever the compiler targets it (every x86-64 build), the scalar loop everywhere else
+[[nodiscard]] inline const char* findNewline(const char* begin, const char* end) noexcept {
+#if defined(__SSE2__)
+    return findNewlineSse2(begin, end);
+#else
+    return findNewlineScalar(begin, end);
+#endif
+}
+
+// Calls handler(line) for every complete newline terminated message in buffer, "\r\n" endings and empty lines are
+// taken care of. Returns how many bytes were used up, anything after that is the start of an unfinished message
+template <typename Handler>
+size_t forEachMessage(std::string_view buffer, Handler&& handler) {
+    const char* const begin {buffer.data()};
+    const char* const end {begin + buffer.size()};
+    const char* start {begin};
+    for (const char* newline {findNewline(start, end)}; newline != end; newline = findNewline(start, end)) {
+        std::string_view line {start, static_cast<size_t>(newline - start)};
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+            handler(line);
+        }
+        start = newline + 1;
+    }
+    return static_cast<size_t>(start - begin);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef ORDERPOLICY_H
+#define ORDERPOLICY_H
+
+#include "OrderType.h"
+
+// Compile time description of how an order type behaves so the match kernel can be specialized per type
+// priceLimited  - stop matching once the opposite side's price goes past the order's price
+// allOrNothing  - only match if the whole quantity can be filled (checked up front using the level aggregates)
+// rests         - whatever is left after matching goes into the book
+// postOnly      - never match, reject if the order would cross
+
+struct MarketPolicy{
+	static constexpr bool priceLimited {false};
+	static constexpr bool allOrNothing {true};
+	static constexpr bool rests {false};
+	static constexpr bool postOnly {false};
+};
+
+struct LimitPolicy{
+	static constexpr bool priceLimited {true};
+	static constexpr bool allOrNothing {false};
+	static constexpr bool rests {true};
+	static constexpr bool postOnly {false};
+};
+
+struct ImmediateOrCancelPolicy{
+	static constexpr bool priceLimited {true};
+	static constexpr bool allOrNothing {false};
+	static constexpr bool rests {false};
+	static constexpr bool postOnly {false};
+};
+
+struct PostOnlyPolicy{
+	static constexpr bool priceLimited {true};
+	static constexpr bool allOrNothing {false};
+	static constexpr bool rests {true};
+	static constexpr bool postOnly {true};
+};
+
+struct FillOrKillPolicy{
+	static constexpr bool priceLimited {true};
+	static constexpr bool allOrNothing {true};
+	static constexpr bool rests {false};
+	static constexpr bool postOnly {false};
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef ORDERQUEUE_H
+#define ORDERQUEUE_H
+
+#include <cstddef>
+
+#include "Using.h"
+#include "OrderStore.h"
+
+// Intrusive doubly linked FIFO of the orders resting at one price level, linked by handles into the OrderStore
+// Doesn't own the orders, whoever creates them (the OrderBook) releases them after unlinking
+// The level's total open quantity is kept up to date as orders are added, filled and removed
+// Forward links live in the hot records so walking a level never touches the cold table
+class OrderQueue{
+	private:
+		OrderHandle head_ {nullOrderHandle};
+		OrderHandle tail_ {nullOrderHandle};
+		size_t size_ {};
+		Quantity totalQuantity_ {};
+
+	public:
+		[[nodiscard]] bool empty() const noexcept { return head_ == nullOrderHandle; }
+		[[nodiscard]] size_t size() const noexcept { return size_; }
+		[[nodiscard]] OrderHandle front() const noexcept { return head_; }
+		[[nodiscard]] OrderHandle back() const noexcept { return tail_; }
+		[[nodiscard]] const Quantity& getTotalQuantity() const noexcept { return totalQuantity_; }
+
+		void pushBack(OrderStore& store, OrderHandle handle) noexcept {
+			HotOrder& hot {store.hot(handle)};
+			hot.next = nullOrderHandle;
+			store.cold(handle).prev = tail_;
+			if(tail_ != nullOrderHandle){
+				store.hot(tail_).next = handle;
+			} else {
+				head_ = handle;
+			}
+			tail_ = handle;
+			++size_;
+			totalQuantity_ += hot.remainingQuantity;
+		}
+
+		// An order in this queue got (partially) filled for quantity
+		void reduceQuantity(const Quantity& quantity) noexcept { totalQuantity_ -= quantity; }
+
+		// Drops the head without touching the cold table, the new head's prev is left stale (head_ is checked instead)
+		void popFront(const OrderStore& store) noexcept {
+			const HotOrder& hot {store.hot(head_)};
+			totalQuantity_ -= hot.remainingQuantity;
+			head_ = hot.next;
+			if(head_ == nullOrderHandle){
+				tail_ = nullOrderHandle;
+			}
+			--size_;
+		}
+
+		// O(1) unlink of any order in the queue
+		void erase(OrderStore& store, OrderHandle handle) noexcept {
+			const HotOrder& hot {store.hot(handle)};
+			const bool isHead {handle == head_};
+			const OrderHandle prev {isHead ? nullOrderHandle : store.cold(handle).prev};
+
+			if(isHead){
+				head_ = hot.next;
+			} else {
+				store.hot(prev).next = hot.next;
+			}
+
+			if(handle == tail_){
+				tail_ = prev;
+			} else {
+				store.cold(hot.next).prev = prev;
+			}
+
+			--size_;
+			totalQuantity_ -= hot.remainingQuantity;
+		}
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef ORDERRESULT_H
+#define ORDERRESULT_H
+
+#include "Using.h"
+#include "OrderState.h"
+
+// Outcome of one order out of a batch handed to OrderBook::processOrders
+struct OrderResult
+{
+	OrderId orderId {};
+	bool accepted {false};                  // Same as what processOrder would have returned
+	OrderState state {OrderState::Rejected}; // Where the order ended up (Processing means it's resting)
+	Quantity filledQuantity {};
+};
+
+#endif
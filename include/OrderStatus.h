@@ -0,0 +1,20 @@
+#ifndef ORDERSTATUS_H
+#define ORDERSTATUS_H
+
+#include "Using.h"
+#include "Side.h"
+#include "OrderType.h"
+#include "OrderState.h"
+
+// What the book knows about an order, kept while it's live and for a while after it finished
+struct OrderStatus
+{
+	Price price {};
+	OrderType type {};
+	Side side {};
+	OrderState state {OrderState::Processing};
+	Quantity remainingQuantity {};
+	Quantity filledQuantity {0};
+};
+
+#endif
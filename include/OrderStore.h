@@ -0,0 +1,99 @@
+#ifndef ORDERSTORE_H
+#define ORDERSTORE_H
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <memory_resource>
+
+#include "Side.h"
+#include "Using.h"
+#include "OrderType.h"
+
+// 32 bit index into the OrderStore, half the size of a pointer so more links fit per cache line
+using OrderHandle = uint32_t;
+inline constexpr OrderHandle nullOrderHandle {std::numeric_limits<OrderHandle>::max()};
+
+// What the match loop reads for every resting order it walks, 16 bytes so four of them share a cache line
+struct HotOrder{
+	OrderId orderId;
+	Quantity remainingQuantity;
+	OrderHandle next; // Next order at the same level (FIFO)
+};
+static_assert(sizeof(HotOrder) == 16, "HotOrder is meant to pack four per cache line");
+
+// Everything else about a resting order. Only touched on insert, cancel, modify and status reads
+// Side and price are implied by the level the order sits in but cancel/modify come in by id so they're kept here
+struct ColdOrder{
+	OrderHandle prev; // Only needed to unlink from the middle of a level, only valid while the order isn't the head
+	Price price;
+	Quantity initialQuantity; // Filled + remaining, a modify keeps the filled part
+	OrderType type;
+	Side side;
+	uint64_t sequence; // Book's logical clock when the order joined its level
+};
+
+// Resting orders as two parallel arrays (hot/cold) indexed by handle. Released handles go on a free list threaded
+// through HotOrder::next so the next order reuses the slot straight away. Handles stay valid when the arrays grow
+class OrderStore{
+	private:
+		std::pmr::vector<HotOrder> hot_;
+		std::pmr::vector<ColdOrder> cold_;
+		OrderHandle freeList_;
+		size_t liveCount_;
+
+	public:
+		explicit OrderStore(size_t expectedOrders, std::pmr::memory_resource* resource)
+			: hot_ { resource }
+			, cold_ { resource }
+			, freeList_ { nullOrderHandle }
+			, liveCount_ {}
+			{
+				// Sized up front, growing moves both arrays and the old ones stay behind in the arena
+				hot_.reserve(expectedOrders);
+				cold_.reserve(expectedOrders);
+			}
+
+		[[nodiscard]] OrderHandle create(const HotOrder& hot, const ColdOrder& cold){
+			OrderHandle handle {freeList_};
+			if(handle != nullOrderHandle){
+				freeList_ = hot_[handle].next;
+				hot_[handle] = hot;
+				cold_[handle] = cold;
+			} else {
+				if(hot_.size() == nullOrderHandle){
+					throw std::length_error("OrderStore ran out of handles");
+				}
+				handle = static_cast<OrderHandle>(hot_.size());
+				hot_.push_back(hot);
+				cold_.push_back(cold);
+			}
+			++liveCount_;
+			return handle;
+		}
+
+		void destroy(OrderHandle handle) noexcept {
+			hot_[handle].next = freeList_;
+			freeList_ = handle;
+			--liveCount_;
+		}
+
+		[[nodiscard]] HotOrder& hot(OrderHandle handle) noexcept { return hot_[handle]; }
+		[[nodiscard]] const HotOrder& hot(OrderHandle handle) const noexcept { return hot_[handle]; }
+		[[nodiscard]] ColdOrder& cold(OrderHandle handle) noexcept { return cold_[handle]; }
+		[[nodiscard]] const ColdOrder& cold(OrderHandle handle) const noexcept { return cold_[handle]; }
+
+		void prefetch(OrderHandle handle) const noexcept {
+#if defined(__GNUC__)
+			__builtin_prefetch(&hot_[handle], 1);
+#else
+			(void)handle;
+#endif
+		}
+
+		[[nodiscard]] size_t getLiveCount() const noexcept { return liveCount_; }
+		[[nodiscard]] size_t getCapacity() const noexcept { return hot_.capacity(); }
+};
+
+#endif
@@ -2,9 +2,12 @@
 #define ORDERTYPE_H
 
 enum class OrderType{
-	Market, 
-	Limit,
+	Market,            // Fill or kill against whatever is in the book
+	Limit,             // Match up to the price then rest the remainder
+	ImmediateOrCancel, // Match up to the price, the remainder expires
+	PostOnly,          // Only ever rests, rejected if it would take liquidity
+	FillOrKill,        // Fill completely up to the price or nothing happens
 	Unknown
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -2,63 +2,319 @@
 #define PIPELINE_H
 
 #include "Stage.h"
+#include "WaitStrategy.h"
 
 #include <map>
 #include <memory>
 #include <vector>
-#include <functional>
 #include <thread>
+#include <atomic>
+#include <format>
 #include <iostream>
 #include <boost/lockfree/spsc_queue.hpp>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 using boost::lockfree::spsc_queue;
 
+// How the threads of one stage wait and where they run
+struct StageConfig{
+    WaitStrategy waitStrategy {WaitStrategy::SpinYield};
+    uint32_t spinCount {1024};  // Empty polls before SpinYield starts yielding and SpinPark parks
+    size_t maxBatch {64};       // Messages popped from a lane at once, 1 handles them one by one
+    int core {-1};              // Core to pin the stage's thread to, -1 leaves it to the OS
+    int fifoPriority {0};       // SCHED_FIFO priority (1-99) when the process is allowed to, 0 keeps the normal scheduler
+};
+
+struct PipelineConfig{
+    size_t matchingShards {1};          // One Matching thread + queue per shard, orders are routed by symbol
+    std::vector<int> matchingCores {};  // Core to pin shard i's thread to, missing or -1 falls back to matching.core
+    size_t queueCapacity {1024};        // Per queue (lane)
+    size_t loggerQueueCapacity {16384}; // Per Logger lane, how much a slow disk can fall behind before matching waits on it
+    StageConfig sequencer {};
+    StageConfig matching {};            // Shared by every shard
+    StageConfig logger {};
+};
+
+// Every stage has one or more lanes (SPSC queues). Sequencer has one, Matching has one per shard and
+// Logger has one per shard too so each matching thread stays the only producer of its logger lane
+// Each Matching lane gets its own thread, the other stages have one thread draining all of their lanes
+// Queues hold Message by value. Workers hand every message to Derived::handleMessage(stage, lane, message)
+// so there's no type erasure or allocation per message (TradingSystem uses the fixed size Command)
+// A worker with nothing to do waits according to its StageConfig, submit wakes it up if it parked
+// Lanes are drained in batches of up to StageConfig::maxBatch into a worker local buffer so the queue indices are
+// synchronized once per batch. If Derived has handleBatchEnd(stage, lane) it's called after every batch
+template <typename Derived, typename Message>
 class Pipeline {
     private:
-        std::atomic_bool done_;
-        std::map<Stage, std::unique_ptr<spsc_queue<std::function<void()>>>> queuesMap_;
-        std::vector<std::thread> threads_;
+        using Queue = spsc_queue<Message>;
+
+        struct Worker{
+            Stage stage;
+            StageConfig config;
+            std::vector<Queue*> lanes;
+            std::vector<Message> batch; // Only touched by the worker's thread
+            size_t firstLane {};
+            std::atomic_bool done {false};
+            Parker parker;
+            std::thread thread;
 
-        void workerThread(const Stage& stage) 
+            [[nodiscard]] bool parks() const noexcept
+            {
+                return config.waitStrategy == WaitStrategy::SpinPark || config.waitStrategy == WaitStrategy::Blocking;
+            }
+        };
+
+        std::map<Stage, std::vector<std::unique_ptr<Queue>>> queuesMap_;
+        std::map<Stage, std::vector<Worker*>> laneWorkers_; // Who drains each lane, producers wake it if it's parked
+        std::vector<std::unique_ptr<Worker>> workers_; // In pipeline order, shut down front to back so nothing is left upstream
+        size_t queueCapacity_ {};
+        size_t loggerQueueCapacity_ {};
+
+        [[nodiscard]] Derived& derived() noexcept { return static_cast<Derived&>(*this); }
+
+        // Lane index is the position inside the stage (the shard for Matching and Logger)
+        void workerThread(Worker& worker)
         {
-            auto& queue = *(queuesMap_.at(stage));
-            while (!done_) {
-                std::function<void()> task;
-                if(queue.pop(task)){ //what happens if there's nothing to pop on the spsc?
-                    task();
+            uint32_t idlePolls {};
+            while (!worker.done.load(std::memory_order_acquire)) {
+                bool handledMessage {false};
+                for (size_t i {}; i < worker.lanes.size(); ++i) {
+                    if (drainBatch(worker, i) > 0) {
+                        handledMessage = true;
+                    }
                 }
-                else{
-                    std::this_thread::yield();
+                if (handledMessage) {
+                    idlePolls = 0;
+                } else {
+                    waitForMessages(worker, idlePolls);
+                }
+            }
+
+            // Process remaining messages after done is set
+            for (size_t i {}; i < worker.lanes.size(); ++i) {
+                while (drainBatch(worker, i) > 0) {}
+            }
+        }
+
+        // Pops up to maxBatch messages off one lane, handles them back to back then ends the batch
+        size_t drainBatch(Worker& worker, size_t i)
+        {
+            const size_t count {worker.lanes[i]->pop(worker.batch.data(), worker.batch.size())};
+            if (count == 0) {
+                return 0;
+            }
+
+            const size_t lane {worker.firstLane + i};
+            for (size_t m {}; m < count; ++m) {
+                derived().handleMessage(worker.stage, lane, worker.batch[m]);
+            }
+            if constexpr (requires(Derived& d, const Stage& s, size_t l) { d.handleBatchEnd(s, l); }) {
+                derived().handleBatchEnd(worker.stage, lane);
+            }
+            return count;
+        }
+
+        // Called once per empty poll of every lane
+        static void waitForMessages(Worker& worker, uint32_t& idlePolls)
+        {
+            const StageConfig& config {worker.config};
+            switch (config.waitStrategy) {
+                case WaitStrategy::BusySpin:
+                    cpuRelax();
+                    return;
+                case WaitStrategy::SpinYield:
+                    if (idlePolls < config.spinCount) {
+                        ++idlePolls;
+                        cpuRelax();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                    return;
+                case WaitStrategy::SpinPark:
+                    if (idlePolls < config.spinCount) {
+                        ++idlePolls;
+                        cpuRelax();
+                        return;
+                    }
+                    [[fallthrough]];
+                case WaitStrategy::Blocking:
+                    worker.parker.park(config.waitStrategy == WaitStrategy::Blocking, [&worker]{
+                        return worker.done.load(std::memory_order_acquire) || hasMessages(worker);
+                    });
+                    idlePolls = 0;
+                    return;
+            }
+        }
+
+        [[nodiscard]] static bool hasMessages(const Worker& worker)
+        {
+            for (const Queue* lane : worker.lanes) {
+                if (lane->read_available() > 0) {
+                    return true;
                 }
             }
+            return false;
+        }
+
+        void addLanes(const Stage& stage, size_t count, size_t capacity)
+        {
+            auto& lanes = queuesMap_[stage];
+            for (size_t i {}; i < count; ++i) {
+                lanes.push_back(std::make_unique<Queue>(capacity));
+            }
+        }
+
+        void startWorker(const Stage& stage, const StageConfig& config, std::vector<Queue*> lanes, size_t firstLane = 0)
+        {
+            auto& worker = *workers_.emplace_back(std::make_unique<Worker>());
+            worker.stage = stage;
+            worker.config = config;
+            worker.lanes = std::move(lanes);
+            worker.batch.resize(std::max<size_t>(config.maxBatch, 1));
+            worker.firstLane = firstLane;
+
+            auto& laneWorkers = laneWorkers_[stage];
+            laneWorkers.resize(std::max(laneWorkers.size(), firstLane + worker.lanes.size()));
+            for (size_t i {}; i < worker.lanes.size(); ++i) {
+                laneWorkers[firstLane + i] = &worker;
+            }
+
+            worker.thread = std::thread(&Pipeline::workerThread, this, std::ref(worker));
+            if (config.core >= 0) {
+                pinToCore(worker.thread, config.core);
+            }
+            if (config.fifoPriority > 0) {
+                setFifoPriority(worker.thread, config.fifoPriority);
+            }
+        }
+
+        static void pinToCore(std::thread& thread, int core)
+        {
+#if defined(__linux__)
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(core, &cpus);
+            if (int error = pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus); error != 0) {
+                std::cerr << std::format("Could not pin thread to core {} (error {}), leaving it unpinned\n", core, error);
+            }
+#else
+            (void)thread;
+            std::cerr << std::format("Thread pinning isn't supported on this platform, core {} ignored\n", core);
+#endif
+        }
+
+        // Needs CAP_SYS_NICE or an RLIMIT_RTPRIO, without it the thread keeps the normal scheduler
+        // Only worth it for a BusySpin stage on an isolated core, a realtime spinner can starve everything else on its core
+        static void setFifoPriority(std::thread& thread, int priority)
+        {
+#if defined(__linux__)
+            sched_param param{};
+            param.sched_priority = priority;
+            if (int error = pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param); error != 0) {
+                std::cerr << std::format("Could not set SCHED_FIFO priority {} (error {}), keeping the normal scheduler\n", priority, error);
+            }
+#else
+            (void)thread;
+            std::cerr << std::format("SCHED_FIFO isn't supported on this platform, priority {} ignored\n", priority);
+#endif
+        }
+
+        void wake(const Stage& stage, size_t lane)
+        {
+            Worker& worker = *laneWorkers_[stage][lane];
+            if (worker.parks()) {
+                worker.parker.unpark();
+            }
+        }
 
-            // Process remaining tasks after done_ is set
-            std::function<void()> task;
-            while (queue.pop(task)){
-                task();
+        static std::vector<Queue*> lanesOf(const std::vector<std::unique_ptr<Queue>>& queues)
+        {
+            std::vector<Queue*> lanes{};
+            for (const auto& queue : queues) {
+                lanes.push_back(queue.get());
             }
+            return lanes;
         }
 
     protected:
-        template <typename T>
-        void submit(const Stage &stage, T&& task) // turn task into a rval to avoid copy 
+        void submit(const Stage &stage, const Message& message)
+        {
+            submit(stage, 0, message);
+        }
+
+        // Lane is the shard for Matching and Logger. Each lane must only ever be fed from one thread
+        // Waits for room when the lane is full, only for producers that can afford to (see trySubmit)
+        void submit(const Stage &stage, size_t lane, const Message& message)
         {
-            // Gotta make sure it gets pushed in  
-            while(!queuesMap_[stage]->push(std::move(task))){
+            // Gotta make sure it gets pushed in
+            Queue& queue = *queuesMap_[stage][lane];
+            while(!queue.push(message)){
                 std::this_thread::yield();
             }
+            wake(stage, lane);
         }
 
-    public:
-        Pipeline() 
-        : done_{false} 
-        , threads_{
-            []{
-                std::vector<std::thread> temp{};
-                temp.reserve(4); 
-                return temp;
-            }()
+        // Same but gives up right away on a full lane, the caller decides what overload means
+        [[nodiscard]] bool trySubmit(const Stage &stage, size_t lane, const Message& message)
+        {
+            if (!queuesMap_[stage][lane]->push(message)) {
+                return false;
+            }
+            wake(stage, lane);
+            return true;
+        }
+
+        // Messages waiting in a lane, as far as its producer can tell (only call it from there)
+        [[nodiscard]] size_t getQueueDepth(const Stage &stage, size_t lane)
+        {
+            return getQueueCapacity(stage) - queuesMap_[stage][lane]->write_available();
+        }
+
+        // Nothing waiting in any lane of the stage, only telling from the thread that drains it
+        [[nodiscard]] bool isStageIdle(const Stage &stage) const
+        {
+            for (const auto& lane : queuesMap_.at(stage)) {
+                if (lane->read_available() > 0) {
+                    return false;
+                }
+            }
+            return true;
         }
+
+        [[nodiscard]] size_t getQueueCapacity() const noexcept { return queueCapacity_; }
+
+        [[nodiscard]] size_t getQueueCapacity(const Stage &stage) const noexcept
+        {
+            return stage == Stage::Logger ? loggerQueueCapacity_ : queueCapacity_;
+        }
+
+        [[nodiscard]] size_t getMatchingShards() const noexcept { return queuesMap_.at(Stage::Matching).size(); }
+
+        // Drains and joins every stage in pipeline order. Derived classes call this first in their destructor
+        // so the stage threads are gone before the state they use is
+        void stop()
+        {
+            for (auto& worker : workers_)
+            {
+                worker->done.store(true, std::memory_order_release);
+                worker->parker.wake();
+                if (worker->thread.joinable())
+                {
+                    worker->thread.join();
+                }
+            }
+        }
+
+    public:
+        Pipeline()
+        : Pipeline(PipelineConfig{})
+        {}
+
+        explicit Pipeline(const PipelineConfig& config)
         {
             try
                 {
@@ -74,30 +330,32 @@ class Pipeline {
                     std::abort();
                 }
 
+            const size_t shards {std::max<size_t>(config.matchingShards, 1)};
+            queueCapacity_ = config.queueCapacity;
+            loggerQueueCapacity_ = config.loggerQueueCapacity;
+
             // Init queues
-            queuesMap_[Stage::Sequencer] = std::make_unique<spsc_queue<std::function<void()>>>(1024);
-            queuesMap_[Stage::Matching] = std::make_unique<spsc_queue<std::function<void()>>>(1024);
-            queuesMap_[Stage::Logger] = std::make_unique<spsc_queue<std::function<void()>>>(1024);
+            addLanes(Stage::Sequencer, 1, config.queueCapacity);
+            addLanes(Stage::Matching, shards, config.queueCapacity);
+            addLanes(Stage::Logger, shards, config.loggerQueueCapacity);
 
-            // Thread for each stage
-            threads_.emplace_back(&Pipeline::workerThread, this, Stage::Sequencer);
-            threads_.emplace_back(&Pipeline::workerThread, this, Stage::Matching);
-            threads_.emplace_back(&Pipeline::workerThread, this, Stage::Logger);
+            // Thread for each stage, one per shard for matching
+            workers_.reserve(shards + 2);
+            startWorker(Stage::Sequencer, config.sequencer, lanesOf(queuesMap_[Stage::Sequencer]));
+            for (size_t shard {}; shard < shards; ++shard) {
+                StageConfig matching {config.matching};
+                if (shard < config.matchingCores.size() && config.matchingCores[shard] >= 0) {
+                    matching.core = config.matchingCores[shard];
+                }
+                startWorker(Stage::Matching, matching, {queuesMap_[Stage::Matching][shard].get()}, shard);
+            }
+            startWorker(Stage::Logger, config.logger, lanesOf(queuesMap_[Stage::Logger]));
         }
 
         ~Pipeline()
         {
-            done_ = true;
-            for (auto &thread : threads_)
-            {
-                if (thread.joinable())
-                {
-                    thread.join();
-                }
-            }
+            stop();
         }
 };
 
 #endif // PIPELINE_H
-
-
@@ -0,0 +1,236 @@
+#ifndef PRICELADDER_H
+#define PRICELADDER_H
+
+#include <bit>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <memory_resource>
+
+#include "Side.h"
+#include "Using.h"
+
+// One side of the book. Levels live in a contiguous array indexed by (price - basePrice) / tick instead of a tree,
+// an occupancy bitmap marks which levels hold orders and a cursor always points at the best level.
+// Bids treat the highest occupied index as best, asks the lowest.
+// When a price falls outside the window the ladder re-centers itself around the occupied range (growing if it has to)
+template <typename Level, Side LadderSide>
+class PriceLadder{
+	private:
+		static constexpr size_t wordBits {64};
+		static constexpr size_t npos {static_cast<size_t>(-1)};
+
+		Price tickSize_;
+		size_t maxLevels_;
+		Price basePrice_;
+		size_t bestIndex_;
+		size_t occupiedLevels_;
+		std::pmr::vector<Level> levels_;
+		std::pmr::vector<uint64_t> occupancy_;
+
+		[[nodiscard]] static constexpr bool isBid() noexcept { return LadderSide == Side::Buy; }
+
+		[[nodiscard]] uint64_t priceAt(size_t index) const noexcept { return basePrice_ + static_cast<uint64_t>(index) * tickSize_; }
+
+		[[nodiscard]] bool inWindow(Price price) const noexcept {
+			return price >= basePrice_ && (price - basePrice_) / tickSize_ < levels_.size();
+		}
+
+		[[nodiscard]] size_t indexOf(Price price) const noexcept { return (price - basePrice_) / tickSize_; }
+
+		[[nodiscard]] bool isOccupied(size_t index) const noexcept { return (occupancy_[index / wordBits] >> (index % wordBits)) & 1; }
+		void setOccupied(size_t index) noexcept { occupancy_[index / wordBits] |= (uint64_t{1} << (index % wordBits)); }
+		void clearOccupied(size_t index) noexcept { occupancy_[index / wordBits] &= ~(uint64_t{1} << (index % wordBits)); }
+
+		// First occupied index at or above `from` (npos if there is none)
+		[[nodiscard]] size_t scanUp(size_t from) const noexcept {
+			if(from >= levels_.size()){
+				return npos;
+			}
+			size_t word {from / wordBits};
+			uint64_t bits {occupancy_[word] & (~uint64_t{0} << (from % wordBits))};
+			while(bits == 0){
+				if(++word == occupancy_.size()){
+					return npos;
+				}
+				bits = occupancy_[word];
+			}
+			return word * wordBits + static_cast<size_t>(std::countr_zero(bits));
+		}
+
+		// First occupied index at or below `from` (npos if there is none)
+		[[nodiscard]] size_t scanDown(size_t from) const noexcept {
+			if(from == npos){
+				return npos;
+			}
+			size_t word {from / wordBits};
+			const size_t shift {wordBits - 1 - (from % wordBits)};
+			uint64_t bits {occupancy_[word] & (~uint64_t{0} >> shift)};
+			while(bits == 0){
+				if(word-- == 0){
+					return npos;
+				}
+				bits = occupancy_[word];
+			}
+			return word * wordBits + (wordBits - 1 - static_cast<size_t>(std::countl_zero(bits)));
+		}
+
+		// Walks away from the best price, i.e. down for bids and up for asks
+		[[nodiscard]] size_t nextWorse(size_t index) const noexcept {
+			if constexpr (isBid()){
+				return index == 0 ? npos : scanDown(index - 1);
+			} else {
+				return scanUp(index + 1);
+			}
+		}
+
+		[[nodiscard]] size_t lowestOccupied() const noexcept { return isBid() ? scanUp(0) : bestIndex_; }
+		[[nodiscard]] size_t highestOccupied() const noexcept { return isBid() ? bestIndex_ : scanDown(levels_.size() - 1); }
+
+		// Ticks needed to hold every resting level together with `price`
+		[[nodiscard]] uint64_t spanWith(Price price) const noexcept {
+			if(empty()){
+				return 1;
+			}
+			const uint64_t low {std::min<uint64_t>(price, priceAt(lowestOccupied()))};
+			const uint64_t high {std::max<uint64_t>(price, priceAt(highestOccupied()))};
+			return (high - low) / tickSize_ + 1;
+		}
+
+		// Rebuilds the window so that the occupied range plus `price` sits in the middle of it
+		void recenter(Price price){
+			uint64_t low {price};
+			uint64_t high {price};
+			if(!empty()){
+				low = std::min<uint64_t>(low, priceAt(lowestOccupied()));
+				high = std::max<uint64_t>(high, priceAt(highestOccupied()));
+			}
+
+			const uint64_t needed {(high - low) / tickSize_ + 1};
+			size_t count {levels_.size()};
+			while(count < needed){
+				count = std::min(count * 2, maxLevels_);
+			}
+
+			// Leave the same amount of room on both sides but never go below a price of 0
+			const uint64_t slack {(count - needed) / 2};
+			const Price newBase {static_cast<Price>(low - std::min<uint64_t>(slack, low / tickSize_) * tickSize_)};
+
+			const bool hadLevels {!empty()};
+			const Price bestPrice {hadLevels ? static_cast<Price>(priceAt(bestIndex_)) : Price{}};
+
+			std::pmr::vector<Level> levels(count, levels_.get_allocator());
+			std::pmr::vector<uint64_t> occupancy((count + wordBits - 1) / wordBits, 0, occupancy_.get_allocator());
+
+			for(size_t index {scanUp(0)}; index != npos; index = scanUp(index + 1)){
+				const size_t newIndex {static_cast<size_t>((priceAt(index) - newBase) / tickSize_)};
+				using std::swap;
+				swap(levels[newIndex], levels_[index]); // swap keeps iterators into the level valid
+				occupancy[newIndex / wordBits] |= (uint64_t{1} << (newIndex % wordBits));
+			}
+
+			basePrice_ = newBase;
+			levels_ = std::move(levels);
+			occupancy_ = std::move(occupancy);
+			bestIndex_ = hadLevels ? indexOf(bestPrice) : npos;
+		}
+
+	public:
+		explicit PriceLadder(Price tickSize, size_t levelCount, size_t maxLevels, std::pmr::memory_resource* resource)
+			: tickSize_ { std::max<Price>(tickSize, 1) }
+			, maxLevels_ { std::max(maxLevels, std::max<size_t>(levelCount, 1)) }
+			, basePrice_ {}
+			, bestIndex_ { npos }
+			, occupiedLevels_ {}
+			, levels_ ( std::max<size_t>(levelCount, 1), resource )
+			, occupancy_ ( (levels_.size() + wordBits - 1) / wordBits, 0, resource )
+			{}
+
+		[[nodiscard]] bool empty() const noexcept { return occupiedLevels_ == 0; }
+		[[nodiscard]] size_t getLevelCount() const noexcept { return occupiedLevels_; }
+		[[nodiscard]] size_t getWindowSize() const noexcept { return levels_.size(); }
+		[[nodiscard]] const Price& getTickSize() const noexcept { return tickSize_; }
+
+		// Only valid when the ladder isn't empty
+		[[nodiscard]] Price getBestPrice() const noexcept { return static_cast<Price>(priceAt(bestIndex_)); }
+		[[nodiscard]] Level& getBestLevel() noexcept { return levels_[bestIndex_]; }
+
+		// Whether a level at this price could be opened without breaking the tick grid or the max window
+		[[nodiscard]] bool canHold(Price price) const noexcept {
+			return price % tickSize_ == 0 && spanWith(price) <= maxLevels_;
+		}
+
+		// Pulls the level (and its occupancy word) at a price towards the cache if the window covers it
+		void prefetch(Price price) const noexcept {
+#if defined(__GNUC__)
+			if(inWindow(price)){
+				const size_t index {indexOf(price)};
+				__builtin_prefetch(&levels_[index], 1);
+				__builtin_prefetch(&occupancy_[index / wordBits], 1);
+			}
+#else
+			(void)price;
+#endif
+		}
+
+		// Level at the price or nullptr if the price isn't covered by the window
+		[[nodiscard]] Level* findLevel(Price price) noexcept {
+			return inWindow(price) ? &levels_[indexOf(price)] : nullptr;
+		}
+
+		// Level the caller is about to put an order in. Moves the window if needed and marks the level occupied
+		// Callers check canHold() first
+		[[nodiscard]] Level& openLevel(Price price){
+			if(!inWindow(price)){
+				recenter(price);
+			}
+
+			const size_t index {indexOf(price)};
+			if(!isOccupied(index)){
+				setOccupied(index);
+				++occupiedLevels_;
+				if(bestIndex_ == npos || (isBid() ? index > bestIndex_ : index < bestIndex_)){
+					bestIndex_ = index;
+				}
+			}
+			return levels_[index];
+		}
+
+		// Called once the level at the price has no orders left
+		void releaseLevel(Price price) noexcept {
+			const size_t index {indexOf(price)};
+			if(!isOccupied(index)){
+				return;
+			}
+
+			clearOccupied(index);
+			--occupiedLevels_;
+			if(index == bestIndex_){
+				bestIndex_ = nextWorse(index);
+			}
+		}
+
+		void releaseBestLevel() noexcept { releaseLevel(getBestPrice()); }
+
+		// Visits up to depth occupied levels from best to worst as visitor(price, level)
+		template <typename Visitor>
+		void forEachLevel(size_t depth, Visitor&& visitor) const {
+			size_t index {empty() ? npos : bestIndex_};
+			for(size_t count {}; index != npos && count < depth; ++count, index = nextWorse(index)){
+				visitor(static_cast<Price>(priceAt(index)), levels_[index]);
+			}
+		}
+
+		// Same walk without a depth cap, stops as soon as visitor(price, level) returns false
+		template <typename Visitor>
+		void forEachLevelWhile(Visitor&& visitor) const {
+			for(size_t index {empty() ? npos : bestIndex_}; index != npos; index = nextWorse(index)){
+				if(!visitor(static_cast<Price>(priceAt(index)), levels_[index])){
+					return;
+				}
+			}
+		}
+};
+
+#endif
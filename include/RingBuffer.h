@@ -0,0 +1,54 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <cstddef>
+#include <vector>
+#include <memory_resource>
+
+// Fixed capacity window over the most recent items. Storage is reserved once and the oldest item
+// is overwritten once full, so memory never grows with the number of pushes
+// Indexing is oldest first: [0] is the oldest item still in the window
+template <typename T>
+class RingBuffer{
+	private:
+		std::pmr::vector<T> items_;
+		size_t capacity_;
+		size_t head_; // Oldest item once the window is full
+
+	public:
+		explicit RingBuffer(size_t capacity, std::pmr::memory_resource* resource)
+			: items_ { resource }
+			, capacity_ { capacity }
+			, head_ {}
+			{
+				items_.reserve(capacity_);
+			}
+
+		void push(const T& item){
+			if(capacity_ == 0){
+				return;
+			}
+
+			if(items_.size() < capacity_){
+				items_.push_back(item);
+				return;
+			}
+
+			items_[head_] = item;
+			head_ = (head_ + 1) % capacity_;
+		}
+
+		void clear() noexcept {
+			items_.clear();
+			head_ = 0;
+		}
+
+		[[nodiscard]] bool empty() const noexcept { return items_.empty(); }
+		[[nodiscard]] size_t size() const noexcept { return items_.size(); }
+		[[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+
+		[[nodiscard]] const T& operator[](size_t index) const noexcept { return items_[(head_ + index) % items_.size()]; }
+		[[nodiscard]] const T& back() const noexcept { return (*this)[items_.size() - 1]; }
+};
+
+#endif
@@ -7,4 +7,9 @@ enum class Side{
 	Unknown
 };
 
+// Side an order of this side trades against
+constexpr Side opposite(Side side) noexcept {
+	return side == Side::Buy ? Side::Sell : Side::Buy;
+}
+
 #endif
\ No newline at end of file
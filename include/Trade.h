@@ -1,3 +1,6 @@
+#ifndef TRADE_H
+#define TRADE_H
+
 #include "Using.h"
 #include <format>
 class Trade{
@@ -27,4 +30,6 @@ class Trade{
 		[[nodiscard]] const Price& getPrice() const noexcept { return price_; }
 
 
-};
\ No newline at end of file
+};
+
+#endif
@@ -3,33 +3,331 @@
 
 #include "Pipeline.h"
 #include "OrderBook.h"
+#include "OrderResult.h"
+#include "BookManager.h"
+#include "Command.h"
+#include "Journal.h"
+#include "JournalReplay.h"
+#include "MarketDataPublisher.h"
+#include "OrderEntryServer.h"
+#include "OrderParser.h"
+#include "BinaryProtocol.h"
+#include "ExecutionReport.h"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <sstream>
+#include <string>
+#include <unordered_map>
+#include <optional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <fstream>
 #include <boost/asio.hpp>
 
 using boost::asio::ip::tcp;
 
-class TradingSystem : private Pipeline
+// What the Sequencer turns down busy while a matching lane is over its high water mark
+enum class ShedPolicy : uint8_t
+{
+    NewOrders,      // Cancels and modifies still go through, they only ever take work off the book
+    AllCommands,
+    None            // Nothing is shed, the Sequencer waits for room in the lane
+};
+
+// Overload handling between the sessions and the books. Every client command takes one of its session's credits
+// until its answer goes out, so a session can't have more than creditWindow commands anywhere in the pipeline. Past
+// that it isn't read anymore. Over the high water mark of a matching lane the Sequencer answers busy right away
+// instead of adding to the backlog, until the lane is back down to the low water mark
+struct AdmissionConfig{
+    ShedPolicy policy {ShedPolicy::NewOrders};
+    double highWater {0.75};    // Of the pipeline's queue capacity
+    double lowWater {0.5};
+};
+
+// Counted wherever they happen, read together through TradingSystem::getAdmissionStats
+struct AdmissionStats{
+    uint64_t busyAtEntry {};        // The Sequencer lane was full, turned down by the network thread
+    uint64_t busyAtSequencer {};    // Shed by the Sequencer under its policy
+    uint64_t reportsDeferred {};    // Answers that found their report lane full and went out later
+    uint64_t reportsDropped {};     // Fills and expiries that found their report lane full
+    uint64_t loggerStalls {};       // Journal records, trades and level updates that found their Logger lane full
+    uint64_t journalFailures {};    // Journal commits that failed, new commands are turned down until one works again
+};
+
+struct TradingSystemConfig{
+    OrderEntryConfig orderEntry {.creditWindow = 256}; // Port, session limits and credits of the text order entry server
+    OrderEntryConfig binaryEntry {.port = 1031, .protocol = OrderEntryProtocol::Binary, .creditWindow = 256}; // Same for the binary one
+    AdmissionConfig admission {};
+    BookManagerConfig books {};     // Same for every shard, a symbol's book only exists on the shard it routes to
+    PipelineConfig pipeline {.logger = {.waitStrategy = WaitStrategy::Blocking}}; // Shards, wait strategies and pinning, trade logging isn't latency critical so it sleeps
+    JournalConfig journal {};       // Empty path keeps the old behaviour of printing trades instead of journaling
+    MarketDataConfig marketData {}; // L2 level updates over a unix socket, empty path publishes nothing
+    bool recover {true};            // Rebuild the books from the journal (unless it's truncated) before taking orders
+    size_t reportQueueCapacity {1 << 14}; // Per matching shard and for the Sequencer, reports the network thread hasn't sent yet
+};
+
+// Journal records can't be dropped, so a Logger lane that fills up (a slow disk under JournalFsync::EveryCommit)
+// makes its matching thread wait. Its own lane then backs up and the Sequencer sheds like for any slow shard, the
+// network thread never waits. pipeline.loggerQueueCapacity is the slack before that happens, loggerStalls counts it
+
+class TradingSystem : private Pipeline<TradingSystem, Command>
 {
     private:
-        OrderBook orderBook_; 
+        friend class Pipeline<TradingSystem, Command>; // Workers call handleMessage
+
+        std::vector<std::unique_ptr<BookManager>> shards_; // Shard i's books are only touched by matching thread i
+        // Per shard, what the current matching batch changed
+        struct ShardBatch{
+            std::vector<SymbolId> updatedSymbols;
+            std::vector<LevelUpdate> levels; // Scratch for conflating one book's level updates
+            // Back to back new orders for one book, matched with a single processOrders call when something else
+            // comes along or the batch ends
+            std::vector<Command> newOrders;
+            std::vector<Order> orders;
+            std::vector<OrderResult> results;
+        };
+        std::vector<ShardBatch> batches_;
+
+        // Per shard, who to tell about the resting orders that came from a session. Nodes come out of a pool so
+        // steady state trading doesn't hit malloc
+        struct OrderOwner{
+            uint8_t server;
+            SessionId session;
+            uint64_t clientOrderId;
+            Quantity leaves;
+        };
+        struct ShardOrders{
+            std::pmr::unsynchronized_pool_resource pool;
+            std::pmr::unordered_map<OrderId, OrderOwner> owners {&pool};
+            // Both sides' fills of the current match, held back until the ack of the order that traded is out. A maker
+            // can be an order earlier in the same processOrders call whose own ack hasn't gone out yet either
+            struct PendingFill{
+                OrderId taker;
+                ExecutionReport report;
+            };
+            std::vector<PendingFill> fills;
+        };
+        std::vector<std::unique_ptr<ShardOrders>> shardOrders_;
+
+        // One lane per matching shard plus the Sequencer's (last), each with a single producer. The network thread
+        // drains them all whenever one of them posts, so reports go out once per producer batch. Order only holds within
+        // a lane, a Sequencer reject can overtake the reports of commands sent before it
+        struct ReportLane{
+            explicit ReportLane(size_t capacity)
+            : queue{capacity}
+            {}
+
+            spsc_queue<ExecutionReport> queue;
+            bool pushed {false}; // Producer only, something went in during the current batch
+        };
+        std::vector<std::unique_ptr<ReportLane>> reportLanes_;
+        std::atomic_bool reportsPending_;       // A drain is posted and hasn't started yet
+        std::atomic<uint64_t> reportsDropped_;  // Lane was full, matching never waits on the network
+        // Answers can't be dropped, a session would never get its credit back. The few that find their lane full wait
+        // here, the lock is only ever taken when that happens
+        std::mutex deferredMutex_;
+        std::vector<ExecutionReport> deferredReports_;
+        std::atomic_bool reportsDeferred_;
+        std::atomic<uint64_t> deferredCount_;
+
+        // Sequencer only, whether each matching lane is being shed. Set at the high water mark, cleared at the low one
+        AdmissionConfig admission_;
+        size_t highWater_;
+        size_t lowWater_;
+        std::vector<uint8_t> shedding_;
+        std::atomic<uint64_t> busyAtEntry_;
+        std::atomic<uint64_t> busyAtSequencer_;
+        std::atomic<uint64_t> loggerStalls_;
+        // Set by the Logger when a journal commit fails, cleared by the next one that works. The Sequencer turns
+        // everything down meanwhile instead of acknowledging what might never be written
+        std::atomic_bool journalFailing_;
+        std::atomic<uint64_t> journalFailures_;
+        std::atomic_bool stopping_;     // A record the journal can't take is given up on instead of retried
+
+        // Logger thread only, matching threads just check whether they're there
+        std::unique_ptr<Journal> journal_;
+        std::unique_ptr<MarketDataPublisher> publisher_;
         OrderId nextOrderId_;
 
+        // Network thread only (whoever calls startServer), sessions of both servers feed the Sequencer lane from it so
+        // there is exactly one producer
+        OrderEntryConfig orderEntryConfig_;
+        OrderEntryConfig binaryEntryConfig_;
+        boost::asio::io_context ioContext_;
+        static constexpr uint8_t textServer {0};    // Command::server values
+        static constexpr uint8_t binaryServer {1};
+        std::unique_ptr<OrderEntryServer> orderEntry_;
+        std::unique_ptr<OrderEntryServer> binaryEntry_;
+        std::atomic<uint16_t> listeningPort_;
+        std::atomic<uint16_t> binaryListeningPort_;
+
+        // Sequencer only. Symbol names get ids in the order they first show up, 0 is kept for messages without a symbol
+        // Found by string_view straight from the message, only a new symbol allocates
+        struct SymbolHash{
+            using is_transparent = void;
+            size_t operator()(std::string_view symbol) const noexcept { return std::hash<std::string_view>{}(symbol); }
+        };
+        std::unordered_map<std::string, SymbolId, SymbolHash, std::equal_to<>> symbolIds_;
+        SymbolId nextSymbolId_;
+        std::ofstream symbolLog_; // "<id> <name>" per line next to the journal, the journal itself only has ids
+
+        // Replays the journal into the books before any thread sees them, then picks up ids where they left off
+        void recover(const TradingSystemConfig& config);
+        void loadSymbols(const std::string& path);
+
+        [[nodiscard]] std::optional<SymbolId> lookupSymbol(std::string_view symbol);
+
+        // Every order for a symbol goes to the same shard so per symbol ordering holds
+        // Symbol ids are handed out sequentially, the multiply spreads them out before the modulo
+        [[nodiscard]] size_t shardFor(SymbolId symbol) const noexcept {
+            return static_cast<size_t>((static_cast<uint64_t>(symbol) * 0x9E3779B97F4A7C15ull) >> 32) % shards_.size();
+        }
+
         // Functions pass info moving from top to bottom 
-        void handleSequencing(std::string_view message);
-        void handleMatching(Order order);
+        void handleMessage(const Stage& stage, size_t lane, const Command& command);
+        void handleOrderEntry(SessionId session, uint32_t sequence, std::string_view message);
+        void handleBinaryEntry(SessionId session, std::string_view message);
+        void admit(const Command& command);
+        void rejectAtEntry(const Command& command, RejectReason reason, ParseError parseError = ParseError::None);
+        void handleText(const Command& command);
+        void handleBinary(const Command& command);
+        void handleSequencing(const Command& command, const ParsedMessage& parsed);
+        [[nodiscard]] bool shed(size_t shard, MessageKind kind);
+        void handleMatching(size_t shard, const Command& command);
+        void matchNewOrders(size_t shard);
+        void handleCancel(size_t shard, const Command& command);
+        void handleModify(size_t shard, const Command& command);
+        void handleLogging(const Command& command);
+        void journal(size_t shard, const Command& command);
+        void toLogger(size_t shard, const Command& command);
+        void appendToJournal(const JournalRecord& record);
+        void journalFailed(const std::exception& error);
+        void handleBatchEnd(const Stage& stage, size_t lane);
+        void markUpdated(size_t shard, SymbolId symbol);
+        void publishLevels(size_t shard, SymbolId symbol, OrderBook& orderBook);
+
+        // Reports, lane is the shard or reportLanes_.size() - 1 for the Sequencer
+        void report(size_t lane, const ExecutionReport& report);
+        void reject(const Command& command, const ParsedMessage& parsed, RejectReason reason, ParseError parseError = ParseError::None);
+        void reportNewOrder(size_t shard, const Command& command, const OrderResult& result, size_t& fill);
+        void reportFills(size_t shard, const Trade& trade);
+        void sendFills(size_t shard);
+        void notifyReports(size_t lane);
+        void drainReports();
+        void sendReport(const ExecutionReport& report);
+
+        // Books only record level updates when somebody is going to publish them
+        [[nodiscard]] static BookManagerConfig booksConfig(const TradingSystemConfig& config) {
+            BookManagerConfig books {config.books};
+            books.defaultBook.levelUpdates = !config.marketData.socketPath.empty();
+            return books;
+        }
 
     public:
         TradingSystem()
-        : orderBook_{}
-        , nextOrderId_{1}
+        : TradingSystem(TradingSystemConfig{})
         {}
+
+        // Book sizing per symbol goes through config.books (defaultBook), sharding and pinning through config.pipeline
+        explicit TradingSystem(const TradingSystemConfig& config)
+        : Pipeline{config.pipeline}
+        , shards_{}
+        , batches_(getMatchingShards())
+        , shardOrders_{}
+        , reportLanes_{}
+        , reportsPending_{false}
+        , reportsDropped_{0}
+        , deferredMutex_{}
+        , deferredReports_{}
+        , reportsDeferred_{false}
+        , deferredCount_{0}
+        , admission_{config.admission}
+        , highWater_{static_cast<size_t>(config.admission.highWater * static_cast<double>(config.pipeline.queueCapacity))}
+        , lowWater_{static_cast<size_t>(config.admission.lowWater * static_cast<double>(config.pipeline.queueCapacity))}
+        , shedding_(std::max<size_t>(config.pipeline.matchingShards, 1), 0)
+        , busyAtEntry_{0}
+        , busyAtSequencer_{0}
+        , loggerStalls_{0}
+        , journalFailing_{false}
+        , journalFailures_{0}
+        , stopping_{false}
+        , journal_{config.journal.path.empty() ? nullptr : std::make_unique<Journal>(config.journal)}
+        , publisher_{config.marketData.socketPath.empty() ? nullptr : std::make_unique<MarketDataPublisher>(config.marketData)}
+        , nextOrderId_{1}
+        , orderEntryConfig_{config.orderEntry}
+        , binaryEntryConfig_{config.binaryEntry}
+        , ioContext_{1}
+        , orderEntry_{}
+        , binaryEntry_{}
+        , listeningPort_{0}
+        , binaryListeningPort_{0}
+        , symbolIds_{}
+        , nextSymbolId_{1}
+        , symbolLog_{}
+        {
+            for (size_t shard {}; shard < getMatchingShards(); ++shard) {
+                shards_.emplace_back(std::make_unique<BookManager>(booksConfig(config)));
+                shardOrders_.emplace_back(std::make_unique<ShardOrders>());
+                // A run of new orders is never longer than one stage batch
+                batches_[shard].newOrders.reserve(config.pipeline.matching.maxBatch);
+                batches_[shard].orders.reserve(config.pipeline.matching.maxBatch);
+                batches_[shard].results.reserve(config.pipeline.matching.maxBatch);
+            }
+            for (size_t lane {}; lane <= getMatchingShards(); ++lane) {
+                reportLanes_.emplace_back(std::make_unique<ReportLane>(config.reportQueueCapacity));
+            }
+
+            if (journal_ != nullptr) {
+                recover(config);
+            }
+
+            for (size_t shard {}; shard < getMatchingShards(); ++shard) {
+                // Trades leave the matching thread one by one, the Logger stage deals with them through this shard's lane
+                shards_[shard]->setTradeSink([this, shard](SymbolId symbol, const Trade& trade){
+                    toLogger(shard, Command::makeTradeReport(symbol, trade));
+                    reportFills(shard, trade);
+                });
+            }
+        }
         
+        // A thread still in startServer has to be joined first, stopServer just tells it to come back
         ~TradingSystem(){
-            // TODO add iocontext as member and destroy it ioContext_.stop()
+            stopServer();
+            stopping_.store(true, std::memory_order_release);
+            Pipeline::stop(); // Matching threads use shards_, they have to be done before it goes away
         };
 
+        // Listens on config.orderEntry.port (text) and config.binaryEntry.port (binary) and serves every session of both
+        // from the calling thread until stopServer. Clients keep their connection open and send newline terminated
+        // commands or BinaryProtocol.h messages. Throws if a port can't be bound
         void startServer();
+
+        // Safe from any thread, startServer closes every session and returns
+        void stopServer();
+
+        // The port startServer is listening on once it's up (useful with port 0), 0 before that
+        [[nodiscard]] uint16_t getListeningPort() const noexcept { return listeningPort_.load(std::memory_order_acquire); }
+        [[nodiscard]] uint16_t getBinaryListeningPort() const noexcept { return binaryListeningPort_.load(std::memory_order_acquire); }
+
+        // Execution reports thrown away because the network thread fell that far behind
+        [[nodiscard]] uint64_t getReportsDropped() const noexcept { return reportsDropped_.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] AdmissionStats getAdmissionStats() const noexcept {
+            return AdmissionStats{
+                .busyAtEntry = busyAtEntry_.load(std::memory_order_relaxed),
+                .busyAtSequencer = busyAtSequencer_.load(std::memory_order_relaxed),
+                .reportsDeferred = deferredCount_.load(std::memory_order_relaxed),
+                .reportsDropped = reportsDropped_.load(std::memory_order_relaxed),
+                .loggerStalls = loggerStalls_.load(std::memory_order_relaxed),
+                .journalFailures = journalFailures_.load(std::memory_order_relaxed),
+            };
+        }
         
         // No copying
         TradingSystem &operator=(const TradingSystem &other) = delete;
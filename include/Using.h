@@ -7,5 +7,7 @@ using Price = uint32_t;
 using OrderId = uint64_t;
 using Quantity = uint32_t;
 using TradeId = uint32_t;
+using SymbolId = uint32_t;
+using SessionId = uint32_t; // Order entry connection, handed out from 1 per server, 0 is nobody
 
 #endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef WAIT_STRATEGY_H
+#define WAIT_STRATEGY_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// What a pipeline worker does when all of its lanes are empty
+// Ordered from lowest wake up latency / highest idle cost to the other way around
+enum class WaitStrategy
+{
+    BusySpin,   // Never gives up the core, pause between polls. Wants an isolated core
+    SpinYield,  // Spins for a while then yields to the scheduler on every poll
+    SpinPark,   // Spins for a while then sleeps on a futex (atomic wait) until a producer wakes it
+    Blocking    // Sleeps on a condition variable as soon as the lanes are empty
+};
+
+// Tells the core we're spinning so it backs off the pipeline and leaves resources to the sibling hyperthread
+inline void cpuRelax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Lets one consumer sleep until a producer has pushed something. Producers only pay for a fence and a load
+// unless the consumer is actually parked
+// Consumer: park(ready) where ready re-checks the lanes, Producer: push then unpark()
+class Parker
+{
+    private:
+        std::atomic<uint32_t> epoch_ {};
+        std::atomic_bool parked_ {false};
+        std::mutex mutex_;
+        std::condition_variable condition_;
+
+    public:
+        // useCondition picks the condition variable over the futex (Blocking vs SpinPark)
+        template <typename Ready>
+        void park(bool useCondition, Ready&& ready)
+        {
+            const uint32_t epoch {epoch_.load(std::memory_order_acquire)};
+            parked_.store(true, std::memory_order_relaxed);
+            // Pairs with the fence in unpark, either we see the push or the producer sees us parked
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!ready()) {
+                if (useCondition) {
+                    std::unique_lock lock{mutex_};
+                    condition_.wait(lock, [this, epoch]{ return epoch_.load(std::memory_order_acquire) != epoch; });
+                } else {
+                    epoch_.wait(epoch, std::memory_order_acquire);
+                }
+            }
+            parked_.store(false, std::memory_order_relaxed);
+        }
+
+        void unpark()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (parked_.load(std::memory_order_relaxed)) {
+                wake();
+            }
+        }
+
+        // Unconditional, used on shutdown
+        void wake()
+        {
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_one();
+            {
+                // Consumer is either before its predicate check or inside wait, never in between
+                std::lock_guard lock{mutex_};
+            }
+            condition_.notify_one();
+        }
+};
+
+#endif // WAIT_STRATEGY_H
@@ -0,0 +1,118 @@
+#include "Arena.h"
+
+#include <cerrno>
+#include <format>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef _WIN32
+#include <new>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	constexpr size_t hugePageSize {2 * 1024 * 1024};
+
+	size_t roundUp(size_t value, size_t multiple){
+		return (value + multiple - 1) / multiple * multiple;
+	}
+
+	struct FaultCount{
+		long minor {};
+		long major {};
+	};
+
+	FaultCount currentFaults(){
+#ifdef _WIN32
+		return {};
+#else
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+		return {usage.ru_minflt, usage.ru_majflt};
+#endif
+	}
+
+}
+
+Arena::Arena(size_t size, ArenaPaging paging, ArenaWarmup warmup)
+	: memory_ { nullptr }
+	, size_ { size }
+	, stats_ {}
+{
+	const auto start {std::chrono::steady_clock::now()};
+	const FaultCount faultsBefore {currentFaults()};
+
+	if(size_ == 0){
+		throw std::invalid_argument("Arena size must be greater than 0");
+	}
+
+#ifdef _WIN32
+	// Default initialized so nothing gets zeroed, no huge page or locking support here
+	(void)paging;
+	memory_ = new std::byte[size_];
+#else
+	const size_t pageSize {static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+	void* mapping {MAP_FAILED};
+
+	if(paging == ArenaPaging::HugePages){
+		size_ = roundUp(size_, hugePageSize);
+		// No MAP_NORESERVE here, the mapping should fail up front instead of SIGBUS on first touch when the huge page pool is short
+		mapping = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		stats_.hugePages = (mapping != MAP_FAILED);
+	}
+
+	if(mapping == MAP_FAILED){
+		size_ = roundUp(size_, paging == ArenaPaging::Default ? pageSize : hugePageSize);
+		mapping = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if(mapping == MAP_FAILED){
+			throw std::system_error(errno, std::generic_category(), std::format("Arena could not map {} bytes", size_));
+		}
+
+#ifdef MADV_HUGEPAGE
+		if(paging != ArenaPaging::Default){
+			madvise(mapping, size_, MADV_HUGEPAGE); // Only a hint, fine if THP is disabled
+		}
+#endif
+	}
+
+	memory_ = static_cast<std::byte*>(mapping);
+
+	if(warmup == ArenaWarmup::PrefaultAndLock){
+		// mlock faults everything in as well, if the memlock limit says no just prefault
+		stats_.locked = (mlock(memory_, size_) == 0);
+	}
+#endif
+
+	if(warmup != ArenaWarmup::None && !stats_.locked){
+		prefault();
+	}
+
+	const FaultCount faultsAfter {currentFaults()};
+	stats_.minorFaults = faultsAfter.minor - faultsBefore.minor;
+	stats_.majorFaults = faultsAfter.major - faultsBefore.major;
+	stats_.setupTime = std::chrono::steady_clock::now() - start;
+}
+
+Arena::~Arena(){
+#ifdef _WIN32
+	delete[] memory_;
+#else
+	if(stats_.locked){
+		munlock(memory_, size_);
+	}
+	munmap(memory_, size_);
+#endif
+}
+
+void Arena::prefault() noexcept {
+	// A write per page is enough to get it backed, the smallest page size covers the huge page case too
+	constexpr size_t stride {4096};
+	volatile std::byte* bytes {memory_};
+	for(size_t offset {}; offset < size_; offset += stride){
+		bytes[offset] = std::byte{0};
+	}
+}
@@ -0,0 +1,187 @@
+#include "BinaryProtocol.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+[[nodiscard]] bool decodeSide(uint8_t code, Side& side) noexcept {
+    switch (code) {
+        case 'B': side = Side::Buy; return true;
+        case 'S': side = Side::Sell; return true;
+        default: return false;
+    }
+}
+
+[[nodiscard]] bool decodeOrderType(uint8_t code, OrderType& type) noexcept {
+    switch (code) {
+        case 'L': type = OrderType::Limit; return true;
+        case 'M': type = OrderType::Market; return true;
+        case 'I': type = OrderType::ImmediateOrCancel; return true;
+        case 'P': type = OrderType::PostOnly; return true;
+        case 'F': type = OrderType::FillOrKill; return true;
+        default: return false;
+    }
+}
+
+[[nodiscard]] constexpr BinaryReportType reportTypeCode(ReportType type) noexcept {
+    switch (type) {
+        case ReportType::Accepted:  return BinaryReportType::Accepted;
+        case ReportType::Rejected:  return BinaryReportType::Rejected;
+        case ReportType::Expired:   return BinaryReportType::Expired;
+        case ReportType::Fill:      return BinaryReportType::Fill;
+        case ReportType::Cancelled: return BinaryReportType::Cancelled;
+        case ReportType::Modified:  return BinaryReportType::Modified;
+    }
+    return BinaryReportType::Rejected;
+}
+
+[[nodiscard]] constexpr uint8_t sideCode(Side side) noexcept {
+    return side == Side::Buy ? 'B' : 'S';
+}
+
+[[nodiscard]] constexpr uint8_t orderTypeCode(OrderType type) noexcept {
+    switch (type) {
+        case OrderType::Market:            return 'M';
+        case OrderType::ImmediateOrCancel: return 'I';
+        case OrderType::PostOnly:          return 'P';
+        case OrderType::FillOrKill:        return 'F';
+        default:                           return 'L';
+    }
+}
+
+// The symbol field of the message at offset, trailing padding dropped. Padding anywhere else or bytes the text
+// protocol couldn't carry make it a bad symbol
+[[nodiscard]] bool symbolAt(std::string_view message, size_t offset, std::string_view& symbol) noexcept {
+    symbol = message.substr(offset, maxSymbolLength);
+    while (!symbol.empty() && (symbol.back() == ' ' || symbol.back() == '\0')) {
+        symbol.remove_suffix(1);
+    }
+    return isValidSymbol(symbol);
+}
+
+template <typename Message>
+[[nodiscard]] Message makeMessage(BinaryMessageType type, uint64_t clientOrderId, std::string_view symbol) noexcept {
+    Message message{};
+    message.header = BinaryHeader{sizeof(Message), type, 0};
+    message.clientOrderId = clientOrderId;
+    std::memcpy(message.symbol, symbol.data(), std::min(symbol.size(), maxSymbolLength));
+    return message;
+}
+
+}
+
+uint64_t peekClientOrderId(std::string_view message) noexcept {
+    uint64_t clientOrderId {0};
+    if (message.size() >= offsetof(BinaryNewOrder, clientOrderId) + sizeof(clientOrderId)) {
+        std::memcpy(&clientOrderId, message.data() + offsetof(BinaryNewOrder, clientOrderId), sizeof(clientOrderId));
+    }
+    return clientOrderId;
+}
+
+ParseError decodeBinary(std::string_view message, ParsedMessage& parsed) noexcept {
+    parsed.clientOrderId = peekClientOrderId(message); // Set before validating so a reject can quote it
+    BinaryHeader header;
+    if (message.size() < sizeof(header)) {
+        return ParseError::BadLength;
+    }
+    std::memcpy(&header, message.data(), sizeof(header));
+    if (header.length != message.size()) {
+        return ParseError::BadLength;
+    }
+
+    switch (header.type) {
+        case BinaryMessageType::NewOrder: {
+            BinaryNewOrder newOrder;
+            if (message.size() != sizeof(newOrder)) {
+                return ParseError::BadLength;
+            }
+            std::memcpy(&newOrder, message.data(), sizeof(newOrder));
+            parsed.kind = MessageKind::NewOrder;
+            if (!decodeSide(newOrder.side, parsed.side)) {
+                return ParseError::BadSide;
+            }
+            if (!decodeOrderType(newOrder.orderType, parsed.type)) {
+                return ParseError::UnknownOrderType;
+            }
+            if (newOrder.quantity == 0) {
+                return ParseError::BadQuantity;
+            }
+            if (!symbolAt(message, offsetof(BinaryNewOrder, symbol), parsed.symbol)) {
+                return ParseError::BadSymbol;
+            }
+            parsed.price = newOrder.price;
+            parsed.quantity = newOrder.quantity;
+            return ParseError::None;
+        }
+        case BinaryMessageType::Cancel: {
+            BinaryCancel cancel;
+            if (message.size() != sizeof(cancel)) {
+                return ParseError::BadLength;
+            }
+            std::memcpy(&cancel, message.data(), sizeof(cancel));
+            parsed.kind = MessageKind::Cancel;
+            if (!symbolAt(message, offsetof(BinaryCancel, symbol), parsed.symbol)) {
+                return ParseError::BadSymbol;
+            }
+            parsed.orderId = cancel.orderId;
+            return ParseError::None;
+        }
+        case BinaryMessageType::Modify: {
+            BinaryModify modify;
+            if (message.size() != sizeof(modify)) {
+                return ParseError::BadLength;
+            }
+            std::memcpy(&modify, message.data(), sizeof(modify));
+            parsed.kind = MessageKind::Modify;
+            if (modify.quantity == 0) {
+                return ParseError::BadQuantity;
+            }
+            if (!symbolAt(message, offsetof(BinaryModify, symbol), parsed.symbol)) {
+                return ParseError::BadSymbol;
+            }
+            parsed.orderId = modify.orderId;
+            parsed.price = modify.price;
+            parsed.quantity = modify.quantity;
+            return ParseError::None;
+        }
+    }
+    return ParseError::UnknownMessageType;
+}
+
+BinaryNewOrder makeBinaryNewOrder(uint64_t clientOrderId, std::string_view symbol, Side side, OrderType type, Price price, Quantity quantity) noexcept {
+    BinaryNewOrder message {makeMessage<BinaryNewOrder>(BinaryMessageType::NewOrder, clientOrderId, symbol)};
+    message.side = sideCode(side);
+    message.orderType = orderTypeCode(type);
+    message.price = price;
+    message.quantity = quantity;
+    return message;
+}
+
+BinaryCancel makeBinaryCancel(uint64_t clientOrderId, std::string_view symbol, OrderId orderId) noexcept {
+    BinaryCancel message {makeMessage<BinaryCancel>(BinaryMessageType::Cancel, clientOrderId, symbol)};
+    message.orderId = orderId;
+    return message;
+}
+
+BinaryModify makeBinaryModify(uint64_t clientOrderId, std::string_view symbol, OrderId orderId, Price price, Quantity quantity) noexcept {
+    BinaryModify message {makeMessage<BinaryModify>(BinaryMessageType::Modify, clientOrderId, symbol)};
+    message.orderId = orderId;
+    message.price = price;
+    message.quantity = quantity;
+    return message;
+}
+
+BinaryReport makeBinaryReport(const ExecutionReport& report) noexcept {
+    BinaryReport message{};
+    message.header = BinaryHeader{sizeof(BinaryReport), static_cast<BinaryMessageType>(reportTypeCode(report.type)), 0};
+    message.reason = static_cast<uint8_t>(report.reason);
+    message.parseError = static_cast<uint8_t>(report.parseError);
+    message.clientOrderId = report.clientOrderId;
+    message.orderId = report.orderId;
+    message.price = report.price;
+    message.quantity = report.quantity;
+    message.leaves = report.leaves;
+    return message;
+}
@@ -0,0 +1,42 @@
+#include "BookManager.h"
+
+void BookManager::configureBook(SymbolId symbol, const OrderBookConfig& config){
+	if(symbol >= books_.size()){
+		throw std::out_of_range(std::format("Symbol({}) is past the max of {} symbols", symbol, books_.size()));
+	}
+	if(books_[symbol] != nullptr){
+		throw std::logic_error(std::format("Symbol({}) already has a book, configure it before its first order", symbol));
+	}
+	bookConfigs_[symbol] = config;
+}
+
+OrderBook& BookManager::createBook(SymbolId symbol){
+	const OrderBookConfig& config {bookConfigs_[symbol] ? *bookConfigs_[symbol] : config_.defaultBook};
+	std::unique_ptr<OrderBook>& book {books_[symbol]};
+	book = std::make_unique<OrderBook>(config);
+	++bookCount_;
+
+	if(tradeSink_){
+		connectTradeSink(symbol, *book);
+	}
+	return *book;
+}
+
+void BookManager::connectTradeSink(SymbolId symbol, OrderBook& book){
+	book.setTradeSink([this, symbol](const Trade& trade){
+		tradeSink_(symbol, trade);
+	});
+}
+
+void BookManager::setTradeSink(SymbolTradeSink sink){
+	tradeSink_ = std::move(sink);
+	for(SymbolId symbol {}; symbol < books_.size(); ++symbol){
+		if(books_[symbol] != nullptr){
+			if(tradeSink_){
+				connectTradeSink(symbol, *books_[symbol]);
+			} else {
+				books_[symbol]->setTradeSink({});
+			}
+		}
+	}
+}
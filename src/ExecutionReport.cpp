@@ -0,0 +1,44 @@
+#include "ExecutionReport.h"
+
+#include <format>
+
+std::string_view toString(RejectReason reason) noexcept {
+    switch (reason) {
+        case RejectReason::None:         return "ok";
+        case RejectReason::Malformed:    return "malformed";
+        case RejectReason::NoSymbols:    return "no symbol ids left";
+        case RejectReason::Refused:      return "refused";
+        case RejectReason::UnknownOrder: return "unknown order";
+        case RejectReason::Busy:         return "busy";
+        case RejectReason::JournalFailing: return "journal failing";
+    }
+    return "unknown reason";
+}
+
+size_t formatTextReport(const ExecutionReport& report, std::span<char, maxTextReportLength> out) noexcept {
+    char* const begin {out.data()};
+    const size_t size {out.size()};
+    char* end {begin};
+    switch (report.type) {
+        case ReportType::Accepted:
+            end = std::format_to_n(begin, size, "ACCEPTED {} {} {} {}\n", report.clientOrderId, report.orderId, report.price, report.quantity).out;
+            break;
+        case ReportType::Rejected:
+            end = std::format_to_n(begin, size, "REJECTED {} {} {}\n", report.clientOrderId, report.orderId,
+                report.reason == RejectReason::Malformed ? toString(report.parseError) : toString(report.reason)).out;
+            break;
+        case ReportType::Expired:
+            end = std::format_to_n(begin, size, "EXPIRED {} {} {}\n", report.clientOrderId, report.orderId, report.quantity).out;
+            break;
+        case ReportType::Fill:
+            end = std::format_to_n(begin, size, "FILL {} {} {} {} {}\n", report.clientOrderId, report.orderId, report.price, report.quantity, report.leaves).out;
+            break;
+        case ReportType::Cancelled:
+            end = std::format_to_n(begin, size, "CANCELLED {} {} {}\n", report.clientOrderId, report.orderId, report.quantity).out;
+            break;
+        case ReportType::Modified:
+            end = std::format_to_n(begin, size, "MODIFIED {} {} {} {}\n", report.clientOrderId, report.orderId, report.price, report.quantity).out;
+            break;
+    }
+    return static_cast<size_t>(end - begin);
+}
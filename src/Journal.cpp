@@ -0,0 +1,304 @@
+#include "Journal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <system_error>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+bool JournalRecord::isJournaled(const Command& command) noexcept {
+	return command.type == CommandType::NewOrder || command.type == CommandType::RejectedOrder || command.type == CommandType::Cancel
+		|| command.type == CommandType::Modify || command.type == CommandType::TradeReport;
+}
+
+JournalRecord JournalRecord::fromCommand(const Command& command) noexcept {
+	JournalRecord record{};
+	switch(command.type){
+		case CommandType::NewOrder:
+		case CommandType::RejectedOrder:
+			record.type = JournalRecordType::NewOrder;
+			record.side = static_cast<uint8_t>(command.newOrder.side);
+			record.orderType = static_cast<uint8_t>(command.newOrder.type);
+			record.rejected = command.type == CommandType::RejectedOrder ? 1 : 0;
+			record.symbol = command.newOrder.symbol;
+			record.orderId = command.newOrder.orderId;
+			record.price = command.newOrder.price;
+			record.quantity = command.newOrder.quantity;
+			break;
+		case CommandType::Cancel:
+			record.type = JournalRecordType::Cancel;
+			record.symbol = command.cancel.symbol;
+			record.orderId = command.cancel.orderId;
+			break;
+		case CommandType::Modify:
+			record.type = JournalRecordType::Modify;
+			record.symbol = command.modify.symbol;
+			record.orderId = command.modify.orderId;
+			record.price = command.modify.price;
+			record.quantity = command.modify.quantity;
+			break;
+		case CommandType::TradeReport:
+			record.type = JournalRecordType::Trade;
+			record.symbol = command.tradeReport.symbol;
+			record.orderId = command.tradeReport.takerOrderId;
+			record.makerOrderId = command.tradeReport.makerOrderId;
+			record.price = command.tradeReport.price;
+			record.quantity = command.tradeReport.quantity;
+			record.tradeId = command.tradeReport.tradeId;
+			break;
+		case CommandType::Text:
+		case CommandType::Binary:
+		case CommandType::LevelUpdate:
+			break;
+	}
+	return record;
+}
+
+Journal::Journal(const JournalConfig& config)
+	: config_ { config }
+	, fd_ { -1 }
+	, buffers_ { std::max<size_t>(config.bufferSize, sizeof(JournalRecord)) * std::max<size_t>(config.bufferCount, 1), ArenaPaging::Default, ArenaWarmup::Prefault }
+	, bufferSize_ { std::max<size_t>(config.bufferSize, sizeof(JournalRecord)) }
+	, recordsPerBuffer_ { bufferSize_ / sizeof(JournalRecord) }
+	, used_ ( std::max<size_t>(config.bufferCount, 1), 0 )
+	, current_ { 0 }
+	, written_ { 0 }
+	, nextSequence_ { 1 }
+	, lastSync_ { std::chrono::steady_clock::now() }
+	, unsynced_ { false }
+	, stats_ {}
+{
+	if(config_.path.empty()){
+		throw std::invalid_argument("Journal needs a path");
+	}
+	openFile();
+}
+
+Journal::~Journal(){
+	try{
+		commit();
+		if(config_.fsync != JournalFsync::Never){
+			sync();
+		}
+	} catch(...){
+		// Nothing left to tell about it, the records that made it are still whole
+	}
+#ifndef _WIN32
+	if(fd_ >= 0){
+		close(fd_);
+	}
+#endif
+}
+
+// Appending to an existing journal continues its sequence. A torn last record (crash mid write) is cut off
+void Journal::openFile(){
+#ifdef _WIN32
+	throw std::runtime_error("Journal needs POSIX file IO (writev, fdatasync)");
+#else
+	const int flags {O_WRONLY | O_CREAT | O_CLOEXEC | (config_.truncate ? O_TRUNC : 0)};
+	fd_ = open(config_.path.c_str(), flags, 0644);
+	if(fd_ < 0){
+		throw std::system_error(errno, std::generic_category(), std::format("Journal could not open {}", config_.path));
+	}
+
+	struct stat info{};
+	if(fstat(fd_, &info) != 0){
+		throw std::system_error(errno, std::generic_category(), std::format("Journal could not stat {}", config_.path));
+	}
+
+	const off_t whole {static_cast<off_t>(info.st_size / sizeof(JournalRecord) * sizeof(JournalRecord))};
+	if(whole != info.st_size && ftruncate(fd_, whole) != 0){
+		throw std::system_error(errno, std::generic_category(), std::format("Journal could not cut the torn tail of {}", config_.path));
+	}
+
+	if(whole > 0){
+		const int reader {open(config_.path.c_str(), O_RDONLY | O_CLOEXEC)};
+		JournalRecord last{};
+		const bool readLast {reader >= 0 && pread(reader, &last, sizeof(last), whole - static_cast<off_t>(sizeof(last))) == sizeof(last)};
+		if(reader >= 0){
+			close(reader);
+		}
+		if(!readLast){
+			throw std::runtime_error(std::format("Journal could not read the last record of {}", config_.path));
+		}
+		nextSequence_ = last.sequence + 1;
+	}
+
+	if(lseek(fd_, 0, SEEK_END) < 0){
+		throw std::system_error(errno, std::generic_category(), std::format("Journal could not seek to the end of {}", config_.path));
+	}
+#endif
+}
+
+void Journal::append(JournalRecord record){
+	if(used_[current_] + sizeof(JournalRecord) > recordsPerBuffer_ * sizeof(JournalRecord)){
+		if(current_ + 1 == used_.size()){
+			commit();
+		} else {
+			++current_;
+		}
+	}
+
+	record.sequence = nextSequence_++;
+	std::memcpy(buffers_.data() + current_ * bufferSize_ + used_[current_], &record, sizeof(record));
+	used_[current_] += sizeof(record);
+	++stats_.records;
+}
+
+void Journal::commit(){
+	if(used_[0] == 0){
+		return;
+	}
+	writeBuffers();
+
+	std::fill(used_.begin(), used_.end(), 0);
+	current_ = 0;
+	written_ = 0;
+	++stats_.commits;
+
+	const auto now {std::chrono::steady_clock::now()};
+	if(config_.fsync == JournalFsync::EveryCommit
+		|| (config_.fsync == JournalFsync::Interval && now - lastSync_ >= config_.fsyncInterval)){
+		sync();
+	} else if(config_.fsync == JournalFsync::Interval){
+		unsynced_ = true;
+	}
+}
+
+void Journal::idle(){
+	if(unsynced_){
+		sync();
+	}
+}
+
+// One writev for every filled buffer, looping over short writes. If a write fails after some of it made it to the
+// file, written_ remembers how far it got so the next commit doesn't write those records a second time (the reader
+// would take the repeated sequence numbers for a gap and stop there)
+void Journal::writeBuffers(){
+#ifndef _WIN32
+	std::vector<iovec> pending{};
+	pending.reserve(current_ + 1);
+	size_t skip {written_};
+	for(size_t i {}; i <= current_ && used_[i] > 0; ++i){
+		if(skip >= used_[i]){
+			skip -= used_[i];
+			continue;
+		}
+		pending.push_back(iovec{buffers_.data() + i * bufferSize_ + skip, used_[i] - skip});
+		skip = 0;
+	}
+
+	size_t first {};
+	while(first < pending.size()){
+		const ssize_t written {writev(fd_, pending.data() + first, static_cast<int>(pending.size() - first))};
+		if(written < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			throw std::system_error(errno, std::generic_category(), std::format("Journal write to {} failed", config_.path));
+		}
+		stats_.bytesWritten += static_cast<uint64_t>(written);
+		written_ += static_cast<size_t>(written);
+
+		size_t remaining {static_cast<size_t>(written)};
+		while(first < pending.size() && remaining >= pending[first].iov_len){
+			remaining -= pending[first].iov_len;
+			++first;
+		}
+		if(first < pending.size()){
+			pending[first].iov_base = static_cast<std::byte*>(pending[first].iov_base) + remaining;
+			pending[first].iov_len -= remaining;
+		}
+	}
+#endif
+}
+
+void Journal::sync(){
+#ifndef _WIN32
+	if(fdatasync(fd_) != 0){
+		throw std::system_error(errno, std::generic_category(), std::format("Journal fdatasync of {} failed", config_.path));
+	}
+#endif
+	lastSync_ = std::chrono::steady_clock::now();
+	unsynced_ = false;
+	++stats_.syncs;
+}
+
+JournalReader::JournalReader(const std::string& path, size_t chunkSize)
+	: fd_ { -1 }
+	, buffer_ ( std::max(chunkSize, sizeof(JournalRecord)) )
+	, filled_ { 0 }
+	, offset_ { 0 }
+	, expectedSequence_ { 0 }
+	, gap_ { false }
+{
+#ifdef _WIN32
+	throw std::runtime_error("JournalReader needs POSIX file IO");
+#else
+	fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd_ < 0){
+		throw std::system_error(errno, std::generic_category(), std::format("Journal {} could not be opened for reading", path));
+	}
+#endif
+}
+
+JournalReader::~JournalReader(){
+#ifndef _WIN32
+	if(fd_ >= 0){
+		close(fd_);
+	}
+#endif
+}
+
+// Moves the unread tail to the front and tops the buffer up, false once there's nothing more to read
+bool JournalReader::refill(){
+#ifndef _WIN32
+	const size_t left {filled_ - offset_};
+	std::memmove(buffer_.data(), buffer_.data() + offset_, left);
+	filled_ = left;
+	offset_ = 0;
+
+	while(filled_ < buffer_.size()){
+		const ssize_t got {read(fd_, buffer_.data() + filled_, buffer_.size() - filled_)};
+		if(got < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			throw std::system_error(errno, std::generic_category(), "Journal read failed");
+		}
+		if(got == 0){
+			break;
+		}
+		filled_ += static_cast<size_t>(got);
+	}
+	return filled_ - offset_ >= sizeof(JournalRecord);
+#else
+	return false;
+#endif
+}
+
+bool JournalReader::next(JournalRecord& record){
+	if(gap_){
+		return false;
+	}
+	if(filled_ - offset_ < sizeof(JournalRecord) && !refill()){
+		return false; // End of the journal, a torn partial record is left alone
+	}
+
+	std::memcpy(&record, buffer_.data() + offset_, sizeof(record));
+	if(expectedSequence_ != 0 && record.sequence != expectedSequence_){
+		gap_ = true;
+		return false;
+	}
+	offset_ += sizeof(record);
+	expectedSequence_ = record.sequence + 1;
+	return true;
+}
@@ -0,0 +1,168 @@
+#include "MarketDataPublisher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <system_error>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+MarketDataPublisher::MarketDataPublisher(const MarketDataConfig& config)
+	: config_ { config }
+	, listenFd_ { -1 }
+	, levels_ {}
+	, batch_ {}
+	, subscribers_ {}
+	, packet_ ( sizeof(MarketDataHeader) + std::max<size_t>(config.levelsPerPacket, 1) * sizeof(MarketDataLevel) )
+	, stats_ {}
+{
+	config_.levelsPerPacket = std::max<size_t>(config_.levelsPerPacket, 1);
+	subscribers_.reserve(config_.maxSubscribers);
+
+#ifdef _WIN32
+	throw std::runtime_error("MarketDataPublisher needs unix domain sockets");
+#else
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if(config_.socketPath.empty() || config_.socketPath.size() >= sizeof(address.sun_path)){
+		throw std::invalid_argument(std::format("Market data socket path '{}' is empty or longer than {} characters", config_.socketPath, sizeof(address.sun_path) - 1));
+	}
+	std::memcpy(address.sun_path, config_.socketPath.c_str(), config_.socketPath.size() + 1);
+
+	// Packets keep their boundaries and are sent whole or not at all, so a full socket never leaves half an update behind
+	listenFd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(listenFd_ < 0){
+		throw std::system_error(errno, std::generic_category(), "Market data socket could not be created");
+	}
+
+	unlink(config_.socketPath.c_str()); // Left over from a previous run
+	if(bind(listenFd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+		|| listen(listenFd_, static_cast<int>(config_.maxSubscribers)) != 0){
+		const int error {errno};
+		closeSocket(listenFd_);
+		throw std::system_error(error, std::generic_category(), std::format("Market data socket could not listen on {}", config_.socketPath));
+	}
+#endif
+}
+
+MarketDataPublisher::~MarketDataPublisher(){
+	for(Subscriber& subscriber : subscribers_){
+		closeSocket(subscriber.fd);
+	}
+	closeSocket(listenFd_);
+#ifndef _WIN32
+	unlink(config_.socketPath.c_str());
+#endif
+}
+
+void MarketDataPublisher::closeSocket(int fd) noexcept {
+#ifndef _WIN32
+	if(fd >= 0){
+		close(fd);
+	}
+#else
+	(void)fd;
+#endif
+}
+
+void MarketDataPublisher::update(SymbolId symbol, Side side, Price price, Quantity quantity){
+	const LevelKey key {symbol, side, price};
+	if(quantity == 0){
+		levels_.erase(key);
+	} else {
+		levels_[key] = quantity;
+	}
+	batch_[key] = quantity;
+}
+
+Quantity MarketDataPublisher::getLevel(SymbolId symbol, Side side, Price price) const {
+	const auto level {levels_.find(LevelKey{symbol, side, price})};
+	return level == levels_.end() ? 0 : level->second;
+}
+
+void MarketDataPublisher::publish(){
+	if(!batch_.empty()){
+		++stats_.batches;
+		for(Subscriber& subscriber : subscribers_){
+			for(const auto& [key, quantity] : batch_){
+				if(!subscriber.pending.insert_or_assign(key, quantity).second){
+					++stats_.conflated; // Never got the previous total
+				}
+			}
+		}
+		batch_.clear();
+	}
+
+	// After the batch went out, the snapshot already has it
+	acceptSubscribers();
+
+	for(size_t i {}; i < subscribers_.size();){
+		if(flush(subscribers_[i])){
+			++i;
+		} else {
+			closeSocket(subscribers_[i].fd);
+			subscribers_[i] = std::move(subscribers_.back());
+			subscribers_.pop_back();
+			++stats_.disconnects;
+		}
+	}
+}
+
+void MarketDataPublisher::acceptSubscribers(){
+#ifndef _WIN32
+	while(true){
+		const int fd {accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+		if(fd < 0){
+			return; // EAGAIN when nobody else is waiting, anything else gets retried on the next publish
+		}
+		if(subscribers_.size() >= config_.maxSubscribers){
+			closeSocket(fd);
+			continue;
+		}
+		subscribers_.push_back(Subscriber{fd, 0, true, levels_});
+	}
+#endif
+}
+
+// Sends pending levels a packet at a time until they're all out or the socket is full
+bool MarketDataPublisher::flush(Subscriber& subscriber){
+#ifndef _WIN32
+	while(!subscriber.pending.empty()){
+		const MarketDataHeader header {
+			subscriber.sequence + 1,
+			static_cast<uint32_t>(std::min(subscriber.pending.size(), config_.levelsPerPacket)),
+			subscriber.snapshot ? MarketDataHeader::snapshotFlag : 0u
+		};
+		std::memcpy(packet_.data(), &header, sizeof(header));
+
+		auto level {subscriber.pending.begin()};
+		for(uint32_t i {}; i < header.count; ++i, ++level){
+			const MarketDataLevel wire {level->first.symbol, level->first.price, level->second, static_cast<uint8_t>(level->first.side), {}};
+			std::memcpy(packet_.data() + sizeof(header) + i * sizeof(wire), &wire, sizeof(wire));
+		}
+
+		const size_t size {sizeof(header) + header.count * sizeof(MarketDataLevel)};
+		if(send(subscriber.fd, packet_.data(), size, MSG_NOSIGNAL | MSG_DONTWAIT) < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			return errno == EAGAIN || errno == EWOULDBLOCK; // Slow consumer keeps its pending set, anything else means it's gone
+		}
+
+		subscriber.pending.erase(subscriber.pending.begin(), level);
+		++subscriber.sequence;
+		++stats_.packetsSent;
+		stats_.levelsSent += header.count;
+	}
+	subscriber.snapshot = false;
+#else
+	(void)subscriber;
+#endif
+	return true;
+}
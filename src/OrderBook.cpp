@@ -5,279 +5,433 @@
 #include <format>
 
 
-template <typename OrderMap>
-void OrderBook::fillOrders(OrderMap& orderMap, const OrderPointer& incomingOrder)
+// Whether a resting price is good enough for a taker with this limit
+template <Side TakerSide>
+static constexpr bool crosses(Price restingPrice, Price limitPrice) noexcept {
+	if constexpr (TakerSide == Side::Buy){
+		return restingPrice <= limitPrice;
+	} else {
+		return restingPrice >= limitPrice;
+	}
+}
+
+template <Side TakerSide, typename Policy>
+void OrderBook::fillOrders(Order& incomingOrder, OrderStatus& incomingStatus)
 { 
+	auto& ladder {ladderFor<opposite(TakerSide)>()};
+	Quantity& oppositeQuantity {quantityFor<opposite(TakerSide)>()};
+
 	// Go through each order at each best price and fill each order and subtract their quantity from the market order
-	for (auto it {orderMap.begin()}; it != orderMap.end() && !incomingOrder->isFilled();){
+	while (!ladder.empty() && !incomingOrder.isFilled()){
 
-		Price currentPrice {it->first};
+		Price currentPrice {ladder.getBestPrice()};
 
-		// Limit order price constraint check
+		// Limit price constraint check, compiled out for market orders
 		// Gauranteed to match the best price but not the worst price so you need this check here 
-		if (incomingOrder->getOrderType() == OrderType::Limit &&
-				((incomingOrder->getSide() == Side::Buy  && currentPrice > incomingOrder->getPrice()) ||
-				 (incomingOrder->getSide() == Side::Sell && currentPrice < incomingOrder->getPrice())))
-		{
-			break; // You went in too deep
+		if constexpr (Policy::priceLimited){
+			if (!crosses<TakerSide>(currentPrice, incomingOrder.getPrice())){
+				break; // You went in too deep
+			}
 		}
 
 
-		OrderPointers& orderList {it->second};
-
-		// Go through the list of Order Ptrs at each price in the map with the value being all the orders FIFO at that price
-		for (auto orderIt {orderList.begin()}; orderIt != orderList.end() && !incomingOrder->isFilled(); ){
-			OrderPointer& currentOrder {*orderIt}; // Current order is an order that is already in the orderbook/Current order being pointed to
+		OrderPointers& orderList {ladder.getBestLevel()};
 
-			Quantity quantityFilled {std::min(currentOrder->getRemainingQuantity(), incomingOrder->getRemainingQuantity())};
+		// Go through the queue of resting orders at the best price, all the orders FIFO at that price
+		// Only the hot records are read here, the cold table and the index are left alone unless an order is used up
+		while (!orderList.empty() && !incomingOrder.isFilled()){
+			const OrderPointer handle {orderList.front()};
+			HotOrder& resting {orderStore_.hot(handle)};
+			if(resting.next != nullOrderHandle){
+				orderStore_.prefetch(resting.next);
+			}
 
-			incomingOrder->fill(quantityFilled);
-			currentOrder->fill(quantityFilled);
+			Quantity quantityFilled {std::min(resting.remainingQuantity, incomingOrder.getRemainingQuantity())};
 
-			statusCache_[incomingOrder->getOrderId()].filledQuantity = incomingOrder->getFilledQuantity();
-			statusCache_[currentOrder->getOrderId()].filledQuantity = currentOrder->getFilledQuantity();
+			incomingOrder.fill(quantityFilled);
+			resting.remainingQuantity -= quantityFilled;
+			orderList.reduceQuantity(quantityFilled);
 
-			statusCache_[incomingOrder->getOrderId()].remainingQuantity = incomingOrder->getRemainingQuantity();
-			statusCache_[currentOrder->getOrderId()].remainingQuantity = currentOrder->getRemainingQuantity();
+			incomingStatus.filledQuantity = incomingOrder.getFilledQuantity();
+			incomingStatus.remainingQuantity = incomingOrder.getRemainingQuantity();
 
 			// Record the trade in the order book 
 			TradeId tradeId{nextTradeId_++};                 
 			Trade trade
 			{
 				tradeId, 
-					incomingOrder->getOrderId(), 
-					currentOrder->getOrderId(), 
+					incomingOrder.getOrderId(), 
+					resting.orderId, 
 					quantityFilled, 
-					currentOrder->getPrice()
+					currentPrice
 			};
-			trades_.push_back(trade);
-
-			// Trade(const TradeId& tradeId, const OrderId& buyOrderId, const OrderId& sellOrderId, const Quantity& quantity, const Price& price)
-			if(incomingOrder->getSide() == Side::Buy){
-				quantityOfAsks_ -= quantityFilled;
-			} else{
-				quantityOfBids_ -= quantityFilled;
+			trades_.push(trade);
+			if(tradeSink_){
+				tradeSink_(trade);
 			}
 
-			if(currentOrder->isFilled()){
-				statusCache_[currentOrder->getOrderId()].state = OrderState::Filled;
-				statusCache_[currentOrder->getOrderId()].remainingQuantity = 0;
-				statusCache_[currentOrder->getOrderId()].filledQuantity = currentOrder->getFilledQuantity();
-
-				// Remove from the per-price list and also erase the order registry to avoid leaving a stale entry.
-				OrderId filledOrderId = currentOrder->getOrderId();
-				orderIt = orderList.erase(orderIt);        // erase returns iterator to next element
-				orders_.erase(filledOrderId);              // remove entry from orders_
+			oppositeQuantity -= quantityFilled;
+
+			if(resting.remainingQuantity == 0){
+				// A resting order's status isn't updated on partial fills (reviewOrderStatus reads the hot record)
+				// but remaining + filled always adds up to its full size
+				IndexSlot* currentSlot {index_.find(resting.orderId)};
+				currentSlot->status.state = OrderState::Filled;
+				currentSlot->status.filledQuantity += currentSlot->status.remainingQuantity;
+				currentSlot->status.remainingQuantity = 0;
+				currentSlot->handle = nullOrderHandle; // Status stays around, the order just isn't resting anymore
+				retireStatus(resting.orderId);
+
+				// Unlink from the level and hand the slot back to the store
+				orderList.popFront(orderStore_);
+				orderStore_.destroy(handle);
 			}
-			else{
-				++orderIt;
-			}
-			// No need for else statement. If else then the for loop takes care of situation where incoming order got filled before current
+			// No need for else statement. If else then the loop condition takes care of situation where incoming order got filled before current
 
-		} // Inner for loop 
+		} // Inner loop 
 
-		if(orderList.empty()){
-			it = orderMap.erase(it);
-		}
-		else{
-			++it;
+		levelChanged<opposite(TakerSide)>(currentPrice, orderList.getTotalQuantity());
+		if(!orderList.empty()){
+			break; // Incoming order got filled before the level was emptied
 		}
-		// No need for else statement. If else then the for loop takes care of situation where incoming order got filled before orderlist was empty 
+		ladder.releaseBestLevel();
 	}
 
-	if(incomingOrder->isFilled()){
-		statusCache_[incomingOrder->getOrderId()].state = OrderState::Filled;
-		statusCache_[incomingOrder->getOrderId()].remainingQuantity = 0;
-		statusCache_[incomingOrder->getOrderId()].filledQuantity = incomingOrder->getFilledQuantity();
+	if(incomingOrder.isFilled()){
+		incomingStatus.state = OrderState::Filled;
+		incomingStatus.remainingQuantity = 0;
+		incomingStatus.filledQuantity = incomingOrder.getFilledQuantity();
+		retireStatus(incomingOrder.getOrderId());
 	}
 }
 
-template<typename OrderMap>
-void OrderBook::addOrderToOrderBook(OrderMap& orderMap, const OrderPointer& incomingOrder){
-	const Price price {incomingOrder->getPrice()};
+template<Side RestingSide>
+void OrderBook::addOrderToOrderBook(const Order& incomingOrder, IndexSlot& incomingSlot){
+	const OrderPointer handle {orderStore_.create(
+		HotOrder{incomingOrder.getOrderId(), incomingOrder.getRemainingQuantity(), nullOrderHandle},
+		ColdOrder{nullOrderHandle, incomingOrder.getPrice(), incomingOrder.getInitialQuantity(), incomingOrder.getOrderType(), RestingSide, 0}
+	)};
+	linkNode<RestingSide>(handle);
 
-    auto [itMap, success] = orderMap.try_emplace(price);
-    OrderPointers& orderList {itMap->second};
-
-    orderList.push_back(incomingOrder);
+	incomingSlot.handle = handle;
+}
 
-    const auto itList = std::prev(orderList.end());
-    orders_[incomingOrder->getOrderId()] = OrderEntry{incomingOrder, itList};
+template<Side RestingSide>
+void OrderBook::linkNode(OrderPointer handle){
+	ColdOrder& cold {orderStore_.cold(handle)};
+	cold.sequence = nextSequence_++;
+	OrderPointers& level {ladderFor<RestingSide>().openLevel(cold.price)};
+	level.pushBack(orderStore_, handle);
+	quantityFor<RestingSide>() += orderStore_.hot(handle).remainingQuantity;
+	levelChanged<RestingSide>(cold.price, level.getTotalQuantity());
+}
 
-    if (incomingOrder->getSide() == Side::Buy) {
-        quantityOfBids_ += incomingOrder->getRemainingQuantity(); 
-    } else {
-        quantityOfAsks_ += incomingOrder->getRemainingQuantity();
-    }
+template<Side RestingSide>
+void OrderBook::unlinkNode(OrderPointer handle){
+	auto& ladder {ladderFor<RestingSide>()};
+	const Price price {orderStore_.cold(handle).price};
+	if(auto* level = ladder.findLevel(price); level != nullptr){
+		quantityFor<RestingSide>() -= orderStore_.hot(handle).remainingQuantity;
+		level->erase(orderStore_, handle);
+		levelChanged<RestingSide>(price, level->getTotalQuantity());
+		if(level->empty()){
+			ladder.releaseLevel(price);
+		}
+	}
 }
 
-bool OrderBook::processOrder(Order order)
-{
-	OrderId id = order.getOrderId();
-	const auto it = statusCache_.find(id);
-	if(it != statusCache_.end()){
-		// Just return false why are you trying to redo an existing order?
+template<Side RestingSide>
+bool OrderBook::modifyRestingOrder(IndexSlot& slot, const Quantity& quantity, const Price& price){
+	const OrderPointer handle {slot.handle};
+	HotOrder& hot {orderStore_.hot(handle)};
+	ColdOrder& cold {orderStore_.cold(handle)};
+	const Quantity oldQuantity {hot.remainingQuantity};
+	const Quantity filledQuantity {cold.initialQuantity - oldQuantity};
+
+	if(price == cold.price){
+		if(quantity <= oldQuantity){
+			// Size down, the order doesn't move so it keeps its time priority
+			OrderPointers& orderList {*ladderFor<RestingSide>().findLevel(price)};
+			orderList.reduceQuantity(oldQuantity - quantity);
+			quantityFor<RestingSide>() -= oldQuantity - quantity;
+			hot.remainingQuantity = quantity;
+			levelChanged<RestingSide>(price, orderList.getTotalQuantity());
+		} else {
+			// Size up loses priority, same slot goes to the back of the level
+			unlinkNode<RestingSide>(handle);
+			hot.remainingQuantity = quantity;
+			linkNode<RestingSide>(handle);
+		}
+		cold.initialQuantity = filledQuantity + quantity;
+		slot.status.remainingQuantity = quantity;
+		slot.status.filledQuantity = filledQuantity;
+		return true;
+	}
+
+	// New price, check everything that could fail before the order is touched
+	if(!ladderFor<RestingSide>().canHold(price)){
 		return false;
 	}
-	statusCache_.emplace(id, OrderStatus{order.getPrice(), order.getOrderType(), order.getSide(), OrderState::Processing, order.getInitialQuantity()});
+	const auto& oppositeLadder {ladderFor<opposite(RestingSide)>()};
+	const bool crossing {!oppositeLadder.empty() && crosses<RestingSide>(oppositeLadder.getBestPrice(), price)};
+	if(crossing && cold.type == OrderType::PostOnly){
+		return false; // Stays where it was
+	}
 
-	auto incomingOrder {std::allocate_shared<Order>(std::pmr::polymorphic_allocator<Order>(&pool_), order)};
-	// First determine the side of the order 
-	Side incomingOrderSide {incomingOrder->getSide()};
+	unlinkNode<RestingSide>(handle);
+	slot.status.price = price;
+	slot.status.remainingQuantity = quantity;
+	slot.status.filledQuantity = filledQuantity;
 
-	if(incomingOrderSide == Side::Buy){
+	// Rebuilt with its earlier fills so the filled quantity carries over if it trades
+	Order order {RestingSide, price, hot.orderId, cold.type, filledQuantity + quantity, filledQuantity + quantity};
+	if(filledQuantity > 0){
+		order.fill(filledQuantity);
+	}
 
-		Quantity quantityOfAsks {getQuantityOfAsks()};
+	if(crossing){
+		// Out of every level while it trades as a taker, the status bookkeeping is the same as for a new limit order
+		fillOrders<RestingSide, LimitPolicy>(order, slot.status);
+		if(order.isFilled()){
+			slot.handle = nullOrderHandle;
+			orderStore_.destroy(handle);
+			return true;
+		}
+	}
 
-		// If market order check to see if the quantity can be filled or FOK 
-		// Inherintly checks that the orderbook isn't empty  
-		if(incomingOrder->getOrderType() == OrderType::Market){
+	hot.remainingQuantity = order.getRemainingQuantity();
+	cold.price = price;
+	cold.initialQuantity = order.getInitialQuantity();
+	linkNode<RestingSide>(handle);
+	return true;
+}
 
-			if( incomingOrder->getRemainingQuantity() <= quantityOfAsks){
-				fillOrders(asks_, incomingOrder);
-				return true; // Market order filled
+template <Side TakerSide, bool PriceLimited>
+bool OrderBook::canFillCompletely(const Order& incomingOrder) const {
+	if constexpr (!PriceLimited){
+		// Inherintly checks that the orderbook isn't empty
+		return incomingOrder.getRemainingQuantity() <= (TakerSide == Side::Buy ? quantityOfAsks_ : quantityOfBids_);
+	} else {
+		// Add up the level aggregates within the limit price, stop as soon as there is enough
+		Quantity available {};
+		ladderFor<opposite(TakerSide)>().forEachLevelWhile([&](Price price, const OrderPointers& level){
+			if(!crosses<TakerSide>(price, incomingOrder.getPrice())){
+				return false;
 			}
+			available += level.getTotalQuantity();
+			return available < incomingOrder.getRemainingQuantity();
+		});
+		return available >= incomingOrder.getRemainingQuantity();
+	}
+}
+
+template <Side TakerSide, typename Policy>
+bool OrderBook::executeOrder(Order& incomingOrder, IndexSlot& slot){
+	OrderStatus& status {slot.status};
 
-			statusCache_[id].state = OrderState::Expired;
-			return false; // Not enough orders to fill for market order 
+	// An order that may end up resting has to land on the tick grid and inside the ladder's max window
+	if constexpr (Policy::rests){
+		if(!ladderFor<TakerSide>().canHold(incomingOrder.getPrice())){
+			status.state = OrderState::Rejected;
+			retireStatus(incomingOrder.getOrderId());
+			return false;
 		}
+	}
 
-		const Price bestAsk {getBestAsk()};
+	if constexpr (Policy::postOnly){
+		const auto& oppositeLadder {ladderFor<opposite(TakerSide)>()};
+		if(!oppositeLadder.empty() && crosses<TakerSide>(oppositeLadder.getBestPrice(), incomingOrder.getPrice())){
+			status.state = OrderState::Rejected; // Would have taken liquidity
+			retireStatus(incomingOrder.getOrderId());
+			return false;
+		}
+		addOrderToOrderBook<TakerSide>(incomingOrder, slot);
+		return true;
+	} else {
+		// If fill or kill check to see if the quantity can be filled 
+		if constexpr (Policy::allOrNothing){
+			if(!canFillCompletely<TakerSide, Policy::priceLimited>(incomingOrder)){
+				status.state = OrderState::Expired;
+				retireStatus(incomingOrder.getOrderId());
+				return false; // Not enough orders to fill 
+			}
+		}
 
-		// If the order book for asks is empty or the order is unable to match with best sell then add to orderbook	
-		if( (quantityOfAsks == 0) || (bestAsk > incomingOrder->getPrice()) ){
-			addOrderToOrderBook(bids_, incomingOrder);
-			//return true?
-			return true; // Limit order posted to orderbook
+		fillOrders<TakerSide, Policy>(incomingOrder, status);
+		if(incomingOrder.isFilled()){
+			return true;
 		}
 
-		// Do matching logic here 
-		fillOrders(asks_, incomingOrder);
-		if(!incomingOrder->isFilled()){// If not fully filled put in order book
-			addOrderToOrderBook(bids_, incomingOrder);
+		if constexpr (Policy::rests){
+			addOrderToOrderBook<TakerSide>(incomingOrder, slot); // If not fully filled put in order book
+			return true;
+		} else {
+			// Immediate or cancel leftovers are dropped, the order counts as done if anything traded
+			status.state = OrderState::Expired;
+			retireStatus(incomingOrder.getOrderId());
+			return incomingOrder.getFilledQuantity() > 0;
 		}
+	}
+}
 
-		return true; 
+template <Side TakerSide>
+bool OrderBook::dispatchOrderType(Order& incomingOrder, IndexSlot& slot){
+	// The only runtime branch on the order type, everything after it is specialized
+	switch(incomingOrder.getOrderType()){
+		case OrderType::Market:            return executeOrder<TakerSide, MarketPolicy>(incomingOrder, slot);
+		case OrderType::Limit:             return executeOrder<TakerSide, LimitPolicy>(incomingOrder, slot);
+		case OrderType::ImmediateOrCancel: return executeOrder<TakerSide, ImmediateOrCancelPolicy>(incomingOrder, slot);
+		case OrderType::PostOnly:          return executeOrder<TakerSide, PostOnlyPolicy>(incomingOrder, slot);
+		case OrderType::FillOrKill:        return executeOrder<TakerSide, FillOrKillPolicy>(incomingOrder, slot);
+		default:                           break;
+	}
 
+	slot.status.state = OrderState::Rejected;
+	retireStatus(incomingOrder.getOrderId());
+	return false;
+}
+
+void OrderBook::retireStatus(const OrderId& orderId){
+	if(retiredIds_.size() < statusRetention_){
+		retiredIds_.push_back(orderId);
+		return;
 	}
 
+	// Ring is full so the oldest finished status makes room. Ids that came back to life (modify keeps the id) are left alone
+	OrderId& oldest {retiredIds_[retiredHead_]};
+	if(IndexSlot* slot = index_.find(oldest); slot != nullptr && slot->status.state != OrderState::Processing){
+		index_.erase(slot);
+	}
+	oldest = orderId;
+	retiredHead_ = (retiredHead_ + 1) % statusRetention_;
+}
 
-	if(incomingOrderSide == Side::Sell){
+bool OrderBook::processOrder(Order order)
+{
+	IndexSlot* slot {nullptr};
+	return matchOrder(order, slot);
+}
 
-		Quantity quantityOfBids {getQuantityOfBids()};
+bool OrderBook::matchOrder(Order order, IndexSlot*& slot)
+{
+	OrderId id = order.getOrderId();
+	if(!OrderIndex::isValidId(id)){
+		return false; // The top two ids are reserved by the index
+	}
+
+	slot = index_.insert(id, OrderStatus{order.getPrice(), order.getOrderType(), order.getSide(), OrderState::Processing, order.getInitialQuantity()});
+	if(slot == nullptr){
+		// Just return false why are you trying to redo an existing order?
+		return false;
+	}
+	// Matching works on the local copy, a slot is only taken from the order store if the order ends up resting
+	Order& incomingOrder {order};
 
-		// If the order type is market check to see if total quantity can be filled otherwise FOK
-		// Inherintly checks that the order book isn't empty 
-		if(incomingOrder->getOrderType() == OrderType::Market){
+	// First determine the side of the order, from here on the side and type are compile time
+	if(incomingOrder.getSide() == Side::Buy){
+		return dispatchOrderType<Side::Buy>(incomingOrder, *slot);
+	}
 
-			if( incomingOrder->getRemainingQuantity() <= quantityOfBids){
-				fillOrders(bids_, incomingOrder);
-				return true; // Market order filled
-			}
+	if(incomingOrder.getSide() == Side::Sell){
+		return dispatchOrderType<Side::Sell>(incomingOrder, *slot);
+	}
 
-			statusCache_[id].state = OrderState::Expired;
-			return false; // Not enough orders to fill for market order 
+	OrderStatus& status {slot->status};
+	status.state = OrderState::Rejected;
+	retireStatus(id);
 
-		}
+	return false; 
 
-		const Price bestBid {getBestBid()};
+}
 
-		// If the orderbook is empty or the order is unable to match with best sell then add to orderbook	
-		if( (quantityOfBids == 0) || (bestBid < incomingOrder->getPrice()) ){
-			addOrderToOrderBook(asks_, incomingOrder);
-			return true; // limit order added to orderbook 
-		}
+size_t OrderBook::processOrders(std::span<const Order> orders, std::span<OrderResult> results){
+	// How far ahead the index slot and price level of upcoming orders get prefetched
+	constexpr size_t prefetchDistance {4};
 
-		// Do matching logic here 
-		fillOrders(bids_, incomingOrder);
-		if(!incomingOrder->isFilled()){
-			addOrderToOrderBook(asks_, incomingOrder);
-		}   
-		
-		return true;
+	const size_t count {std::min(orders.size(), results.size())};
 
+	for(size_t i {}; i < std::min(count, prefetchDistance); ++i){
+		index_.prefetch(orders[i].getOrderId());
 	}
 
-	statusCache_[id].state = OrderState::Rejected;
-	return false; 
+	for(size_t i {}; i < count; ++i){
+		if(i + prefetchDistance < count){
+			// Matching starts at the best level of the other side, that's the one worth having in cache
+			const Order& upcoming {orders[i + prefetchDistance]};
+			index_.prefetch(upcoming.getOrderId());
+			if(upcoming.getSide() == Side::Buy){
+				if(!asks_.empty()){
+					asks_.prefetch(asks_.getBestPrice());
+				}
+			} else if(!bids_.empty()){
+				bids_.prefetch(bids_.getBestPrice());
+			}
+		}
+
+		const Order& order {orders[i]};
+		OrderResult& result {results[i]};
+		result.orderId = order.getOrderId();
+		IndexSlot* slot {nullptr};
+		result.accepted = matchOrder(order, slot);
 
+		// Straight from the slot the match used. Duplicate ids report the original order, same as reviewOrderStatus would
+		const OrderStatus status {slot != nullptr ? slot->status : reviewOrderStatus(order.getOrderId())};
+		result.state = status.state;
+		result.filledQuantity = status.filledQuantity;
+	}
+
+	return count;
 }
 
 bool OrderBook::cancelOrder(const OrderId& orderId) {
-    const auto it = orders_.find(orderId);
-    if (it == orders_.end()) {
-        return false;
+    IndexSlot* slot {index_.find(orderId)};
+    if (slot == nullptr || slot->handle == nullOrderHandle) {
+        return false; // Unknown or not resting anymore
     }
 
-    const auto& [id, entry] = *it; 
-    const auto& orderPointer = entry.order_;
-    const auto price = orderPointer->getPrice();
-    const auto side = orderPointer->getSide();
-    const auto quantity = orderPointer->getRemainingQuantity();
-
-    if (side == Side::Buy) {
-        auto mapIt = bids_.find(price);
-        if (mapIt != bids_.end()) {
-            mapIt->second.erase(entry.location_);
-            quantityOfBids_ -= quantity;
-            if (mapIt->second.empty()) {
-                bids_.erase(mapIt);
-            }
-        }
-    } else if(side == Side::Sell){
-        auto mapIt = asks_.find(price);
-        if (mapIt != asks_.end()) {
-            mapIt->second.erase(entry.location_);
-            quantityOfAsks_ -= quantity;
-            if (mapIt->second.empty()) {
-                asks_.erase(mapIt);
-            }
-        }
+    const OrderPointer handle {slot->handle};
+    if (slot->status.side == Side::Buy) {
+        unlinkNode<Side::Buy>(handle);
+    } else {
+        unlinkNode<Side::Sell>(handle);
     }
 
-    // Update status cache if necessary before deleting the order
-    if (auto statusIt = statusCache_.find(orderId); statusIt != statusCache_.end()) {
-        statusIt->second.state = OrderState::Cancelled;
-    }
+    // Fold any partial fills from the hot record into the status before the order is gone
+    const Quantity remaining {orderStore_.hot(handle).remainingQuantity};
+    slot->status.filledQuantity += slot->status.remainingQuantity - remaining;
+    slot->status.remainingQuantity = remaining;
+    slot->status.state = OrderState::Cancelled;
+    slot->handle = nullOrderHandle;
+    retireStatus(orderId);
 
-    orders_.erase(it);
+    orderStore_.destroy(handle);
     return true;
 }
 
 bool OrderBook::modifyOrder(const OrderId& orderId, const Quantity& quantity, const Price& price){
-	const auto it = orders_.find(orderId);
-	if(it == orders_.end()){
-		return false;
+	IndexSlot* slot {index_.find(orderId)};
+	if(slot == nullptr || slot->handle == nullOrderHandle || quantity < 1){
+		return false; // Only resting orders can be modified, a quantity of 0 is a cancel
 	}
 
-	OrderEntry orderEntry {it->second};
-
-	OrderPointer& orderPointer {orderEntry.order_};
-
-	Side side{orderPointer->getSide()};
-	OrderType orderType {orderPointer->getOrderType()};
-
-	//If false return false 
-	if(!cancelOrder(orderId)){
-		return false;
-	}
-
-	statusCache_.erase(orderId); // Tbh just for simplicity I'm keeping the same id 
-
-	Order newOrder {Order(side, price, orderId, orderType, quantity, quantity)};
-
-	if(!processOrder(newOrder)){
-		return false;  
+	if(slot->status.side == Side::Buy){
+		return modifyRestingOrder<Side::Buy>(*slot, quantity, price);
 	}
-
-	return true;
+	return modifyRestingOrder<Side::Sell>(*slot, quantity, price);
 }
 
-const OrderBook::OrderStatus OrderBook::reviewOrderStatus(const OrderId& orderId) const{
-	auto it{statusCache_.find(orderId)};
+const OrderStatus OrderBook::reviewOrderStatus(const OrderId& orderId) const{
+	const IndexSlot* slot {index_.find(orderId)};
 
-	if(it != statusCache_.end()){
-		return it->second;
+	if(slot != nullptr){
+		OrderStatus status {slot->status};
+		if(slot->handle != nullOrderHandle){
+			// Partial fills of a resting order only land in its hot record
+			const Quantity remaining {orderStore_.hot(slot->handle).remainingQuantity};
+			status.filledQuantity += status.remainingQuantity - remaining;
+			status.remainingQuantity = remaining;
+		}
+		return status;
 	}
 
 	return {0, OrderType::Unknown, Side::Unknown, OrderState::Rejected, 0, 0};
@@ -298,15 +452,11 @@ void OrderBook::display(size_t depth) const{ // Used gemini for this (too lazy t
 	// 2. Display Asks (Top N cheapest sellers)
 	// We want the 5 prices closest to the spread.
 	// Since asks_ is sorted low-to-high, we take the first N elements and print in reverse
-	size_t askCount = 0;
 	std::vector<std::string> askLines;
-	for (auto it = asks_.begin(); it != asks_.end() && askCount < depth; ++it, ++askCount)
+	asks_.forEachLevel(depth, [&askLines](Price price, const OrderPointers& level)
 	{
-		Quantity totalQty = 0;
-		for (const auto &order : it->second)
-			totalQty += order->getRemainingQuantity();
-		askLines.push_back(std::format("{:>10} | {:>10} | {:>10}", "ASK", it->first, totalQty));
-	}
+		askLines.push_back(std::format("{:>10} | {:>10} | {:>10}", "ASK", price, level.getTotalQuantity()));
+	});
 	// Print them high-to-low so the best ask is right above the spread
 	for (auto it = askLines.rbegin(); it != askLines.rend(); ++it)
 	{
@@ -316,13 +466,9 @@ void OrderBook::display(size_t depth) const{ // Used gemini for this (too lazy t
 	std::cout << "---------- SPREAD: " << spread << " ----------\n";
 
 	// 3. Display Bids (Top N highest buyers)
-	size_t bidCount = 0;
-	for (auto it = bids_.begin(); it != bids_.end() && bidCount < depth; ++it, ++bidCount)
+	bids_.forEachLevel(depth, [](Price price, const OrderPointers& level)
 	{
-		Quantity totalQty = 0;
-		for (const auto &order : it->second)
-			totalQty += order->getRemainingQuantity();
-		std::cout << std::format("{:>10} | {:>10} | {:>10}\n", "BID", it->first, totalQty);
-	}
+		std::cout << std::format("{:>10} | {:>10} | {:>10}\n", "BID", price, level.getTotalQuantity());
+	});
 	std::cout << "====================================\n\n";
 }
\ No newline at end of file
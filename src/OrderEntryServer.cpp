@@ -0,0 +1,321 @@
+#include "OrderEntryServer.h"
+#include "OrderParser.h"
+#include "BinaryProtocol.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+using boost::asio::ip::tcp;
+
+Session::Session(OrderEntryServer& server, tcp::socket socket, SessionId id, size_t bufferSize)
+: server_{server}
+, socket_{std::move(socket)}
+, id_{id}
+, buffer_(bufferSize)
+, used_{0}
+, discarding_{false}
+, sendBuffer_{}
+, sendHead_{0}
+, sendSize_{0}
+, sendInFlight_{0}
+, dirty_{false}
+, inFlight_{0}
+, messages_{0}
+, stalled_{false}
+{}
+
+void Session::start(){
+    read();
+}
+
+void Session::close(){
+    boost::system::error_code ignored;
+    socket_.shutdown(tcp::socket::shutdown_both, ignored);
+    socket_.close(ignored);
+}
+
+// Reads land after whatever is left of an unfinished message, the buffer is never reallocated
+void Session::read(){
+    socket_.async_read_some(boost::asio::buffer(buffer_.data() + used_, buffer_.size() - used_),
+        [self = shared_from_this()](const boost::system::error_code& error, size_t bytes){
+            self->onRead(error, bytes);
+        });
+}
+
+void Session::onRead(const boost::system::error_code& error, size_t bytes){
+    if (error) {
+        // A last message without a newline still counts when the client hangs up cleanly, it's how one shot clients send
+        // Half a binary message is just cut off
+        if (error == boost::asio::error::eof && used_ > 0 && !discarding_ && server_.config_.protocol == OrderEntryProtocol::Text) {
+            deliver({buffer_.data(), used_});
+        }
+        server_.remove(id_);
+        return;
+    }
+
+    ++server_.stats_.reads;
+    server_.stats_.bytesReceived += bytes;
+    process(used_, used_ + bytes);
+}
+
+// Out of credits the rest of the buffer is kept as it is and no read goes out until release
+void Session::process(size_t scan, size_t end){
+    const size_t start {server_.config_.protocol == OrderEntryProtocol::Binary ? frameBinary(end) : frameText(scan, end)};
+    if (!socket_.is_open()) {
+        return; // The handler or bad framing closed us
+    }
+
+    const size_t left {end - start};
+    const bool stalled {!hasCredit()};
+    if (discarding_) {
+        used_ = 0;
+    } else if (left == buffer_.size() && !stalled) {
+        // A whole buffer without a newline, drop it and everything up to the next newline
+        ++server_.stats_.oversized;
+        discarding_ = true;
+        used_ = 0;
+    } else {
+        std::memmove(buffer_.data(), buffer_.data() + start, left);
+        used_ = left;
+    }
+
+    if (stalled) {
+        stalled_ = true;
+        ++server_.stats_.creditStalls;
+        return;
+    }
+    read();
+}
+
+size_t Session::frameText(size_t scan, size_t end){
+    size_t start {0};
+    const char* const data {buffer_.data()};
+    for (const char* found {findNewline(data + scan, data + end)}; found != data + end; found = findNewline(data + scan, data + end)) {
+        const size_t newline {static_cast<size_t>(found - data)};
+        if (discarding_) {
+            discarding_ = false; // End of the oversized message, the next one is fine
+        } else if (!hasCredit()) {
+            return start;
+        } else {
+            deliver({data + start, newline - start});
+            if (!socket_.is_open()) {
+                return start;
+            }
+        }
+        start = newline + 1;
+        scan = start;
+    }
+    return start;
+}
+
+// A length that fits the buffer is always completed by later reads, so binary sessions never go oversized
+size_t Session::frameBinary(size_t end){
+    size_t start {0};
+    const char* const data {buffer_.data()};
+    while (end - start >= sizeof(BinaryHeader) && hasCredit()) {
+        BinaryHeader header;
+        std::memcpy(&header, data + start, sizeof(header));
+        if (header.length < sizeof(header) || header.length > buffer_.size()) {
+            // There's no delimiter to find the next message by, nothing after this can be trusted
+            ++server_.stats_.badFraming;
+            server_.remove(id_);
+            return start;
+        }
+        if (end - start < header.length) {
+            break;
+        }
+        ++server_.stats_.messages;
+        ++inFlight_;
+        ++messages_;
+        server_.handler_(*this, {data + start, header.length});
+        if (!socket_.is_open()) {
+            return start;
+        }
+        start += header.length;
+    }
+    return start;
+}
+
+void Session::deliver(std::string_view message){
+    if (!message.empty() && message.back() == '\r') {
+        message.remove_suffix(1);
+    }
+    if (message.empty()) {
+        return;
+    }
+    ++server_.stats_.messages;
+    ++inFlight_;
+    ++messages_;
+    server_.handler_(*this, message);
+}
+
+bool Session::hasCredit() const noexcept {
+    return server_.config_.creditWindow == 0 || inFlight_ < server_.config_.creditWindow;
+}
+
+// Can be called from inside the handler, a stall only starts once framing is over so resuming always goes through a post
+void Session::release(uint32_t credits){
+    inFlight_ -= std::min(inFlight_, credits);
+    if (!stalled_ || !hasCredit() || !socket_.is_open()) {
+        return;
+    }
+    stalled_ = false;
+    boost::asio::post(socket_.get_executor(), [self = shared_from_this()]{
+        if (self->socket_.is_open()) {
+            self->process(0, self->used_); // What was kept can hold whole messages, so all of it gets scanned
+        }
+    });
+}
+
+void Session::queue(std::string_view bytes){
+    if (!socket_.is_open()) {
+        return;
+    }
+    if (sendBuffer_.empty()) {
+        sendBuffer_.resize(server_.config_.sendBufferSize);
+    }
+    const size_t capacity {sendBuffer_.size()};
+    if (bytes.size() > capacity - sendSize_) {
+        // Not reading what it's sent, holding on to more would only grow without bound
+        ++server_.stats_.slowConsumers;
+        server_.remove(id_);
+        return;
+    }
+
+    // Up to the end of the ring, then the rest from the front
+    const size_t tail {(sendHead_ + sendSize_) % capacity};
+    const size_t first {std::min(bytes.size(), capacity - tail)};
+    std::memcpy(sendBuffer_.data() + tail, bytes.data(), first);
+    std::memcpy(sendBuffer_.data(), bytes.data() + first, bytes.size() - first);
+    sendSize_ += bytes.size();
+
+    if (!dirty_) {
+        dirty_ = true;
+        server_.dirty_.push_back(shared_from_this());
+    }
+}
+
+void Session::flush(){
+    dirty_ = false;
+    write();
+}
+
+void Session::write(){
+    if (sendInFlight_ > 0 || sendSize_ == 0 || !socket_.is_open()) {
+        return; // onWrite picks up the rest
+    }
+    const size_t capacity {sendBuffer_.size()};
+    const size_t first {std::min(sendSize_, capacity - sendHead_)};
+    const std::array<boost::asio::const_buffer, 2> buffers {
+        boost::asio::const_buffer{sendBuffer_.data() + sendHead_, first},
+        boost::asio::const_buffer{sendBuffer_.data(), sendSize_ - first},
+    };
+    sendInFlight_ = sendSize_;
+    boost::asio::async_write(socket_, buffers, [self = shared_from_this()](const boost::system::error_code& error, size_t bytes){
+        self->onWrite(error, bytes);
+    });
+}
+
+void Session::onWrite(const boost::system::error_code& error, size_t bytes){
+    sendInFlight_ = 0;
+    if (error) {
+        server_.remove(id_); // The read side may find out too, removing twice is fine
+        return;
+    }
+    ++server_.stats_.writes;
+    server_.stats_.bytesSent += bytes;
+    sendHead_ = (sendHead_ + bytes) % sendBuffer_.size();
+    sendSize_ -= bytes;
+    write();
+}
+
+OrderEntryServer::OrderEntryServer(boost::asio::io_context& ioContext, const OrderEntryConfig& config, MessageHandler handler)
+: config_{config}
+, acceptor_{ioContext, tcp::endpoint(boost::asio::ip::make_address(config.address), config.port)}
+, handler_{std::move(handler)}
+, sessions_{}
+, dirty_{}
+, nextSessionId_{1}
+, stats_{}
+{
+    accept();
+}
+
+OrderEntryServer::~OrderEntryServer(){
+    stop();
+}
+
+void OrderEntryServer::accept(){
+    acceptor_.async_accept([this](const boost::system::error_code& error, tcp::socket socket){
+        if (error == boost::asio::error::operation_aborted || !acceptor_.is_open()) {
+            return; // Stopped
+        }
+        if (!error) {
+            if (sessions_.size() >= config_.maxSessions) {
+                ++stats_.sessionsRefused;
+                boost::system::error_code ignored;
+                socket.close(ignored);
+            } else {
+                boost::system::error_code ignored;
+                socket.set_option(tcp::no_delay{true}, ignored);
+                if (nextSessionId_ == 0) {
+                    nextSessionId_ = 1; // Wrapped around, 0 means no session
+                }
+                const SessionId id {nextSessionId_++};
+                auto session {std::make_shared<Session>(*this, std::move(socket), id, config_.receiveBufferSize)};
+                sessions_.emplace(id, session);
+                ++stats_.sessionsAccepted;
+                session->start();
+            }
+        }
+        // Errors like running out of file descriptors only cost that one connection
+        accept();
+    });
+}
+
+void OrderEntryServer::remove(SessionId id){
+    auto it {sessions_.find(id)};
+    if (it == sessions_.end()) {
+        return; // Already closed
+    }
+    std::shared_ptr<Session> session {std::move(it->second)};
+    sessions_.erase(it);
+    session->close();
+    ++stats_.sessionsClosed;
+}
+
+void OrderEntryServer::stop(){
+    boost::system::error_code ignored;
+    acceptor_.close(ignored);
+    for (auto& [id, session] : sessions_) {
+        session->close();
+        ++stats_.sessionsClosed;
+    }
+    sessions_.clear();
+    dirty_.clear();
+}
+
+void OrderEntryServer::send(SessionId id, std::string_view bytes){
+    if (auto it = sessions_.find(id); it != sessions_.end()) {
+        it->second->queue(bytes);
+    }
+}
+
+void OrderEntryServer::release(SessionId id, uint32_t credits){
+    if (auto it = sessions_.find(id); it != sessions_.end()) {
+        it->second->release(credits);
+    }
+}
+
+void OrderEntryServer::flush(){
+    for (const std::shared_ptr<Session>& session : dirty_) {
+        session->flush();
+    }
+    dirty_.clear();
+}
+
+uint16_t OrderEntryServer::getPort() const {
+    return acceptor_.local_endpoint().port();
+}
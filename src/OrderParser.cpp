@@ -0,0 +1,207 @@
+#include "OrderParser.h"
+
+#include <array>
+#include <charconv>
+#include <utility>
+
+namespace {
+
+enum class Verb : uint8_t
+{
+    Buy,
+    Sell,
+    Cancel,
+    Modify
+};
+
+constexpr std::array<std::pair<std::string_view, Verb>, 4> verbs {{
+    {"BUY", Verb::Buy},
+    {"SELL", Verb::Sell},
+    {"CANCEL", Verb::Cancel},
+    {"MODIFY", Verb::Modify},
+}};
+
+constexpr std::array<std::pair<std::string_view, OrderType>, 5> orderTypes {{
+    {"LIMIT", OrderType::Limit},
+    {"MARKET", OrderType::Market},
+    {"IOC", OrderType::ImmediateOrCancel},
+    {"POST", OrderType::PostOnly},
+    {"FOK", OrderType::FillOrKill},
+}};
+
+// A handful of entries, comparing lengths first rules most of them out without touching the bytes
+template <typename Value, size_t N>
+[[nodiscard]] bool lookup(const std::array<std::pair<std::string_view, Value>, N>& table, std::string_view word, Value& value) noexcept {
+    for (const auto& [name, entry] : table) {
+        if (name.size() == word.size() && name == word) {
+            value = entry;
+            return true;
+        }
+    }
+    return false;
+}
+
+[[nodiscard]] constexpr bool isSpace(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Hands out the words of a message as views into it
+class Words{
+    private:
+        const char* position_;
+        const char* end_;
+
+    public:
+        explicit Words(std::string_view message) noexcept
+        : position_{message.data()}
+        , end_{message.data() + message.size()}
+        {}
+
+        [[nodiscard]] bool next(std::string_view& word) noexcept {
+            while (position_ != end_ && isSpace(*position_)) {
+                ++position_;
+            }
+            if (position_ == end_) {
+                return false;
+            }
+            const char* start {position_};
+            while (position_ != end_ && !isSpace(*position_)) {
+                ++position_;
+            }
+            word = {start, static_cast<size_t>(position_ - start)};
+            return true;
+        }
+
+        [[nodiscard]] bool done() noexcept {
+            std::string_view ignored;
+            return !next(ignored);
+        }
+};
+
+// Unsigned decimal only, from_chars already refuses signs, overflow and empty input
+template <typename T>
+[[nodiscard]] bool parseNumber(std::string_view word, T& value) noexcept {
+    const char* const end {word.data() + word.size()};
+    const auto [stop, error] {std::from_chars(word.data(), end, value)};
+    return error == std::errc{} && stop == end;
+}
+
+[[nodiscard]] ParseError parsePriceAndQuantity(Words& words, Price& price, Quantity& quantity) noexcept {
+    std::string_view word;
+    if (!words.next(word)) {
+        return ParseError::MissingField;
+    }
+    if (!parseNumber(word, price)) {
+        return ParseError::BadPrice;
+    }
+    if (!words.next(word)) {
+        return ParseError::MissingField;
+    }
+    if (!parseNumber(word, quantity) || quantity == 0) {
+        return ParseError::BadQuantity;
+    }
+    return ParseError::None;
+}
+
+[[nodiscard]] ParseError parseOrderId(Words& words, OrderId& orderId) noexcept {
+    std::string_view word;
+    if (!words.next(word)) {
+        return ParseError::MissingField;
+    }
+    return parseNumber(word, orderId) ? ParseError::None : ParseError::BadOrderId;
+}
+
+}
+
+bool isValidSymbol(std::string_view symbol) noexcept {
+    if (symbol.size() > maxSymbolLength) {
+        return false;
+    }
+    for (const char c : symbol) {
+        if (c <= ' ' || c > '~') {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view toString(ParseError error) noexcept {
+    switch (error) {
+        case ParseError::None:               return "ok";
+        case ParseError::Empty:              return "empty message";
+        case ParseError::UnknownVerb:        return "unknown verb";
+        case ParseError::UnknownOrderType:   return "unknown order type";
+        case ParseError::MissingField:       return "missing field";
+        case ParseError::BadPrice:           return "bad price";
+        case ParseError::BadQuantity:        return "bad quantity";
+        case ParseError::BadOrderId:         return "bad order id";
+        case ParseError::TrailingInput:      return "trailing input";
+        case ParseError::SymbolTooLong:      return "symbol too long";
+        case ParseError::BadLength:          return "bad length";
+        case ParseError::UnknownMessageType: return "unknown message type";
+        case ParseError::BadSide:            return "bad side";
+        case ParseError::BadSymbol:          return "bad symbol";
+        case ParseError::TooLong:            return "too long";
+    }
+    return "unknown error";
+}
+
+ParseError parseMessage(std::string_view message, ParsedMessage& parsed) noexcept {
+    Words words{message};
+    std::string_view word;
+    if (!words.next(word)) {
+        return ParseError::Empty;
+    }
+
+    // The first word is either the verb or a symbol followed by the verb
+    Verb verb{};
+    parsed.symbol = {};
+    parsed.clientOrderId = 0;
+    if (!lookup(verbs, word, verb)) {
+        if (word.size() > maxSymbolLength) {
+            return ParseError::SymbolTooLong;
+        }
+        if (!isValidSymbol(word)) {
+            return ParseError::BadSymbol;
+        }
+        parsed.symbol = word;
+        if (!words.next(word)) {
+            return ParseError::MissingField;
+        }
+        if (!lookup(verbs, word, verb)) {
+            return ParseError::UnknownVerb;
+        }
+    }
+
+    ParseError error {ParseError::None};
+    switch (verb) {
+        case Verb::Cancel:
+            parsed.kind = MessageKind::Cancel;
+            error = parseOrderId(words, parsed.orderId);
+            break;
+        case Verb::Modify:
+            parsed.kind = MessageKind::Modify;
+            error = parseOrderId(words, parsed.orderId);
+            if (error == ParseError::None) {
+                error = parsePriceAndQuantity(words, parsed.price, parsed.quantity);
+            }
+            break;
+        case Verb::Buy:
+        case Verb::Sell:
+            parsed.kind = MessageKind::NewOrder;
+            parsed.side = verb == Verb::Buy ? Side::Buy : Side::Sell;
+            if (!words.next(word)) {
+                return ParseError::MissingField;
+            }
+            if (!lookup(orderTypes, word, parsed.type)) {
+                return ParseError::UnknownOrderType;
+            }
+            error = parsePriceAndQuantity(words, parsed.price, parsed.quantity);
+            break;
+    }
+
+    if (error != ParseError::None) {
+        return error;
+    }
+    return words.done() ? ParseError::None : ParseError::TrailingInput;
+}
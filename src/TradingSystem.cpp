@@ -1,97 +1,644 @@
 #include "TradingSystem.h"
 
+namespace {
+
+// A command the Sequencer made out of a client's, reports about it go to the same session
+[[nodiscard]] Command withOrigin(Command command, const Command& origin) noexcept {
+    command.server = origin.server;
+    command.session = origin.session;
+    return command;
+}
+
+}
+
 void TradingSystem::startServer(){
+    orderEntry_ = std::make_unique<OrderEntryServer>(ioContext_, orderEntryConfig_, [this](Session& session, std::string_view message){
+        handleOrderEntry(session.getId(), session.getMessageCount(), message);
+    });
+    binaryEntry_ = std::make_unique<OrderEntryServer>(ioContext_, binaryEntryConfig_, [this](Session& session, std::string_view message){
+        handleBinaryEntry(session.getId(), message);
+    });
+    binaryListeningPort_.store(binaryEntry_->getPort(), std::memory_order_release);
+    listeningPort_.store(orderEntry_->getPort(), std::memory_order_release);
 
-    try{
-        uint16_t port {1030};
-        boost::asio::io_context ioContext;
-        tcp::acceptor acceptor{ioContext, tcp::endpoint(tcp::v4(), port)};
-        for (;;)
-            {
-                // Create a socket 
-                tcp::socket socket(acceptor.get_executor());
+    ioContext_.run();
 
-                // Wait until someone connects 
-                acceptor.accept(socket);
+    // Closing the sessions cancels their reads, those handlers still get to run before the servers go away
+    listeningPort_.store(0, std::memory_order_release);
+    binaryListeningPort_.store(0, std::memory_order_release);
+    orderEntry_->stop();
+    binaryEntry_->stop();
+    ioContext_.restart();
+    ioContext_.poll();
+    orderEntry_.reset();
+    binaryEntry_.reset();
+    ioContext_.restart();
+}
 
-                std::array<char, 128> buf;
-                boost::system::error_code error;
+void TradingSystem::stopServer(){
+    ioContext_.stop();
+}
 
-                // Read some data into buffer
-                size_t len = socket.read_some(boost::asio::buffer(buf), error);
+// One complete command off a session, still pointing into the session's receive buffer
+// One that doesn't fit a Command is cut short and only used to answer it
+void TradingSystem::handleOrderEntry(SessionId session, uint32_t sequence, std::string_view message){
+    Command command {Command::makeText(message, sequence)};
+    command.server = textServer;
+    command.session = session;
+    if (!Command::fitsText(message)) {
+        rejectAtEntry(command, RejectReason::Malformed, ParseError::TooLong);
+        return;
+    }
+    admit(command);
+}
 
-                if (error == boost::asio::error::eof)
-                {
-                    // Connection closed cleanly by peer
-                    std::cout << "Connection closed" << std::endl;
-                }
-                else if (error)
-                {
-                    throw boost::system::system_error(error); // Some other error
-                }
+// Framed by its length, decoding waits for the Sequencer like text parsing does
+void TradingSystem::handleBinaryEntry(SessionId session, std::string_view message){
+    Command command {Command::makeBinary(message)};
+    command.server = binaryServer;
+    command.session = session;
+    if (!Command::fitsBinary(message)) {
+        rejectAtEntry(command, RejectReason::Malformed, ParseError::TooLong);
+        return;
+    }
+    admit(command);
+}
 
-                std::string message(buf.data(), len); // std move this into ondata recieved argument 
+// The network thread never waits on the Sequencer, with its lane full the command is answered busy on the spot
+void TradingSystem::admit(const Command& command){
+    if (Pipeline::trySubmit(Stage::Sequencer, 0, command)) {
+        return;
+    }
+    busyAtEntry_.fetch_add(1, std::memory_order_relaxed);
+    rejectAtEntry(command, RejectReason::Busy);
+}
 
-                Pipeline::submit(Stage::Sequencer, [this, movedMessage{std::move(message)}]()
-                                 { handleSequencing(std::string_view(movedMessage)); });
+// Network thread only, the answer goes out without the command ever reaching the Sequencer
+void TradingSystem::rejectAtEntry(const Command& command, RejectReason reason, ParseError parseError){
+    const uint64_t clientOrderId {command.type == CommandType::Text ? command.text.sequence : peekClientOrderId(command.binary.view())};
+    sendReport(ExecutionReport{ReportType::Rejected, reason, parseError, command.server, command.session, clientOrderId, 0, 0, 0, 0, true});
+    if (!reportsPending_.exchange(true, std::memory_order_acq_rel)) {
+        boost::asio::post(ioContext_, [this]{ drainReports(); }); // Flushes it along with whatever else is waiting
+    }
+}
 
+std::optional<SymbolId> TradingSystem::lookupSymbol(std::string_view symbol){
+    if (auto it = symbolIds_.find(symbol); it != symbolIds_.end()) {
+        return it->second;
+    }
+    if (nextSymbolId_ >= shards_.front()->getMaxSymbols()) {
+        return std::nullopt; // Out of symbol ids
+    }
+    const SymbolId id {nextSymbolId_++};
+    symbolIds_.emplace(symbol, id);
+    if (symbolLog_.is_open()) {
+        symbolLog_ << id << ' ' << symbol << std::endl; // Before any order for it can reach the journal
+    }
+    return id;
+}
+
+void TradingSystem::recover(const TradingSystemConfig& config){
+    const std::string& path {config.journal.path};
+    const std::string symbolsPath {path + ".symbols"};
+    if (!config.recover || config.journal.truncate) {
+        symbolLog_.open(symbolsPath, std::ios::trunc);
+        return;
+    }
+
+    loadSymbols(symbolsPath);
+    symbolLog_.open(symbolsPath, std::ios::app);
+
+    // Level updates recorded while replaying are thrown away as it goes, the publisher gets one snapshot at the end
+    const ReplayStats stats {replayJournal(path, [this](SymbolId symbol) -> OrderBook& {
+        OrderBook& orderBook {shards_[shardFor(symbol)]->getBook(symbol)};
+        orderBook.clearLevelUpdates();
+        return orderBook;
+    })};
+    nextOrderId_ = std::max<OrderId>(nextOrderId_, stats.lastOrderId + 1);
+
+    for (auto& books : shards_) {
+        books->forEachBook([this](SymbolId symbol, OrderBook& orderBook){
+            orderBook.clearLevelUpdates();
+            if (publisher_ != nullptr) {
+                orderBook.forEachLevel([this, symbol](const LevelUpdate& level){
+                    publisher_->update(symbol, level.side, level.price, level.quantity);
+                });
             }
+        });
+    }
+
+    if (stats.records > 0) {
+        std::cout << std::format("Recovered {} orders, {} cancels, {} modifies ({} records) from {} in {} ms, next order id {}\n",
+            stats.newOrders, stats.cancels, stats.modifies, stats.records, path,
+            std::chrono::duration_cast<std::chrono::milliseconds>(stats.elapsed).count(), nextOrderId_);
+    }
+    if (stats.mismatches > 0 || stats.stoppedAtGap) {
+        std::cerr << std::format("Journal {} doesn't replay cleanly: {} commands didn't come out as they did live{}\n",
+            path, stats.mismatches, stats.stoppedAtGap ? ", stopped at a sequence gap" : "");
+    }
+}
+
+// One "<id> <name>" per line, exactly as lookupSymbol writes it. A line that isn't (cut short by a crash, edited by
+// hand) is skipped with a warning, its id is still never handed out again
+void TradingSystem::loadSymbols(const std::string& path){
+    std::ifstream file{path};
+    std::string line;
+    for (size_t number {1}; std::getline(file, line); ++number) {
+        const std::string_view text {line};
+        const size_t space {text.find(' ')};
+        const std::string_view idText {text.substr(0, space)};
+        SymbolId id {};
+        const auto [end, error] {std::from_chars(idText.data(), idText.data() + idText.size(), id)};
+        if (error != std::errc{} || end != idText.data() + idText.size() || id >= shards_.front()->getMaxSymbols()) {
+            std::cerr << std::format("Skipping line {} of {}, no usable symbol id\n", number, path);
+            continue;
+        }
+        nextSymbolId_ = std::max<SymbolId>(nextSymbolId_, id + 1);
+
+        const std::string_view symbol {space == std::string_view::npos ? std::string_view{} : text.substr(space + 1)};
+        if (symbol.empty() || !isValidSymbol(symbol)) {
+            std::cerr << std::format("Skipping line {} of {}, bad symbol for id {}\n", number, path, id);
+            continue;
+        }
+        symbolIds_[std::string{symbol}] = id;
+    }
+}
+
+void TradingSystem::handleMessage(const Stage& stage, size_t lane, const Command& command){
+    // Matching's commands are passed on to the Logger as is once they're accepted, so the stage decides first
+    if (stage == Stage::Logger) {
+        handleLogging(command);
+        return;
     }
-    catch (std::exception &e){
-        std::cerr << e.what();
-        std::abort();
+    switch (command.type) {
+        case CommandType::Text:        handleText(command); break;
+        case CommandType::Binary:      handleBinary(command); break;
+        case CommandType::NewOrder:    handleMatching(lane, command); break;
+        case CommandType::Cancel:      matchNewOrders(lane); handleCancel(lane, command); break;
+        case CommandType::Modify:      matchNewOrders(lane); handleModify(lane, command); break;
+        case CommandType::TradeReport:
+        case CommandType::LevelUpdate:
+        case CommandType::RejectedOrder: break;
     }
-    // take in a tcp connection 
-    // pass connection to a sequencer to handle creating an order through queue
 }
 
-void TradingSystem::handleSequencing(std::string_view message) {
+// Parsed in place from the command's own bytes, turned down messages say why (to the client, or here without one)
+// Text clients don't send an id of their own, reports about the command quote its number on the session instead
+void TradingSystem::handleText(const Command& command) {
+    ParsedMessage parsed{};
+    const ParseError error {parseMessage(command.text.view(), parsed)};
+    parsed.clientOrderId = command.text.sequence;
+    if (error != ParseError::None) {
+        if (command.session == 0) {
+            std::cerr << std::format("Rejected \"{}\": {}\n", command.text.view(), toString(error));
+        }
+        reject(command, parsed, RejectReason::Malformed, error);
+        return;
+    }
+    handleSequencing(command, parsed);
+}
+
+void TradingSystem::handleBinary(const Command& command) {
+    ParsedMessage parsed{};
+    if (const ParseError error {decodeBinary(command.binary.view(), parsed)}; error != ParseError::None) {
+        if (command.session == 0) {
+            std::cerr << std::format("Rejected binary message of {} bytes: {}\n", command.binary.length, toString(error));
+        }
+        reject(command, parsed, RejectReason::Malformed, error);
+        return;
+    }
+    handleSequencing(command, parsed);
+}
+
+// Text and binary orders are the same from here on
+void TradingSystem::handleSequencing(const Command& command, const ParsedMessage& parsed) {
+    // Without a symbol the order goes to the default book (symbol 0)
+    SymbolId symbol {0};
+    if (!parsed.symbol.empty()) {
+        std::optional<SymbolId> id {lookupSymbol(parsed.symbol)};
+        if (!id) {
+            std::cerr << std::format("Dropping order, no symbol ids left for {}\n", parsed.symbol);
+            reject(command, parsed, RejectReason::NoSymbols);
+            return;
+        }
+        symbol = *id;
+    }
+    const size_t shard {shardFor(symbol)};
+    if (shed(shard, parsed.kind)) {
+        busyAtSequencer_.fetch_add(1, std::memory_order_relaxed);
+        reject(command, parsed, RejectReason::Busy);
+        return;
+    }
+    if (journalFailing_.load(std::memory_order_relaxed)) {
+        reject(command, parsed, RejectReason::JournalFailing);
+        return;
+    }
+
+    // Pass to the matching shard that owns the symbol
+    switch (parsed.kind) {
+        case MessageKind::Cancel:
+            Pipeline::submit(Stage::Matching, shard, withOrigin(Command::makeCancel(CancelCommand{symbol, parsed.orderId, parsed.clientOrderId}), command));
+            break;
+        case MessageKind::Modify:
+            Pipeline::submit(Stage::Matching, shard, withOrigin(Command::makeModify(ModifyCommand{symbol, parsed.orderId, parsed.price, parsed.quantity, parsed.clientOrderId}), command));
+            break;
+        case MessageKind::NewOrder:
+            Pipeline::submit(Stage::Matching, shard, withOrigin(Command::makeNewOrder(NewOrderCommand{symbol, nextOrderId_++, parsed.side, parsed.type, parsed.price, parsed.quantity, parsed.clientOrderId}), command));
+            break;
+    }
+}
 
-    std::cout << "Sequencer got: " << message << "\n";
+// Depth is checked per command, it only reads the lane's indices. Between the two marks the lane keeps its state so
+// a lane hovering around one of them doesn't flip on every command
+bool TradingSystem::shed(size_t shard, MessageKind kind){
+    if (admission_.policy == ShedPolicy::None) {
+        return false;
+    }
+    const size_t depth {Pipeline::getQueueDepth(Stage::Matching, shard)};
+    if (depth >= highWater_) {
+        shedding_[shard] = 1;
+    } else if (depth <= lowWater_) {
+        shedding_[shard] = 0;
+    }
+    return shedding_[shard] != 0 && (admission_.policy == ShedPolicy::AllCommands || kind == MessageKind::NewOrder);
+}
 
-    // Chatted this since I don't know how to break up a string 
-    // Not the most efficient use, since I'm copying and probably not using sso so I'm defeating he whole point of string view but oh well
-    try {
-        // 1. Setup stream for parsing
-        std::stringstream ss{ std::string(message) };
-        std::string sideStr, typeStr;
-        Price price;
-        Quantity qty;
+// Queued rather than matched right away so a run of new orders for one book goes through processOrders together
+void TradingSystem::handleMatching(size_t shard, const Command& command){
+    std::vector<Command>& pending {batches_[shard].newOrders};
+    if (!pending.empty() && pending.front().newOrder.symbol != command.newOrder.symbol) {
+        matchNewOrders(shard);
+    }
+    pending.push_back(command);
+}
 
-        // Format: BUY LIMIT 100 50 
-        // "I want to create a buy limit order for 100 dollars with a qty of 50" 
-        if (!(ss >> sideStr >> typeStr >> price >> qty)) {
-            return; 
+// Keeps the stage's order of events, anything that isn't a new order matches what's queued first
+void TradingSystem::matchNewOrders(size_t shard){
+    ShardBatch& batch {batches_[shard]};
+    if (batch.newOrders.empty()) {
+        return;
+    }
+    const SymbolId symbol {batch.newOrders.front().newOrder.symbol};
+    OrderBook& orderBook {shards_[shard]->getBook(symbol)};
+
+    batch.orders.clear();
+    for (const Command& command : batch.newOrders) {
+        const NewOrderCommand& newOrder {command.newOrder};
+        batch.orders.emplace_back(newOrder.side, newOrder.price, newOrder.orderId, newOrder.type, newOrder.quantity, newOrder.quantity);
+        // In before matching so fills against it find their way back
+        if (command.session != 0) {
+            shardOrders_[shard]->owners.emplace(newOrder.orderId, OrderOwner{command.server, command.session, newOrder.clientOrderId, newOrder.quantity});
         }
+    }
+    batch.results.resize(batch.orders.size());
+    (void)orderBook.processOrders(batch.orders, batch.results);
 
-        Side side {(sideStr == "BUY") ? Side::Buy : Side::Sell};
-        OrderType type {(typeStr == "LIMIT") ? OrderType::Limit : OrderType::Market};
+    size_t fill {0};
+    for (size_t i {}; i < batch.newOrders.size(); ++i) {
+        const Command& command {batch.newOrders[i]};
+        // Turned down orders are journaled too, they used up an id the client saw and left a status behind
+        if (batch.results[i].accepted) {
+            markUpdated(shard, symbol);
+            journal(shard, Command::makeNewOrder(command.newOrder));
+        } else {
+            journal(shard, Command::makeRejectedOrder(command.newOrder));
+        }
+        if (command.session != 0) {
+            reportNewOrder(shard, command, batch.results[i], fill);
+        }
+    }
+    shardOrders_[shard]->fills.clear();
+    batch.newOrders.clear();
+}
 
-        OrderId id {nextOrderId_++};
-        Quantity initQty {qty};
-        Quantity remQty {qty};
+void TradingSystem::handleCancel(size_t shard, const Command& command){
+    const CancelCommand& cancel {command.cancel};
+    OrderBook* orderBook {shards_[shard]->findBook(cancel.symbol)};
+    const bool cancelled {orderBook != nullptr && orderBook->cancelOrder(cancel.orderId)};
+    if (cancelled) {
+        markUpdated(shard, cancel.symbol);
+        journal(shard, Command::makeCancel(cancel));
+        shardOrders_[shard]->owners.erase(cancel.orderId);
+    }
 
-        // 4. Construct the Order object 
-        Order newOrder{ side, price, id, type, initQty, remQty };
+    ExecutionReport answer {ReportType::Rejected, RejectReason::UnknownOrder, ParseError::None, command.server, command.session, cancel.clientOrderId, cancel.orderId, 0, 0, 0, true};
+    if (cancelled) {
+        const OrderStatus status {orderBook->reviewOrderStatus(cancel.orderId)};
+        answer.type = ReportType::Cancelled;
+        answer.reason = RejectReason::None;
+        answer.price = status.price;
+        answer.quantity = status.remainingQuantity;
+    }
+    report(shard, answer);
+}
 
-        // 5. Pass to matching stage
-        Pipeline::submit(Stage::Matching, [this, copiedOrder {newOrder}]() mutable { // Realized Order is just a bunch of PODs so moving would have no benefit 
-            handleMatching(copiedOrder);
-        });
+void TradingSystem::handleModify(size_t shard, const Command& command){
+    const ModifyCommand& modify {command.modify};
+    OrderBook* orderBook {shards_[shard]->findBook(modify.symbol)};
+
+    // Fills while it crosses come off the new quantity
+    auto& owners {shardOrders_[shard]->owners};
+    const auto owner {owners.find(modify.orderId)};
+    const Quantity previousLeaves {owner != owners.end() ? owner->second.leaves : 0};
+    if (owner != owners.end()) {
+        owner->second.leaves = modify.quantity;
+    }
+
+    const bool modified {orderBook != nullptr && orderBook->modifyOrder(modify.orderId, modify.quantity, modify.price)};
+    if (modified) {
+        markUpdated(shard, modify.symbol);
+        journal(shard, Command::makeModify(modify));
+    } else if (owner != owners.end()) {
+        owner->second.leaves = previousLeaves;
+    }
+
+    ExecutionReport answer {ReportType::Modified, RejectReason::None, ParseError::None, command.server, command.session, modify.clientOrderId, modify.orderId, modify.price, modify.quantity, modify.quantity, true};
+    if (!modified) {
+        const bool resting {orderBook != nullptr && orderBook->reviewOrderStatus(modify.orderId).state == OrderState::Processing};
+        answer.type = ReportType::Rejected;
+        answer.reason = resting ? RejectReason::Refused : RejectReason::UnknownOrder;
+        answer.leaves = 0;
+    }
+    report(shard, answer);
+    sendFills(shard);
+
+    if (modified && owner != owners.end() && orderBook->reviewOrderStatus(modify.orderId).state != OrderState::Processing) {
+        owners.erase(owner); // Filled completely while it crossed
+    }
+}
+
+// The ack goes first, then what it traded, then what expired of it. Orders that don't rest are forgotten right away
+// fill walks the batch's fills, they come in the same order as the orders that made them
+void TradingSystem::reportNewOrder(size_t shard, const Command& command, const OrderResult& result, size_t& fill){
+    const NewOrderCommand& newOrder {command.newOrder};
+    ExecutionReport ack {ReportType::Accepted, RejectReason::None, ParseError::None, command.server, command.session,
+        newOrder.clientOrderId, newOrder.orderId, newOrder.price, newOrder.quantity, newOrder.quantity, true};
+
+    if (!result.accepted) {
+        // An IOC or market order with nothing to trade against expires, anything else the book didn't take is a reject
+        ack.type = result.state == OrderState::Expired ? ReportType::Expired : ReportType::Rejected;
+        ack.reason = ack.type == ReportType::Rejected ? RejectReason::Refused : RejectReason::None;
+        ack.leaves = 0;
+        report(shard, ack);
+    } else {
+        report(shard, ack);
+        const auto& fills {shardOrders_[shard]->fills};
+        for (; fill < fills.size() && fills[fill].taker == newOrder.orderId; ++fill) {
+            report(shard, fills[fill].report);
+        }
+        if (result.state == OrderState::Expired) {
+            ExecutionReport expired {ack};
+            expired.type = ReportType::Expired;
+            expired.quantity = newOrder.quantity - result.filledQuantity;
+            expired.leaves = 0;
+            expired.answer = false;
+            report(shard, expired);
+        }
+    }
+
+    if (result.state != OrderState::Processing) {
+        shardOrders_[shard]->owners.erase(newOrder.orderId);
+    }
+}
+
+// Trade sink, runs inside processOrders / modifyOrder. Fills wait for the taker's ack, see ShardOrders::fills
+void TradingSystem::reportFills(size_t shard, const Trade& trade){
+    ShardOrders& orders {*shardOrders_[shard]};
+    if (orders.owners.empty()) {
+        return;
+    }
+
+    if (auto taker = orders.owners.find(trade.getTakerOrderId()); taker != orders.owners.end()) {
+        OrderOwner& owner {taker->second};
+        owner.leaves -= std::min(owner.leaves, trade.getQuantity());
+        orders.fills.push_back({trade.getTakerOrderId(), ExecutionReport{ReportType::Fill, RejectReason::None, ParseError::None, owner.server,
+            owner.session, owner.clientOrderId, trade.getTakerOrderId(), trade.getPrice(), trade.getQuantity(), owner.leaves, false}});
+    }
+    if (auto maker = orders.owners.find(trade.getMakerOrderId()); maker != orders.owners.end()) {
+        OrderOwner& owner {maker->second};
+        owner.leaves -= std::min(owner.leaves, trade.getQuantity());
+        orders.fills.push_back({trade.getTakerOrderId(), ExecutionReport{ReportType::Fill, RejectReason::None, ParseError::None, owner.server,
+            owner.session, owner.clientOrderId, trade.getMakerOrderId(), trade.getPrice(), trade.getQuantity(), owner.leaves, false}});
+        if (owner.leaves == 0) {
+            orders.owners.erase(maker);
+        }
+    }
+}
+
+void TradingSystem::sendFills(size_t shard){
+    auto& fills {shardOrders_[shard]->fills};
+    for (const auto& fill : fills) {
+        report(shard, fill.report);
+    }
+    fills.clear();
+}
+
+// Reports for nobody (no session) go nowhere
+void TradingSystem::report(size_t lane, const ExecutionReport& report){
+    if (report.session == 0) {
+        return;
+    }
+    ReportLane& reportLane {*reportLanes_[lane]};
+    if (!reportLane.queue.push(report)) {
+        if (!report.answer) {
+            reportsDropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::lock_guard lock{deferredMutex_};
+        deferredReports_.push_back(report);
+        reportsDeferred_.store(true, std::memory_order_release);
+        deferredCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    reportLane.pushed = true;
+}
+
+// Sequencer side, the command never got to a book
+void TradingSystem::reject(const Command& command, const ParsedMessage& parsed, RejectReason reason, ParseError parseError){
+    report(reportLanes_.size() - 1, ExecutionReport{ReportType::Rejected, reason, parseError, command.server, command.session,
+        parsed.clientOrderId, 0, 0, 0, 0, true});
+}
+
+// End of a producer's batch. One post wakes the network thread for however many lanes and batches pile up before it runs
+void TradingSystem::notifyReports(size_t lane){
+    ReportLane& reportLane {*reportLanes_[lane]};
+    if (!reportLane.pushed) {
+        return;
+    }
+    reportLane.pushed = false;
+    if (!reportsPending_.exchange(true, std::memory_order_acq_rel)) {
+        boost::asio::post(ioContext_, [this]{ drainReports(); });
+    }
+}
+
+// Network thread. Everything queued is written into the sessions' send buffers, then each session gets one write
+void TradingSystem::drainReports(){
+    (void)reportsPending_.exchange(false, std::memory_order_acq_rel); // Before popping, a report pushed after this posts again
+    for (auto& lane : reportLanes_) {
+        lane->queue.consume_all([this](const ExecutionReport& report){ sendReport(report); });
+    }
+    if (reportsDeferred_.exchange(false, std::memory_order_acquire)) {
+        std::vector<ExecutionReport> deferred;
+        {
+            std::lock_guard lock{deferredMutex_};
+            deferred.swap(deferredReports_);
+        }
+        for (const ExecutionReport& report : deferred) {
+            sendReport(report);
+        }
+    }
+    if (orderEntry_ != nullptr) {
+        orderEntry_->flush();
+    }
+    if (binaryEntry_ != nullptr) {
+        binaryEntry_->flush();
+    }
+}
+
+void TradingSystem::sendReport(const ExecutionReport& report){
+    OrderEntryServer* server {report.server == binaryServer ? binaryEntry_.get() : orderEntry_.get()};
+    if (server == nullptr) {
+        return;
+    }
+    if (report.server == binaryServer) {
+        const BinaryReport message {makeBinaryReport(report)};
+        server->send(report.session, asBytes(message));
+    } else {
+        std::array<char, maxTextReportLength> line;
+        const size_t length {formatTextReport(report, line)};
+        server->send(report.session, {line.data(), length});
+    }
+    if (report.answer) {
+        server->release(report.session);
+    }
+}
+
+// A batch mostly hits a handful of symbols so a linear search beats hashing here
+void TradingSystem::markUpdated(size_t shard, SymbolId symbol){
+    if (publisher_ == nullptr) {
+        return;
+    }
+    std::vector<SymbolId>& updated {batches_[shard].updatedSymbols};
+    if (std::find(updated.begin(), updated.end(), symbol) == updated.end()) {
+        updated.push_back(symbol);
+    }
+}
+
+// Only the last total of every level the batch touched goes to the Logger
+void TradingSystem::publishLevels(size_t shard, SymbolId symbol, OrderBook& orderBook){
+    std::vector<LevelUpdate>& levels {batches_[shard].levels};
+    const std::span<const LevelUpdate> updates {orderBook.getLevelUpdates()};
+    levels.assign(updates.begin(), updates.end());
+    std::stable_sort(levels.begin(), levels.end(), [](const LevelUpdate& a, const LevelUpdate& b){
+        return a.side != b.side ? a.side < b.side : a.price < b.price;
+    });
+
+    for (size_t i {}; i < levels.size(); ++i) {
+        const bool lastOfLevel {i + 1 == levels.size() || levels[i + 1].side != levels[i].side || levels[i + 1].price != levels[i].price};
+        if (lastOfLevel) {
+            toLogger(shard, Command::makeLevelUpdate(symbol, levels[i].side, levels[i].price, levels[i].quantity));
+        }
+    }
+    orderBook.clearLevelUpdates();
+}
+
+// Accepted commands go to this shard's Logger lane, matching only waits on the file once the lane is full
+// Trades an order caused were sent by the trade sink already so they come right before the order in the journal
+void TradingSystem::journal(size_t shard, const Command& command){
+    if (journal_ != nullptr) {
+        toLogger(shard, command);
+    }
+}
 
-    } catch (...) {
-        // TODO see if you can try again         
+// Nothing bound for the Logger can be dropped, a full lane is counted and then waited out
+void TradingSystem::toLogger(size_t shard, const Command& command){
+    if (!Pipeline::trySubmit(Stage::Logger, shard, command)) {
+        loggerStalls_.fetch_add(1, std::memory_order_relaxed);
+        Pipeline::submit(Stage::Logger, shard, command);
     }
 }
 
-// [NOTE]: Later down the road I could remove this function and just simply call process order directly but for better 
-//         readability this will do for now  
-void TradingSystem::handleMatching(Order order){ 
-    //orderBook_.processOrder(order);
-    // submit orderbooks trade to handle logging through queue 
+// Each book changed during the matching batch sends one conflated set of level updates however many orders hit it
+// A Logger batch is one group commit of the journal and one market data publish, the last one before the Logger
+// runs dry also syncs what an Interval commit left behind
+void TradingSystem::handleBatchEnd(const Stage& stage, size_t lane){
+    if (stage == Stage::Logger) {
+        if (journal_ != nullptr) {
+            try {
+                journal_->commit();
+                if (Pipeline::isStageIdle(Stage::Logger)) {
+                    journal_->idle();
+                }
+                if (journalFailing_.exchange(false, std::memory_order_relaxed)) {
+                    std::cerr << "Journal commits work again, taking orders\n";
+                }
+            } catch (const std::exception& e) {
+                journalFailed(e); // Records stay buffered for the next one
+            }
+        }
+        if (publisher_ != nullptr) {
+            publisher_->publish();
+        }
+        return;
+    }
+    if (stage == Stage::Sequencer) {
+        notifyReports(reportLanes_.size() - 1);
+        return;
+    }
+    matchNewOrders(lane);
+    for (SymbolId symbol : batches_[lane].updatedSymbols) {
+        publishLevels(lane, symbol, shards_[lane]->getBook(symbol));
+    }
+    batches_[lane].updatedSymbols.clear();
+    notifyReports(lane);
+}
+
+void TradingSystem::handleLogging(const Command& command){
+    if (command.type == CommandType::LevelUpdate) {
+        if (publisher_ != nullptr) {
+            const LevelUpdateCommand& level {command.levelUpdate};
+            publisher_->update(level.symbol, level.side, level.price, level.quantity);
+        }
+        return;
+    }
+
+    if (journal_ != nullptr) {
+        if (JournalRecord::isJournaled(command)) {
+            appendToJournal(JournalRecord::fromCommand(command));
+        }
+        return;
+    }
+
+    if (command.type == CommandType::TradeReport) {
+        const TradeReportCommand& trade {command.tradeReport};
+        std::cout << std::format("Trade({}) symbol {} taker {} maker {} {} @ {}\n",
+            trade.tradeId, trade.symbol, trade.takerOrderId, trade.makerOrderId, trade.quantity, trade.price);
+    }
+}
+
+// Matching acknowledged whatever comes through here, so it's never dropped. append only touches the disk when every
+// buffer is full and when that commit fails the record is tried again after a pause. That holds up the Logger, its
+// lanes fill and matching waits (loggerStalls) while the Sequencer turns new commands down. Only a shutdown gives up
+void TradingSystem::appendToJournal(const JournalRecord& record){
+    constexpr std::chrono::milliseconds maxPause {100};
+    for (std::chrono::milliseconds pause {1};; pause = std::min(pause * 2, maxPause)) {
+        try {
+            journal_->append(record);
+            return;
+        } catch (const std::exception& e) {
+            journalFailed(e);
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            std::cerr << std::format("Shutting down with the journal failing, record for order {} is lost\n", record.orderId);
+            return;
+        }
+        std::this_thread::sleep_for(pause);
+    }
+}
 
-    if (orderBook_.processOrder(order)) {
-        // Simple way: display after every successfully processed order
-        orderBook_.display();
+// Logger thread only, tells about the failure once and not again until a commit has worked
+void TradingSystem::journalFailed(const std::exception& error){
+    journalFailures_.fetch_add(1, std::memory_order_relaxed);
+    if (!journalFailing_.exchange(true, std::memory_order_relaxed)) {
+        std::cerr << std::format("Journal commit failed, turning new commands down until it works: {}\n", error.what());
     }
 }
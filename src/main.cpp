@@ -11,8 +11,11 @@
 
 int main() {
     try {
-        TradingSystem tradingSystem{};
-        std::cout << "Trading System Online. Listening on Port 1030..." << std::endl;
+        TradingSystemConfig config{};
+        config.journal.path = "journal.bin"; // Accepted orders, cancels, modifies and trades, appended across restarts
+        config.marketData.socketPath = "marketdata.sock"; // L2 level updates, see MarketDataPublisher.h for the wire format
+        TradingSystem tradingSystem{config};
+        std::cout << "Trading System Online. Listening on Port 1030 (text) and 1031 (binary)..." << std::endl;
         tradingSystem.startServer();
     }
     catch (const std::exception& e) {
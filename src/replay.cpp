@@ -0,0 +1,399 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BookManager.h"
+#include "Journal.h"
+#include "LatencyHistogram.h"
+
+// Usage: replay <order file> [runs] [core]
+// Feeds an order file through OrderBook::processOrder / cancelOrder / modifyOrder in a tight loop, no network,
+// queues or threads. The file is memory mapped and decoded up front so only the book is timed. Every run starts from
+// empty books with the same input so builds can be compared on the same workload, pinning to a core makes it steadier
+//
+// Two input formats, picked by looking at the file:
+//  - a binary journal (journal.bin, see Journal.h), read in place. Trade records are skipped
+//  - text, one command per line, the format of src/data.txt plus cancels and modifies:
+//        [SYMBOL] BUY|SELL <price> <order id> <LIMIT|MARKET|IOC|POST|FOK> <initial qty> <remaining qty>
+//        [SYMBOL] CANCEL <order id>
+//        [SYMBOL] MODIFY <order id> <price> <qty>
+//    Blank lines and lines starting with # are skipped, malformed lines are counted and left out
+//
+// Each run is two passes: one timed as a whole for orders/sec, one timing every operation into histograms
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class MappedFile{
+    private:
+        void* data_;
+        size_t size_;
+
+    public:
+        explicit MappedFile(const std::string& path)
+        : data_{nullptr}
+        , size_{}
+        {
+            const int fd {open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+            if(fd < 0){
+                throw std::system_error(errno, std::generic_category(), std::format("{} could not be opened", path));
+            }
+            struct stat info{};
+            if(fstat(fd, &info) != 0){
+                const int error {errno};
+                close(fd);
+                throw std::system_error(error, std::generic_category(), std::format("{} could not be read", path));
+            }
+            size_ = static_cast<size_t>(info.st_size);
+            if(size_ > 0){
+                data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+            }
+            close(fd);
+            if(data_ == MAP_FAILED){
+                throw std::system_error(errno, std::generic_category(), std::format("{} could not be mapped", path));
+            }
+            if(data_ != nullptr){
+                madvise(data_, size_, MADV_SEQUENTIAL);
+            }
+        }
+
+        ~MappedFile(){
+            if(data_ != nullptr){
+                munmap(data_, size_);
+            }
+        }
+
+        [[nodiscard]] const std::byte* data() const noexcept { return static_cast<const std::byte*>(data_); }
+        [[nodiscard]] size_t size() const noexcept { return size_; }
+
+        // No Copying
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+
+        // No Moving
+        MappedFile(MappedFile&& other) = delete;
+        MappedFile& operator=(MappedFile&& other) = delete;
+};
+
+struct Workload
+{
+    std::span<const JournalRecord> records;
+    std::vector<JournalRecord> decoded;     // Backing store for text files, journals are used straight from the mapping
+    std::vector<bool> symbolsUsed;
+    size_t malformed {};
+};
+
+[[nodiscard]] bool looksLikeJournal(const MappedFile& file){
+    if(file.size() < sizeof(JournalRecord)){
+        return false;
+    }
+    JournalRecord first{};
+    std::memcpy(&first, file.data(), sizeof(first));
+    return first.sequence == 1 && first.type >= JournalRecordType::NewOrder && first.type <= JournalRecordType::Trade;
+}
+
+template <typename T>
+[[nodiscard]] bool parseNumber(std::string_view token, T& value){
+    const auto [end, error] {std::from_chars(token.data(), token.data() + token.size(), value)};
+    return error == std::errc{} && end == token.data() + token.size();
+}
+
+[[nodiscard]] bool parseOrderType(std::string_view token, OrderType& type){
+    if(token == "LIMIT"){ type = OrderType::Limit; return true; }
+    if(token == "MARKET"){ type = OrderType::Market; return true; }
+    if(token == "IOC"){ type = OrderType::ImmediateOrCancel; return true; }
+    if(token == "POST"){ type = OrderType::PostOnly; return true; }
+    if(token == "FOK"){ type = OrderType::FillOrKill; return true; }
+    return false;
+}
+
+// One text line into a record, false when it doesn't make a valid command
+[[nodiscard]] bool parseLine(std::string_view line, std::unordered_map<std::string, SymbolId>& symbols, JournalRecord& record){
+    std::array<std::string_view, 8> tokens{};
+    size_t count {};
+    size_t position {};
+    while(position < line.size()){
+        position = line.find_first_not_of(" \t\r", position);
+        if(position == std::string_view::npos){
+            break;
+        }
+        const size_t end {std::min(line.find_first_of(" \t\r", position), line.size())};
+        if(count == tokens.size()){
+            return false;
+        }
+        tokens[count++] = line.substr(position, end - position);
+        position = end;
+    }
+
+    std::span<const std::string_view> words {tokens.data(), count};
+    record = JournalRecord{};
+    if(words.empty()){
+        return false;
+    }
+    if(words[0] != "BUY" && words[0] != "SELL" && words[0] != "CANCEL" && words[0] != "MODIFY"){
+        // Symbol ids are handed out in the order names first show up, 0 is the book for lines without one
+        const auto [it, inserted] {symbols.try_emplace(std::string{words[0]}, static_cast<SymbolId>(symbols.size() + 1))};
+        record.symbol = it->second;
+        words = words.subspan(1);
+        if(words.empty()){
+            return false;
+        }
+    }
+
+    if(words[0] == "CANCEL"){
+        record.type = JournalRecordType::Cancel;
+        return words.size() == 2 && parseNumber(words[1], record.orderId);
+    }
+    if(words[0] == "MODIFY"){
+        record.type = JournalRecordType::Modify;
+        return words.size() == 4 && parseNumber(words[1], record.orderId) && parseNumber(words[2], record.price) && parseNumber(words[3], record.quantity);
+    }
+
+    OrderType type{};
+    Quantity remaining{};
+    record.type = JournalRecordType::NewOrder;
+    record.side = static_cast<uint8_t>(words[0] == "BUY" ? Side::Buy : Side::Sell);
+    if(words.size() != 6 || !parseNumber(words[1], record.price) || !parseNumber(words[2], record.orderId) || !parseOrderType(words[3], type)
+        || !parseNumber(words[4], record.quantity) || !parseNumber(words[5], remaining)){
+        return false;
+    }
+    record.orderType = static_cast<uint8_t>(type);
+    return record.quantity > 0 && remaining == record.quantity; // What the Order constructor would refuse
+}
+
+void loadWorkload(const MappedFile& file, Workload& workload){
+    if(looksLikeJournal(file)){
+        workload.records = {reinterpret_cast<const JournalRecord*>(file.data()), file.size() / sizeof(JournalRecord)}; // A torn last record is left off
+    } else {
+        std::unordered_map<std::string, SymbolId> symbols;
+        const std::string_view text {reinterpret_cast<const char*>(file.data()), file.size()};
+        size_t start {};
+        while(start < text.size()){
+            const size_t end {std::min(text.find('\n', start), text.size())};
+            const std::string_view line {text.substr(start, end - start)};
+            start = end + 1;
+
+            const size_t first {line.find_first_not_of(" \t\r")};
+            if(first == std::string_view::npos || line[first] == '#'){
+                continue;
+            }
+            JournalRecord record{};
+            if(parseLine(line, symbols, record)){
+                workload.decoded.push_back(record);
+            } else {
+                ++workload.malformed;
+            }
+        }
+        workload.records = workload.decoded;
+    }
+
+    for(const JournalRecord& record : workload.records){
+        if(record.type == JournalRecordType::NewOrder && record.quantity == 0){
+            throw std::runtime_error(std::format("Record {} is an order without a quantity", record.sequence));
+        }
+        if(record.symbol >= workload.symbolsUsed.size()){
+            workload.symbolsUsed.resize(record.symbol + 1);
+        }
+        workload.symbolsUsed[record.symbol] = true;
+    }
+}
+
+struct RunResult
+{
+    uint64_t operations {};
+    uint64_t accepted {};
+    uint64_t turnedDown {};
+    uint64_t trades {};
+    uint64_t restingBids {};
+    uint64_t restingAsks {};
+    std::chrono::nanoseconds elapsed {};
+
+    // Everything that has to come out the same on every run of the same file
+    [[nodiscard]] bool sameOutcome(const RunResult& other) const noexcept {
+        return operations == other.operations && accepted == other.accepted && trades == other.trades
+            && restingBids == other.restingBids && restingAsks == other.restingAsks;
+    }
+};
+
+struct Histograms
+{
+    LatencyHistogram all;
+    LatencyHistogram newOrders;
+    LatencyHistogram cancels;
+    LatencyHistogram modifies;
+};
+
+[[nodiscard]] bool apply(OrderBook& book, const JournalRecord& record){
+    switch(record.type){
+        case JournalRecordType::NewOrder:
+            return book.processOrder(Order(static_cast<Side>(record.side), record.price, record.orderId, static_cast<OrderType>(record.orderType), record.quantity, record.quantity));
+        case JournalRecordType::Cancel:
+            return book.cancelOrder(record.orderId);
+        case JournalRecordType::Modify:
+            return book.modifyOrder(record.orderId, record.quantity, record.price);
+        default:
+            return false;
+    }
+}
+
+// Fresh books for every run, created before the clock starts so arena setup isn't part of the numbers
+template <bool TimeEachOperation>
+[[nodiscard]] RunResult run(const Workload& workload, Histograms* histograms){
+    BookManager books{BookManagerConfig{.maxSymbols = workload.symbolsUsed.size()}};
+    for(SymbolId symbol {}; symbol < workload.symbolsUsed.size(); ++symbol){
+        if(workload.symbolsUsed[symbol]){
+            (void)books.getBook(symbol);
+        }
+    }
+    RunResult result{};
+    books.setTradeSink([&result](SymbolId, const Trade&){ ++result.trades; });
+
+    const auto start {Clock::now()};
+    for(const JournalRecord& record : workload.records){
+        if(record.type == JournalRecordType::Trade){
+            continue;
+        }
+        OrderBook& book {*books.findBook(record.symbol)};
+        bool accepted{};
+        if constexpr (TimeEachOperation){
+            const auto before {Clock::now()};
+            accepted = apply(book, record);
+            const uint64_t latency {static_cast<uint64_t>((Clock::now() - before).count())};
+            histograms->all.record(latency);
+            switch(record.type){
+                case JournalRecordType::NewOrder: histograms->newOrders.record(latency); break;
+                case JournalRecordType::Cancel:   histograms->cancels.record(latency); break;
+                default:                          histograms->modifies.record(latency); break;
+            }
+        } else {
+            accepted = apply(book, record);
+        }
+        ++result.operations;
+        accepted ? ++result.accepted : ++result.turnedDown;
+    }
+    result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+
+    books.forEachBook([&result](SymbolId, OrderBook& book){
+        result.restingBids += book.getQuantityOfBids();
+        result.restingAsks += book.getQuantityOfAsks();
+    });
+    return result;
+}
+
+// Cheapest back to back Clock::now(), part of every per operation number
+[[nodiscard]] uint64_t clockOverhead(){
+    uint64_t best {UINT64_MAX};
+    for(int i {}; i < 10'000; ++i){
+        const auto before {Clock::now()};
+        best = std::min(best, static_cast<uint64_t>((Clock::now() - before).count()));
+    }
+    return best;
+}
+
+void pinToCore(int core){
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    if(int error {pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)}; error != 0){
+        std::cerr << std::format("Could not pin to core {}: {}\n", core, std::strerror(error));
+    }
+}
+
+void printHistogram(std::string_view name, const LatencyHistogram& histogram){
+    if(histogram.getCount() == 0){
+        return;
+    }
+    std::cout << std::format("{:>10} | {:>10} | {:>8.1f} | {:>8} | {:>8} | {:>9} | {:>10}\n", name, histogram.getCount(), histogram.getMean(),
+        histogram.percentile(0.50), histogram.percentile(0.99), histogram.percentile(0.999), histogram.getMax());
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2){
+        std::cerr << "Usage: replay <order file> [runs] [core]\n";
+        return 2;
+    }
+
+    try {
+        const std::string path {argv[1]};
+        const int runs {argc > 2 ? std::max(1, std::stoi(argv[2])) : 5};
+        if(argc > 3){
+            pinToCore(std::stoi(argv[3]));
+        }
+
+        const MappedFile file{path};
+        Workload workload{};
+        loadWorkload(file, workload);
+        std::cout << std::format("{}: {} commands ({} malformed lines left out), {} symbols, {} runs\n",
+            path, workload.records.size(), workload.malformed, workload.symbolsUsed.size(), runs);
+        if(workload.records.empty()){
+            return 0;
+        }
+
+        std::cout << std::format("{:>5} | {:>12} | {:>10} | {:>11} | {:>10} | {:>10}\n", "Run", "Ops/s", "Accepted", "Turned down", "Trades", "Time (ms)");
+        std::cout << std::string(74, '-') << "\n";
+
+        Histograms histograms{};
+        std::vector<double> throughput;
+        RunResult first{};
+        bool deterministic {true};
+        for(int i {}; i < runs; ++i){
+            const RunResult result {run<false>(workload, nullptr)};
+            (void)run<true>(workload, &histograms);
+
+            const double seconds {std::chrono::duration<double>(result.elapsed).count()};
+            throughput.push_back(static_cast<double>(result.operations) / seconds);
+            std::cout << std::format("{:>5} | {:>12.0f} | {:>10} | {:>11} | {:>10} | {:>10.3f}\n",
+                i + 1, throughput.back(), result.accepted, result.turnedDown, result.trades, seconds * 1e3);
+
+            if(i == 0){
+                first = result;
+            } else if(!result.sameOutcome(first)){
+                deterministic = false;
+            }
+        }
+
+        std::sort(throughput.begin(), throughput.end());
+        std::cout << std::format("\nMedian {:.0f} ops/s, best {:.0f} ops/s, resting {} bid / {} ask qty at the end\n",
+            throughput[throughput.size() / 2], throughput.back(), first.restingBids, first.restingAsks);
+
+        std::cout << std::format("\nPer operation latency over all runs (ns, includes ~{} ns of clock overhead)\n", clockOverhead());
+        std::cout << std::format("{:>10} | {:>10} | {:>8} | {:>8} | {:>8} | {:>9} | {:>10}\n", "Operation", "Count", "Mean", "p50", "p99", "p99.9", "Max");
+        std::cout << std::string(80, '-') << "\n";
+        printHistogram("All", histograms.all);
+        printHistogram("New", histograms.newOrders);
+        printHistogram("Cancel", histograms.cancels);
+        printHistogram("Modify", histograms.modifies);
+
+        if(!deterministic){
+            std::cerr << "Runs did not end in the same book state\n";
+            return 1;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Replay failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include "Arena.h"
+
+constexpr size_t TEST_ARENA_SIZE = 8 * 1024 * 1024;
+
+// Test that the mapping is at least as big as asked for and usable
+TEST(ArenaTest, ReservesRequestedSize) {
+    Arena arena{TEST_ARENA_SIZE};
+    ASSERT_NE(arena.data(), nullptr);
+    EXPECT_GE(arena.size(), TEST_ARENA_SIZE);
+
+    arena.data()[0] = std::byte{1};
+    arena.data()[arena.size() - 1] = std::byte{2};
+    EXPECT_EQ(arena.data()[0], std::byte{1});
+    EXPECT_EQ(arena.data()[arena.size() - 1], std::byte{2});
+}
+
+// Reserving without warmup shouldn't fault in the whole thing
+TEST(ArenaTest, LazyArenaDoesNotTouchPages) {
+    Arena arena{TEST_ARENA_SIZE};
+    EXPECT_LT(arena.getStats().minorFaults, static_cast<long>(TEST_ARENA_SIZE / 4096 / 2));
+    EXPECT_FALSE(arena.getStats().locked);
+}
+
+// Prefault should show up as page faults during setup
+TEST(ArenaTest, PrefaultTouchesPages) {
+    Arena arena{TEST_ARENA_SIZE, ArenaPaging::Default, ArenaWarmup::Prefault};
+    EXPECT_GE(arena.getStats().minorFaults + arena.getStats().majorFaults, static_cast<long>(TEST_ARENA_SIZE / 4096 / 2));
+    EXPECT_GT(arena.getStats().setupTime.count(), 0);
+}
+
+// Huge pages may not be reserved on the machine but the arena still has to come up
+TEST(ArenaTest, HugePagesFallBackWhenUnavailable) {
+    Arena arena{TEST_ARENA_SIZE, ArenaPaging::HugePages, ArenaWarmup::None};
+    ASSERT_NE(arena.data(), nullptr);
+    EXPECT_EQ(arena.size() % (2 * 1024 * 1024), 0);
+}
+
+// Locking can be refused by the memlock limit, either way the memory is ready to use
+TEST(ArenaTest, PrefaultAndLockAlwaysWarmsUp) {
+    Arena arena{TEST_ARENA_SIZE, ArenaPaging::Default, ArenaWarmup::PrefaultAndLock};
+    arena.data()[TEST_ARENA_SIZE / 2] = std::byte{3};
+    EXPECT_EQ(arena.data()[TEST_ARENA_SIZE / 2], std::byte{3});
+}
+
+TEST(ArenaTest, ThrowsOnZeroSize) {
+    EXPECT_THROW({
+        Arena arena{0};
+    }, std::invalid_argument);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "BinaryProtocol.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace {
+
+template <typename Message>
+ParseError decode(const Message& message) {
+    ParsedMessage parsed{};
+    return decodeBinary(asBytes(message), parsed);
+}
+
+}
+
+// Test that the wire layout is what the protocol comment says, byte for byte
+TEST(BinaryProtocolTest, LayoutIsLittleEndianAndFixed) {
+    const BinaryNewOrder newOrder = makeBinaryNewOrder(0x0102030405060708, "AAPL", Side::Sell, OrderType::FillOrKill, 0x11223344, 7);
+    const std::string_view bytes = asBytes(newOrder);
+    ASSERT_EQ(bytes.size(), 40);
+    EXPECT_EQ(bytes[0], 40);
+    EXPECT_EQ(bytes[1], 0);
+    EXPECT_EQ(bytes[2], 'O');
+    EXPECT_EQ(bytes[4], 'S');
+    EXPECT_EQ(bytes[5], 'F');
+    EXPECT_EQ(bytes[8], 0x08);
+    EXPECT_EQ(bytes[15], 0x01);
+    EXPECT_EQ(bytes.substr(16, 5), std::string_view("AAPL\0", 5));
+    EXPECT_EQ(bytes[32], 0x44);
+    EXPECT_EQ(bytes[35], 0x11);
+    EXPECT_EQ(bytes[36], 7);
+
+    EXPECT_EQ(asBytes(makeBinaryCancel(1, "", 2))[2], 'X');
+    EXPECT_EQ(asBytes(makeBinaryModify(1, "", 2, 3, 4))[0], 48);
+}
+
+// Test that every message type decodes into the same fields the text parser fills in
+TEST(BinaryProtocolTest, MessagesRoundTrip) {
+    ParsedMessage parsed{};
+    ASSERT_EQ(decodeBinary(asBytes(makeBinaryNewOrder(42, "MSFT", Side::Buy, OrderType::PostOnly, 100, 50)), parsed), ParseError::None);
+    EXPECT_EQ(parsed.kind, MessageKind::NewOrder);
+    EXPECT_EQ(parsed.clientOrderId, 42);
+    EXPECT_EQ(parsed.symbol, "MSFT");
+    EXPECT_EQ(parsed.side, Side::Buy);
+    EXPECT_EQ(parsed.type, OrderType::PostOnly);
+    EXPECT_EQ(parsed.price, 100);
+    EXPECT_EQ(parsed.quantity, 50);
+
+    ASSERT_EQ(decodeBinary(asBytes(makeBinaryCancel(43, "", 18446744073709551615ull)), parsed), ParseError::None);
+    EXPECT_EQ(parsed.kind, MessageKind::Cancel);
+    EXPECT_TRUE(parsed.symbol.empty());
+    EXPECT_EQ(parsed.orderId, 18446744073709551615ull);
+
+    ASSERT_EQ(decodeBinary(asBytes(makeBinaryModify(44, "ABCDEFGHIJKLMNOP", 9, 101, 3)), parsed), ParseError::None);
+    EXPECT_EQ(parsed.kind, MessageKind::Modify);
+    EXPECT_EQ(parsed.symbol, "ABCDEFGHIJKLMNOP");
+    EXPECT_EQ(parsed.orderId, 9);
+    EXPECT_EQ(parsed.price, 101);
+    EXPECT_EQ(parsed.quantity, 3);
+}
+
+// Test that space padding works like zero padding and the symbol is a view into the message
+TEST(BinaryProtocolTest, SymbolPaddingIsCutOff) {
+    BinaryCancel cancel = makeBinaryCancel(1, "", 5);
+    std::memset(cancel.symbol, ' ', sizeof(cancel.symbol));
+    std::memcpy(cancel.symbol, "GOOG", 4);
+    std::string message{asBytes(cancel)};
+
+    ParsedMessage parsed{};
+    ASSERT_EQ(decodeBinary(message, parsed), ParseError::None);
+    EXPECT_EQ(parsed.symbol, "GOOG");
+    EXPECT_EQ(parsed.symbol.data(), message.data() + offsetof(BinaryCancel, symbol));
+}
+
+// Test that only trailing padding is cut off, padding in front or inside and unprintable bytes are a bad symbol
+TEST(BinaryProtocolTest, SymbolsMustBePrintable) {
+    BinaryCancel cancel = makeBinaryCancel(1, "", 5);
+    std::memcpy(cancel.symbol, " GOOG", 5);
+    EXPECT_EQ(decode(cancel), ParseError::BadSymbol);
+
+    cancel = makeBinaryCancel(1, "", 5);
+    std::memcpy(cancel.symbol, "GO\0OG", 5);
+    EXPECT_EQ(decode(cancel), ParseError::BadSymbol);
+
+    EXPECT_EQ(decode(makeBinaryNewOrder(1, "GO OG", Side::Buy, OrderType::Limit, 1, 1)), ParseError::BadSymbol);
+    EXPECT_EQ(decode(makeBinaryModify(1, "GO\x01G", 1, 1, 1)), ParseError::BadSymbol);
+    EXPECT_EQ(decode(makeBinaryCancel(1, "BRK.B", 5)), ParseError::None);
+    EXPECT_EQ(toString(ParseError::BadSymbol), "bad symbol");
+}
+
+// Test that clientOrderId can be read off any client message, even one that doesn't decode
+TEST(BinaryProtocolTest, ClientOrderIdIsAlwaysInTheSamePlace) {
+    EXPECT_EQ(peekClientOrderId(asBytes(makeBinaryNewOrder(11, "A", Side::Buy, OrderType::Limit, 1, 1))), 11);
+    EXPECT_EQ(peekClientOrderId(asBytes(makeBinaryCancel(12, "A", 1))), 12);
+    EXPECT_EQ(peekClientOrderId(asBytes(makeBinaryModify(13, "A", 1, 1, 1))), 13);
+    EXPECT_EQ(peekClientOrderId(std::string_view("\x04\x00O\x00", 4)), 0);
+
+    BinaryCancel cancel = makeBinaryCancel(14, "A", 1);
+    cancel.header.type = static_cast<BinaryMessageType>('Z');
+    ParsedMessage parsed{};
+    EXPECT_EQ(decodeBinary(asBytes(cancel), parsed), ParseError::UnknownMessageType);
+    EXPECT_EQ(parsed.clientOrderId, 14);
+}
+
+// Test that lengths, types and enum fields are checked before anything is used
+TEST(BinaryProtocolTest, MalformedMessagesHaveAReason) {
+    ParsedMessage parsed{};
+    EXPECT_EQ(decodeBinary("", parsed), ParseError::BadLength);
+    EXPECT_EQ(decodeBinary(std::string_view("\x04\x00", 2), parsed), ParseError::BadLength);
+
+    // Header length disagreeing with what was framed, or with the type
+    const std::string newOrder{asBytes(makeBinaryNewOrder(1, "A", Side::Buy, OrderType::Limit, 1, 1))};
+    EXPECT_EQ(decodeBinary(std::string_view(newOrder).substr(0, 39), parsed), ParseError::BadLength);
+    BinaryCancel longCancel = makeBinaryCancel(1, "A", 1);
+    longCancel.header.length = 48;
+    std::string padded{asBytes(longCancel)};
+    padded.resize(48);
+    EXPECT_EQ(decodeBinary(padded, parsed), ParseError::BadLength);
+
+    BinaryNewOrder order = makeBinaryNewOrder(1, "A", Side::Buy, OrderType::Limit, 1, 1);
+    order.header.type = static_cast<BinaryMessageType>('Z');
+    EXPECT_EQ(decode(order), ParseError::UnknownMessageType);
+
+    order = makeBinaryNewOrder(1, "A", Side::Buy, OrderType::Limit, 1, 1);
+    order.side = 'b';
+    EXPECT_EQ(decode(order), ParseError::BadSide);
+
+    order = makeBinaryNewOrder(1, "A", Side::Buy, OrderType::Limit, 1, 1);
+    order.orderType = 'X';
+    EXPECT_EQ(decode(order), ParseError::UnknownOrderType);
+
+    EXPECT_EQ(decode(makeBinaryNewOrder(1, "A", Side::Buy, OrderType::Limit, 1, 0)), ParseError::BadQuantity);
+    EXPECT_EQ(decode(makeBinaryModify(1, "A", 1, 1, 0)), ParseError::BadQuantity);
+    EXPECT_EQ(toString(ParseError::BadSide), "bad side");
+}
@@ -0,0 +1,81 @@
+#include <stdexcept>
+#include <vector>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include "BookManager.h"
+
+class BookManagerTest : public ::testing::Test {
+protected:
+    BookManager books{BookManagerConfig{.maxSymbols = 8}};
+    OrderId nextOrderId = 1;
+
+    Order makeOrder(Side side, Price price, Quantity quantity, OrderType type = OrderType::Limit) {
+        return Order(side, price, nextOrderId++, type, quantity, quantity);
+    }
+};
+
+TEST_F(BookManagerTest, BooksAreCreatedOnFirstUse) {
+    EXPECT_EQ(books.getBookCount(), 0);
+    EXPECT_EQ(books.findBook(3), nullptr);
+
+    OrderBook& book = books.getBook(3);
+    EXPECT_EQ(books.getBookCount(), 1);
+    EXPECT_EQ(books.findBook(3), &book);
+    EXPECT_EQ(&books.getBook(3), &book);
+    EXPECT_EQ(books.getBookCount(), 1);
+}
+
+TEST_F(BookManagerTest, SymbolsPastTheMaxThrow) {
+    EXPECT_EQ(books.getMaxSymbols(), 8);
+    EXPECT_THROW((void)books.getBook(8), std::out_of_range);
+    EXPECT_EQ(books.findBook(8), nullptr);
+    EXPECT_THROW(books.configureBook(8, OrderBookConfig{}), std::out_of_range);
+}
+
+TEST_F(BookManagerTest, BooksDontShareLiquidity) {
+    EXPECT_TRUE(books.getBook(1).processOrder(makeOrder(Side::Sell, 100, 10)));
+    EXPECT_TRUE(books.getBook(2).processOrder(makeOrder(Side::Buy, 100, 10)));
+
+    EXPECT_EQ(books.getBook(1).getBestAsk(), 100);
+    EXPECT_EQ(books.getBook(2).getBestBid(), 100);
+    EXPECT_TRUE(books.getBook(1).getTrades().empty());
+    EXPECT_TRUE(books.getBook(2).getTrades().empty());
+}
+
+TEST_F(BookManagerTest, PerSymbolConfigIsUsedWhenTheBookIsCreated) {
+    OrderBookConfig coarse{};
+    coarse.arenaSize = 16 * 1024 * 1024;
+    coarse.tickSize = 5;
+    coarse.expectedOpenOrders = 1000;
+    coarse.statusRetention = 1024;
+    books.configureBook(4, coarse);
+
+    OrderBook& book = books.getBook(4);
+    EXPECT_FALSE(book.processOrder(makeOrder(Side::Buy, 101, 1))); // Off the 5 tick grid
+    EXPECT_TRUE(book.processOrder(makeOrder(Side::Buy, 105, 1)));
+
+    // Default books keep the default tick
+    EXPECT_TRUE(books.getBook(5).processOrder(makeOrder(Side::Buy, 101, 1)));
+
+    // Too late once the book exists
+    EXPECT_THROW(books.configureBook(4, coarse), std::logic_error);
+}
+
+TEST_F(BookManagerTest, TradesAreTaggedWithTheirSymbol) {
+    std::vector<std::pair<SymbolId, TradeId>> seen;
+    (void)books.getBook(6); // Created before the sink is set
+    books.setTradeSink([&seen](SymbolId symbol, const Trade& trade){
+        seen.emplace_back(symbol, trade.getTradeId());
+    });
+
+    EXPECT_TRUE(books.getBook(6).processOrder(makeOrder(Side::Sell, 100, 5)));
+    EXPECT_TRUE(books.getBook(6).processOrder(makeOrder(Side::Buy, 100, 5)));
+    EXPECT_TRUE(books.getBook(7).processOrder(makeOrder(Side::Sell, 200, 5)));
+    EXPECT_TRUE(books.getBook(7).processOrder(makeOrder(Side::Buy, 200, 5)));
+
+    ASSERT_EQ(seen.size(), 2);
+    EXPECT_EQ(seen[0].first, 6);
+    EXPECT_EQ(seen[1].first, 7);
+    EXPECT_EQ(seen[1].second, 1); // Trade ids are per book
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "Command.h"
+
+#include <string>
+#include <type_traits>
+
+// Test that a command fills exactly one cache line and can live in a lock free ring
+TEST(CommandTest, CommandIsOneCacheLineAndTriviallyCopyable) {
+    EXPECT_EQ(sizeof(Command), 64);
+    EXPECT_EQ(alignof(Command), 64);
+    EXPECT_TRUE(std::is_trivially_copyable_v<Command>);
+    EXPECT_TRUE(std::is_default_constructible_v<Command>);
+}
+
+// Test that text survives the round trip and oversized messages are detected
+TEST(CommandTest, TextRoundTrips) {
+    const Command command = Command::makeText("AAPL BUY LIMIT 100 50");
+    EXPECT_EQ(command.type, CommandType::Text);
+    EXPECT_EQ(command.text.view(), "AAPL BUY LIMIT 100 50");
+    EXPECT_EQ(command.text.sequence, 0);
+    EXPECT_EQ(Command::makeText("CANCEL 1", 7).text.sequence, 7);
+
+    const std::string tooLong(TextCommand::capacity + 1, 'x');
+    EXPECT_TRUE(Command::fitsText(std::string(TextCommand::capacity, 'x')));
+    EXPECT_FALSE(Command::fitsText(tooLong));
+    EXPECT_EQ(Command::makeText(tooLong).text.length, TextCommand::capacity);
+}
+
+// Test that binary messages keep their bytes, zeros included
+TEST(CommandTest, BinaryRoundTrips) {
+    const std::string message("\x28\x00O\x00\x00B", 6);
+    const Command command = Command::makeBinary(message);
+    EXPECT_EQ(command.type, CommandType::Binary);
+    EXPECT_EQ(command.binary.view(), message);
+    EXPECT_TRUE(Command::fitsBinary(std::string(BinaryCommand::capacity, 'x')));
+    EXPECT_FALSE(Command::fitsBinary(std::string(BinaryCommand::capacity + 1, 'x')));
+}
+
+// Test that each factory tags the command and keeps its fields
+TEST(CommandTest, FactoriesSetTypeAndPayload) {
+    const Command newOrder = Command::makeNewOrder(NewOrderCommand{3, 42, Side::Sell, OrderType::FillOrKill, 101, 7, 0});
+    EXPECT_EQ(newOrder.type, CommandType::NewOrder);
+    EXPECT_EQ(newOrder.newOrder.symbol, 3);
+    EXPECT_EQ(newOrder.newOrder.orderId, 42);
+    EXPECT_EQ(newOrder.newOrder.side, Side::Sell);
+    EXPECT_EQ(newOrder.newOrder.type, OrderType::FillOrKill);
+
+    const Command cancel = Command::makeCancel(CancelCommand{1, 9, 0});
+    EXPECT_EQ(cancel.type, CommandType::Cancel);
+    EXPECT_EQ(cancel.cancel.orderId, 9);
+
+    const Command modify = Command::makeModify(ModifyCommand{1, 9, 99, 4, 0});
+    EXPECT_EQ(modify.type, CommandType::Modify);
+    EXPECT_EQ(modify.modify.price, 99);
+    EXPECT_EQ(modify.modify.quantity, 4);
+
+    const Command report = Command::makeTradeReport(5, Trade{11, 1, 2, 30, 100});
+    EXPECT_EQ(report.type, CommandType::TradeReport);
+    EXPECT_EQ(report.tradeReport.symbol, 5);
+    EXPECT_EQ(report.tradeReport.tradeId, 11);
+    EXPECT_EQ(report.tradeReport.takerOrderId, 1);
+    EXPECT_EQ(report.tradeReport.makerOrderId, 2);
+    EXPECT_EQ(report.tradeReport.quantity, 30);
+    EXPECT_EQ(report.tradeReport.price, 100);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "ExecutionReport.h"
+#include "BinaryProtocol.h"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace {
+
+std::string format(const ExecutionReport& report) {
+    std::array<char, maxTextReportLength> line;
+    return std::string(line.data(), formatTextReport(report, line));
+}
+
+ExecutionReport makeReport(ReportType type) {
+    return ExecutionReport{type, RejectReason::None, ParseError::None, 0, 1, 77, 5, 100, 10, 4, true};
+}
+
+}
+
+// Test that each report type makes the line the header comment says
+TEST(ExecutionReportTest, TextLines) {
+    EXPECT_EQ(format(makeReport(ReportType::Accepted)), "ACCEPTED 77 5 100 10\n");
+    EXPECT_EQ(format(makeReport(ReportType::Expired)), "EXPIRED 77 5 10\n");
+    EXPECT_EQ(format(makeReport(ReportType::Fill)), "FILL 77 5 100 10 4\n");
+    EXPECT_EQ(format(makeReport(ReportType::Cancelled)), "CANCELLED 77 5 10\n");
+    EXPECT_EQ(format(makeReport(ReportType::Modified)), "MODIFIED 77 5 100 10\n");
+
+    ExecutionReport reject = makeReport(ReportType::Rejected);
+    reject.reason = RejectReason::UnknownOrder;
+    EXPECT_EQ(format(reject), "REJECTED 77 5 unknown order\n");
+    reject.reason = RejectReason::Busy;
+    EXPECT_EQ(format(reject), "REJECTED 77 5 busy\n");
+}
+
+// Test that a malformed message is rejected with the parser's own words
+TEST(ExecutionReportTest, MalformedRejectsQuoteTheParseError) {
+    ExecutionReport reject = makeReport(ReportType::Rejected);
+    reject.orderId = 0;
+    reject.reason = RejectReason::Malformed;
+    reject.parseError = ParseError::BadSide;
+    EXPECT_EQ(format(reject), "REJECTED 77 0 bad side\n");
+}
+
+// Test that the longest possible line still fits
+TEST(ExecutionReportTest, LargestFillFits) {
+    ExecutionReport fill = makeReport(ReportType::Fill);
+    fill.clientOrderId = std::numeric_limits<uint64_t>::max();
+    fill.orderId = std::numeric_limits<OrderId>::max();
+    fill.price = std::numeric_limits<Price>::max();
+    fill.quantity = std::numeric_limits<Quantity>::max();
+    fill.leaves = std::numeric_limits<Quantity>::max();
+    const std::string line = format(fill);
+    ASSERT_LT(line.size(), maxTextReportLength);
+    EXPECT_EQ(line.back(), '\n');
+}
+
+// Test that binary reports carry every field at a fixed place
+TEST(ExecutionReportTest, BinaryReportLayout) {
+    ExecutionReport fill = makeReport(ReportType::Fill);
+    const BinaryReport message = makeBinaryReport(fill);
+    const std::string_view bytes = asBytes(message);
+    ASSERT_EQ(bytes.size(), sizeof(BinaryReport));
+    EXPECT_EQ(static_cast<uint8_t>(bytes[0]), sizeof(BinaryReport));
+    EXPECT_EQ(bytes[2], 'E');
+
+    BinaryReport decoded;
+    std::memcpy(&decoded, bytes.data(), sizeof(decoded));
+    EXPECT_EQ(decoded.clientOrderId, 77);
+    EXPECT_EQ(decoded.orderId, 5);
+    EXPECT_EQ(decoded.price, 100);
+    EXPECT_EQ(decoded.quantity, 10);
+    EXPECT_EQ(decoded.leaves, 4);
+
+    ExecutionReport reject = makeReport(ReportType::Rejected);
+    reject.reason = RejectReason::Malformed;
+    reject.parseError = ParseError::BadQuantity;
+    const BinaryReport rejected = makeBinaryReport(reject);
+    EXPECT_EQ(static_cast<char>(rejected.header.type), 'J');
+    EXPECT_EQ(rejected.reason, static_cast<uint8_t>(RejectReason::Malformed));
+    EXPECT_EQ(rejected.parseError, static_cast<uint8_t>(ParseError::BadQuantity));
+}
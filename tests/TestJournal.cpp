@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+#include "Journal.h"
+
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+class JournalTest : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        path = (std::filesystem::temp_directory_path() / (std::string("journal_") + ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".bin")).string();
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    JournalConfig makeConfig(JournalFsync fsync = JournalFsync::Never) const {
+        JournalConfig config{};
+        config.path = path;
+        config.bufferSize = 4096;
+        config.bufferCount = 2;
+        config.fsync = fsync;
+        return config;
+    }
+
+    std::vector<JournalRecord> readBack() const {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<JournalRecord> records;
+        JournalRecord record{};
+        while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+            records.push_back(record);
+        }
+        return records;
+    }
+
+    static JournalRecord newOrder(OrderId orderId) {
+        return JournalRecord::fromCommand(Command::makeNewOrder(NewOrderCommand{2, orderId, Side::Sell, OrderType::Limit, 100, 5, 0}));
+    }
+};
+
+// Test that commands map onto records field for field
+TEST_F(JournalTest, CommandsBecomeRecords) {
+    const JournalRecord order = newOrder(7);
+    EXPECT_EQ(order.type, JournalRecordType::NewOrder);
+    EXPECT_EQ(order.symbol, 2);
+    EXPECT_EQ(order.orderId, 7);
+    EXPECT_EQ(static_cast<Side>(order.side), Side::Sell);
+    EXPECT_EQ(static_cast<OrderType>(order.orderType), OrderType::Limit);
+    EXPECT_EQ(order.price, 100);
+    EXPECT_EQ(order.quantity, 5);
+
+    const JournalRecord trade = JournalRecord::fromCommand(Command::makeTradeReport(3, Trade{9, 1, 2, 30, 101}));
+    EXPECT_EQ(trade.type, JournalRecordType::Trade);
+    EXPECT_EQ(trade.tradeId, 9);
+    EXPECT_EQ(trade.orderId, 1);
+    EXPECT_EQ(trade.makerOrderId, 2);
+
+    EXPECT_TRUE(JournalRecord::isJournaled(Command::makeCancel(CancelCommand{1, 1, 0})));
+    EXPECT_FALSE(JournalRecord::isJournaled(Command::makeText("BUY LIMIT 1 1")));
+}
+
+// Test that nothing reaches the file until a commit and then everything does in one write
+TEST_F(JournalTest, CommitWritesEverythingAppendedInOneGroup) {
+    Journal journal{makeConfig()};
+    for (OrderId id = 1; id <= 10; ++id) {
+        journal.append(newOrder(id));
+    }
+    EXPECT_TRUE(readBack().empty());
+
+    journal.commit();
+    const std::vector<JournalRecord> records = readBack();
+    ASSERT_EQ(records.size(), 10);
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].sequence, i + 1);
+        EXPECT_EQ(records[i].orderId, i + 1);
+    }
+    EXPECT_EQ(journal.getStats().commits, 1);
+    EXPECT_EQ(journal.getStats().bytesWritten, 10 * sizeof(JournalRecord));
+
+    journal.commit(); // Nothing new, nothing written
+    EXPECT_EQ(journal.getStats().commits, 1);
+}
+
+// Test that running out of buffer space commits on its own and no record is lost or split
+TEST_F(JournalTest, FullBuffersCommitWithoutLosingRecords) {
+    const size_t perBuffer = 4096 / sizeof(JournalRecord);
+    const size_t count = perBuffer * 2 * 3 + 5;
+    {
+        Journal journal{makeConfig()};
+        for (size_t i = 1; i <= count; ++i) {
+            journal.append(newOrder(i));
+        }
+        EXPECT_EQ(journal.getStats().commits, 3);
+    } // Destructor commits the rest
+
+    const std::vector<JournalRecord> records = readBack();
+    ASSERT_EQ(records.size(), count);
+    EXPECT_EQ(records.back().sequence, count);
+    EXPECT_EQ(records.back().orderId, count);
+}
+
+// Test that the fsync policy decides when the file is synced
+TEST_F(JournalTest, FsyncPolicyIsFollowed) {
+    {
+        Journal journal{makeConfig(JournalFsync::EveryCommit)};
+        journal.append(newOrder(1));
+        journal.commit();
+        journal.append(newOrder(2));
+        journal.commit();
+        EXPECT_EQ(journal.getStats().syncs, 2);
+    }
+    {
+        JournalConfig config = makeConfig(JournalFsync::Interval);
+        config.fsyncInterval = std::chrono::hours(1);
+        Journal journal{config};
+        journal.append(newOrder(3));
+        journal.commit();
+        EXPECT_EQ(journal.getStats().syncs, 0);
+    }
+    {
+        Journal journal{makeConfig(JournalFsync::Never)};
+        journal.append(newOrder(4));
+        journal.commit();
+        EXPECT_EQ(journal.getStats().syncs, 0);
+    }
+}
+
+// Test that an Interval journal syncs the tail it left unsynced once it goes idle, and only then
+TEST_F(JournalTest, IdleSyncsWhatIntervalLeftBehind) {
+    {
+        JournalConfig config = makeConfig(JournalFsync::Interval);
+        config.fsyncInterval = std::chrono::hours(1);
+        Journal journal{config};
+        journal.idle();
+        EXPECT_EQ(journal.getStats().syncs, 0);
+        journal.append(newOrder(1));
+        journal.commit();
+        EXPECT_EQ(journal.getStats().syncs, 0);
+        journal.idle();
+        EXPECT_EQ(journal.getStats().syncs, 1);
+        journal.idle();
+        EXPECT_EQ(journal.getStats().syncs, 1);
+    }
+    {
+        Journal journal{makeConfig(JournalFsync::EveryCommit)};
+        journal.append(newOrder(2));
+        journal.commit();
+        journal.idle();
+        EXPECT_EQ(journal.getStats().syncs, 1);
+    }
+    {
+        Journal journal{makeConfig(JournalFsync::Never)};
+        journal.append(newOrder(3));
+        journal.commit();
+        journal.idle();
+        EXPECT_EQ(journal.getStats().syncs, 0);
+    }
+}
+
+// Test that reopening a journal continues its sequence and cuts off a torn last record
+TEST_F(JournalTest, ReopeningContinuesAfterTheLastWholeRecord) {
+    {
+        Journal journal{makeConfig()};
+        journal.append(newOrder(1));
+        journal.append(newOrder(2));
+    }
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.write("torn", 4);
+    }
+    {
+        Journal journal{makeConfig()};
+        EXPECT_EQ(journal.getNextSequence(), 3);
+        journal.append(newOrder(3));
+    }
+
+    const std::vector<JournalRecord> records = readBack();
+    ASSERT_EQ(records.size(), 3);
+    EXPECT_EQ(records[2].sequence, 3);
+    EXPECT_EQ(records[2].orderId, 3);
+    EXPECT_EQ(std::filesystem::file_size(path), 3 * sizeof(JournalRecord));
+
+    JournalConfig fresh = makeConfig();
+    fresh.truncate = true;
+    Journal journal{fresh};
+    EXPECT_EQ(journal.getNextSequence(), 1);
+}
+
+// Test that the reader hands back every record even when its chunks split records, and stops at a torn tail
+TEST_F(JournalTest, ReaderReadsAcrossChunks) {
+    {
+        Journal journal{makeConfig()};
+        for (OrderId id = 1; id <= 500; ++id) {
+            journal.append(newOrder(id));
+        }
+    }
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.write("torn", 4);
+    }
+
+    JournalReader reader{path, 100};
+    JournalRecord record{};
+    OrderId expected = 1;
+    while (reader.next(record)) {
+        EXPECT_EQ(record.sequence, expected);
+        EXPECT_EQ(record.orderId, expected);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 501);
+    EXPECT_FALSE(reader.hitGap());
+    EXPECT_THROW(JournalReader{"/nonexistent-dir/journal.bin"}, std::system_error);
+}
+
+// Test that the reader stops at the first sequence gap
+TEST_F(JournalTest, ReaderStopsAtSequenceGaps) {
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (uint64_t sequence : {1, 2, 4, 5}) {
+            JournalRecord record = newOrder(sequence);
+            record.sequence = sequence;
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+    }
+
+    JournalReader reader{path};
+    JournalRecord record{};
+    EXPECT_TRUE(reader.next(record));
+    EXPECT_TRUE(reader.next(record));
+    EXPECT_EQ(record.sequence, 2);
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_TRUE(reader.hitGap());
+    EXPECT_FALSE(reader.next(record));
+}
+
+// Test that a journal without a path or in a missing directory fails up front
+TEST_F(JournalTest, BadPathsThrow) {
+    EXPECT_THROW(Journal{JournalConfig{}}, std::invalid_argument);
+    JournalConfig config = makeConfig();
+    config.path = "/nonexistent-dir/journal.bin";
+    EXPECT_THROW(Journal{config}, std::system_error);
+}
+
+#ifndef _WIN32
+// Test that a commit failing halfway through is picked up where it stopped, nothing on disk is written twice
+TEST_F(JournalTest, FailedCommitResumesWhereItStopped) {
+    // Past the file size limit writes come up short and then fail with EFBIG (instead of killing us with SIGXFSZ)
+    rlimit original{};
+    ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &original), 0);
+    const auto previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+
+    {
+        Journal journal{makeConfig()};
+        for (OrderId i = 1; i <= 10; ++i) {
+            journal.append(newOrder(i));
+        }
+        rlimit limited{original};
+        limited.rlim_cur = 3 * sizeof(JournalRecord) + 16; // Cuts the fourth record in half
+        ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limited), 0);
+        EXPECT_THROW(journal.commit(), std::system_error);
+        ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &original), 0);
+        EXPECT_EQ(std::filesystem::file_size(path), 3 * sizeof(JournalRecord) + 16);
+
+        journal.append(newOrder(11));
+        journal.commit();
+        EXPECT_EQ(journal.getStats().bytesWritten, 11 * sizeof(JournalRecord));
+    }
+    std::signal(SIGXFSZ, previousHandler);
+
+    JournalReader reader{path};
+    JournalRecord record{};
+    uint64_t count = 0;
+    while (reader.next(record)) {
+        ++count;
+        EXPECT_EQ(record.sequence, count);
+        EXPECT_EQ(record.orderId, count);
+    }
+    EXPECT_FALSE(reader.hitGap());
+    EXPECT_EQ(count, 11);
+}
+#endif
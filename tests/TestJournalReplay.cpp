@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "JournalReplay.h"
+#include "BookManager.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Drives a BookManager the way the matching stage does and journals it the way the Logger stage does:
+// trades as they happen, then the order that caused them whether the book took it or not, cancels and modifies if it took them
+class JournalReplayTest : public ::testing::Test {
+protected:
+    static constexpr SymbolId symbols = 4;
+
+    std::string path;
+    BookManagerConfig booksConfig{.maxSymbols = symbols, .defaultBook = OrderBookConfig{.arenaSize = 32 * 1024 * 1024, .statusRetention = 1 << 16}};
+
+    void SetUp() override {
+        path = (std::filesystem::temp_directory_path() / (std::string("replay_") + ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".bin")).string();
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    JournalConfig journalConfig() const {
+        JournalConfig config{};
+        config.path = path;
+        config.bufferSize = 4096;
+        config.bufferCount = 2;
+        config.fsync = JournalFsync::Never;
+        return config;
+    }
+
+    // Random mix of every order type plus cancels and modifies of earlier orders, returns the highest order id used
+    OrderId runLiveSession(BookManager& live, Journal& journal, size_t commands, uint64_t seed) {
+        live.setTradeSink([&journal](SymbolId symbol, const Trade& trade) {
+            journal.append(JournalRecord::fromCommand(Command::makeTradeReport(symbol, trade)));
+        });
+
+        std::mt19937_64 rng{seed};
+        OrderId nextOrderId = 1;
+        constexpr std::array<OrderType, 5> types{OrderType::Limit, OrderType::Market, OrderType::ImmediateOrCancel, OrderType::PostOnly, OrderType::FillOrKill};
+
+        for (size_t i = 0; i < commands; ++i) {
+            const SymbolId symbol = static_cast<SymbolId>(rng() % symbols);
+            OrderBook& book = live.getBook(symbol);
+            const uint64_t roll = rng() % 10;
+
+            if (roll < 7 || nextOrderId == 1) {
+                const OrderType type = types[rng() % 10 < 6 ? 0 : rng() % types.size()];
+                const NewOrderCommand order{symbol, nextOrderId++, rng() % 2 == 0 ? Side::Buy : Side::Sell, type,
+                    static_cast<Price>(95 + rng() % 11), static_cast<Quantity>(1 + rng() % 20), 0};
+                const bool accepted = book.processOrder(Order(order.side, order.price, order.orderId, order.type, order.quantity, order.quantity));
+                journal.append(JournalRecord::fromCommand(accepted ? Command::makeNewOrder(order) : Command::makeRejectedOrder(order)));
+            } else if (roll < 9) {
+                const CancelCommand cancel{symbol, 1 + rng() % (nextOrderId - 1), 0};
+                if (book.cancelOrder(cancel.orderId)) {
+                    journal.append(JournalRecord::fromCommand(Command::makeCancel(cancel)));
+                }
+            } else {
+                const ModifyCommand modify{symbol, 1 + rng() % (nextOrderId - 1), static_cast<Price>(95 + rng() % 11), static_cast<Quantity>(1 + rng() % 20), 0};
+                if (book.modifyOrder(modify.orderId, modify.quantity, modify.price)) {
+                    journal.append(JournalRecord::fromCommand(Command::makeModify(modify)));
+                }
+            }
+        }
+        live.setTradeSink({});
+        return nextOrderId - 1;
+    }
+
+    static void expectSameBooks(BookManager& live, BookManager& replayed, OrderId lastOrderId) {
+        for (SymbolId symbol = 0; symbol < symbols; ++symbol) {
+            OrderBook* liveBook = live.findBook(symbol);
+            OrderBook* replayedBook = replayed.findBook(symbol);
+            ASSERT_EQ(liveBook == nullptr, replayedBook == nullptr) << "symbol " << symbol;
+            if (liveBook == nullptr) {
+                continue;
+            }
+
+            std::vector<LevelUpdate> liveLevels;
+            std::vector<LevelUpdate> replayedLevels;
+            liveBook->forEachLevel([&liveLevels](const LevelUpdate& level) { liveLevels.push_back(level); });
+            replayedBook->forEachLevel([&replayedLevels](const LevelUpdate& level) { replayedLevels.push_back(level); });
+            EXPECT_EQ(liveLevels, replayedLevels) << "symbol " << symbol;
+            EXPECT_EQ(liveBook->getQuantityOfBids(), replayedBook->getQuantityOfBids());
+            EXPECT_EQ(liveBook->getQuantityOfAsks(), replayedBook->getQuantityOfAsks());
+            EXPECT_EQ(liveBook->getTrades().size(), replayedBook->getTrades().size());
+            if (!liveBook->getTrades().empty()) {
+                EXPECT_EQ(liveBook->getTrades().back().getTradeId(), replayedBook->getTrades().back().getTradeId());
+            }
+        }
+
+        // Turned down orders included, they're journaled as such
+        for (OrderId orderId = 1; orderId <= lastOrderId; ++orderId) {
+            for (SymbolId symbol = 0; symbol < symbols; ++symbol) {
+                const OrderStatus liveStatus = live.getBook(symbol).reviewOrderStatus(orderId);
+                const OrderStatus replayedStatus = replayed.getBook(symbol).reviewOrderStatus(orderId);
+                EXPECT_EQ(liveStatus.state, replayedStatus.state) << "order " << orderId;
+                EXPECT_EQ(liveStatus.filledQuantity, replayedStatus.filledQuantity) << "order " << orderId;
+                EXPECT_EQ(liveStatus.remainingQuantity, replayedStatus.remainingQuantity) << "order " << orderId;
+            }
+        }
+    }
+};
+
+// Test that replaying the journal rebuilds every book exactly, including where trade ids and order ids carry on
+TEST_F(JournalReplayTest, ReplayedBooksMatchTheLiveOnes) {
+    BookManager live{booksConfig};
+    OrderId lastOrderId = 0;
+    {
+        Journal journal{journalConfig()};
+        lastOrderId = runLiveSession(live, journal, 20'000, 42);
+    }
+
+    BookManager replayed{booksConfig};
+    const ReplayStats stats = replayJournal(path, [&replayed](SymbolId symbol) -> OrderBook& { return replayed.getBook(symbol); });
+
+    EXPECT_EQ(stats.mismatches, 0);
+    EXPECT_FALSE(stats.stoppedAtGap);
+    EXPECT_GT(stats.newOrders, 0);
+    EXPECT_GT(stats.cancels, 0);
+    EXPECT_GT(stats.modifies, 0);
+    EXPECT_GT(stats.trades, 0);
+    EXPECT_EQ(stats.lastOrderId, lastOrderId);
+    expectSameBooks(live, replayed, lastOrderId);
+
+    // Both carry on with the same trade ids
+    for (SymbolId symbol = 0; symbol < symbols; ++symbol) {
+        const OrderId next = lastOrderId + 1 + symbol;
+        const Order sweepLive(Side::Buy, 200, next, OrderType::Market, 1, 1);
+        const Order sweepReplayed(Side::Buy, 200, next, OrderType::Market, 1, 1);
+        EXPECT_EQ(live.getBook(symbol).processOrder(sweepLive), replayed.getBook(symbol).processOrder(sweepReplayed));
+    }
+    expectSameBooks(live, replayed, lastOrderId + symbols);
+}
+
+// Test that an order the book turned down keeps its id and status through a replay, even as the last one
+TEST_F(JournalReplayTest, TurnedDownOrdersKeepTheirIds) {
+    BookManager live{booksConfig};
+    OrderBook& book = live.getBook(0);
+    const NewOrderCommand resting{0, 1, Side::Sell, OrderType::Limit, 100, 5, 0};
+    const NewOrderCommand crossing{0, 2, Side::Buy, OrderType::PostOnly, 100, 5, 0};
+    ASSERT_TRUE(book.processOrder(Order(resting.side, resting.price, resting.orderId, resting.type, resting.quantity, resting.quantity)));
+    ASSERT_FALSE(book.processOrder(Order(crossing.side, crossing.price, crossing.orderId, crossing.type, crossing.quantity, crossing.quantity)));
+    {
+        Journal journal{journalConfig()};
+        journal.append(JournalRecord::fromCommand(Command::makeNewOrder(resting)));
+        journal.append(JournalRecord::fromCommand(Command::makeRejectedOrder(crossing)));
+    }
+
+    BookManager replayed{booksConfig};
+    const ReplayStats stats = replayJournal(path, [&replayed](SymbolId symbol) -> OrderBook& { return replayed.getBook(symbol); });
+    EXPECT_EQ(stats.newOrders, 2);
+    EXPECT_EQ(stats.mismatches, 0);
+    EXPECT_EQ(stats.lastOrderId, crossing.orderId);
+    EXPECT_EQ(replayed.getBook(0).reviewOrderStatus(crossing.orderId).state, book.reviewOrderStatus(crossing.orderId).state);
+    EXPECT_EQ(replayed.getBook(0).getQuantityOfAsks(), 5);
+}
+
+// Test that a journal cut off mid record or with a sequence gap replays up to the last good record
+TEST_F(JournalReplayTest, ReplayStopsAtTornOrOutOfSequenceRecords) {
+    {
+        Journal journal{journalConfig()};
+        for (OrderId id = 1; id <= 3; ++id) {
+            journal.append(JournalRecord::fromCommand(Command::makeNewOrder(NewOrderCommand{0, id, Side::Buy, OrderType::Limit, 100, 1, 0})));
+        }
+    }
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        JournalRecord skipped = JournalRecord::fromCommand(Command::makeNewOrder(NewOrderCommand{0, 9, Side::Buy, OrderType::Limit, 100, 1, 0}));
+        skipped.sequence = 7;
+        file.write(reinterpret_cast<const char*>(&skipped), sizeof(skipped));
+        file.write("torn", 4);
+    }
+
+    BookManager replayed{booksConfig};
+    const ReplayStats stats = replayJournal(path, [&replayed](SymbolId symbol) -> OrderBook& { return replayed.getBook(symbol); });
+    EXPECT_EQ(stats.records, 3);
+    EXPECT_EQ(stats.lastSequence, 3);
+    EXPECT_EQ(stats.lastOrderId, 3);
+    EXPECT_TRUE(stats.stoppedAtGap);
+    EXPECT_EQ(replayed.getBook(0).getQuantityOfBids(), 3);
+}
+
+// Test that a missing journal is an error rather than an empty replay
+TEST_F(JournalReplayTest, MissingJournalThrows) {
+    BookManager replayed{booksConfig};
+    EXPECT_THROW((void)replayJournal(path, [&replayed](SymbolId symbol) -> OrderBook& { return replayed.getBook(symbol); }), std::system_error);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Test that small values are counted exactly
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100; ++value) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(histogram.getCount(), 100);
+    EXPECT_EQ(histogram.getMin(), 1);
+    EXPECT_EQ(histogram.getMax(), 100);
+    EXPECT_EQ(histogram.percentile(0.5), 50);
+    EXPECT_EQ(histogram.percentile(0.99), 99);
+    EXPECT_EQ(histogram.percentile(1.0), 100);
+    EXPECT_DOUBLE_EQ(histogram.getMean(), 50.5);
+}
+
+// Test that percentiles of a wide spread of values are within the bucket precision of the exact ones
+TEST(LatencyHistogramTest, PercentilesStayWithinPrecision) {
+    std::mt19937_64 rng{3};
+    std::lognormal_distribution<double> distribution{6.0, 1.5};
+    LatencyHistogram histogram;
+    std::vector<uint64_t> values;
+    for (int i = 0; i < 200'000; ++i) {
+        const uint64_t value = static_cast<uint64_t>(distribution(rng));
+        values.push_back(value);
+        histogram.record(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    for (double fraction : {0.5, 0.9, 0.99, 0.999}) {
+        const uint64_t exact = values[static_cast<size_t>(fraction * values.size()) - 1];
+        const uint64_t reported = histogram.percentile(fraction);
+        EXPECT_GE(reported, exact) << fraction;
+        EXPECT_LE(reported, exact + exact / 128 + 1) << fraction;
+    }
+    EXPECT_EQ(histogram.percentile(1.0), values.back());
+}
+
+// Test that huge values land in the last buckets without overflowing
+TEST(LatencyHistogramTest, HugeValuesFit) {
+    LatencyHistogram histogram;
+    histogram.record(UINT64_MAX);
+    histogram.record(uint64_t{1} << 40);
+    EXPECT_EQ(histogram.getMax(), UINT64_MAX);
+    EXPECT_EQ(histogram.percentile(1.0), UINT64_MAX);
+    EXPECT_GE(histogram.percentile(0.5), uint64_t{1} << 40);
+    EXPECT_LT(histogram.percentile(0.5), (uint64_t{1} << 40) + (uint64_t{1} << 33));
+}
+
+// Test that merging gives the same result as recording everything into one histogram
+TEST(LatencyHistogramTest, MergeAddsUp) {
+    LatencyHistogram left;
+    LatencyHistogram right;
+    LatencyHistogram both;
+    for (uint64_t value = 1; value < 10'000; value += 7) {
+        (value % 2 == 0 ? left : right).record(value);
+        both.record(value);
+    }
+    left.merge(right);
+    EXPECT_EQ(left.getCount(), both.getCount());
+    EXPECT_EQ(left.getMin(), both.getMin());
+    EXPECT_EQ(left.getMax(), both.getMax());
+    for (double fraction : {0.1, 0.5, 0.99}) {
+        EXPECT_EQ(left.percentile(fraction), both.percentile(fraction));
+    }
+
+    left.reset();
+    EXPECT_EQ(left.getCount(), 0);
+    EXPECT_EQ(left.percentile(0.5), 0);
+}
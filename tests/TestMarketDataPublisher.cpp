@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include "MarketDataPublisher.h"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+struct Received {
+    MarketDataHeader header;
+    std::vector<MarketDataLevel> levels;
+};
+
+// Plain blocking-connect, non-blocking-read subscriber speaking the wire format from MarketDataPublisher.h
+class Subscriber {
+public:
+    explicit Subscriber(const std::string& path) {
+        fd_ = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        connected_ = connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    }
+
+    ~Subscriber() { close(); }
+
+    void close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    [[nodiscard]] bool isConnected() const { return connected_; }
+
+    std::vector<Received> readAll() {
+        std::vector<Received> packets;
+        std::array<std::byte, 64 * 1024> buffer{};
+        while (true) {
+            const ssize_t size = recv(fd_, buffer.data(), buffer.size(), MSG_DONTWAIT);
+            if (size <= 0) {
+                return packets;
+            }
+            Received packet{};
+            std::memcpy(&packet.header, buffer.data(), sizeof(packet.header));
+            packet.levels.resize(packet.header.count);
+            std::memcpy(packet.levels.data(), buffer.data() + sizeof(packet.header), packet.header.count * sizeof(MarketDataLevel));
+            EXPECT_EQ(static_cast<size_t>(size), sizeof(MarketDataHeader) + packet.header.count * sizeof(MarketDataLevel));
+            packets.push_back(std::move(packet));
+        }
+    }
+
+private:
+    int fd_ = -1;
+    bool connected_ = false;
+};
+
+using Book = std::map<std::tuple<SymbolId, uint8_t, Price>, Quantity>;
+
+// Applies packets to a local L2 view the way a subscriber would
+void applyPackets(Book& book, const std::vector<Received>& packets) {
+    for (const Received& packet : packets) {
+        for (const MarketDataLevel& level : packet.levels) {
+            const auto key = std::make_tuple(level.symbol, level.side, level.price);
+            if (level.quantity == 0) {
+                book.erase(key);
+            } else {
+                book[key] = level.quantity;
+            }
+        }
+    }
+}
+
+}
+
+class MarketDataPublisherTest : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        path = (std::filesystem::temp_directory_path() / (std::string("md_") + ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".sock")).string();
+    }
+
+    MarketDataConfig makeConfig() const {
+        MarketDataConfig config{};
+        config.socketPath = path;
+        config.levelsPerPacket = 4;
+        return config;
+    }
+};
+
+// Test that a new subscriber starts with a snapshot of every level and then gets incremental updates
+TEST_F(MarketDataPublisherTest, SubscribersGetASnapshotThenUpdates) {
+    MarketDataPublisher publisher{makeConfig()};
+    publisher.update(1, Side::Buy, 99, 10);
+    publisher.update(1, Side::Sell, 101, 20);
+    publisher.update(2, Side::Buy, 50, 5);
+    publisher.update(2, Side::Buy, 50, 0); // Gone before anyone saw it
+    publisher.publish();
+
+    Subscriber subscriber{path};
+    ASSERT_TRUE(subscriber.isConnected());
+    publisher.publish();
+    EXPECT_EQ(publisher.getSubscriberCount(), 1);
+
+    std::vector<Received> snapshot = subscriber.readAll();
+    ASSERT_EQ(snapshot.size(), 1);
+    EXPECT_EQ(snapshot[0].header.sequence, 1);
+    EXPECT_EQ(snapshot[0].header.flags, MarketDataHeader::snapshotFlag);
+    Book book;
+    applyPackets(book, snapshot);
+    EXPECT_EQ(book, (Book{{{1, 0, 99}, 10}, {{1, 1, 101}, 20}}));
+
+    publisher.update(1, Side::Buy, 99, 7);
+    publisher.update(1, Side::Sell, 101, 0);
+    publisher.publish();
+    std::vector<Received> updates = subscriber.readAll();
+    ASSERT_EQ(updates.size(), 1);
+    EXPECT_EQ(updates[0].header.sequence, 2);
+    EXPECT_EQ(updates[0].header.flags, 0);
+    applyPackets(book, updates);
+    EXPECT_EQ(book, (Book{{{1, 0, 99}, 7}}));
+}
+
+// Test that several updates to one level in the same batch go out as only the last total
+TEST_F(MarketDataPublisherTest, UpdatesAreConflatedPerBatch) {
+    MarketDataPublisher publisher{makeConfig()};
+    Subscriber subscriber{path};
+    publisher.publish();
+
+    for (Quantity quantity = 1; quantity <= 50; ++quantity) {
+        publisher.update(3, Side::Sell, 200, quantity);
+    }
+    publisher.publish();
+
+    std::vector<Received> packets = subscriber.readAll();
+    ASSERT_EQ(packets.size(), 1);
+    ASSERT_EQ(packets[0].levels.size(), 1);
+    EXPECT_EQ(packets[0].levels[0].quantity, 50);
+    EXPECT_EQ(publisher.getLevel(3, Side::Sell, 200), 50);
+}
+
+// Test that a subscriber that stops reading only gets the latest totals once it catches up and doesn't hold anyone up
+TEST_F(MarketDataPublisherTest, SlowSubscribersAreConflatedNotBlocking) {
+    MarketDataPublisher publisher{makeConfig()};
+    Subscriber slow{path};
+    Subscriber fast{path};
+    publisher.publish();
+    ASSERT_EQ(publisher.getSubscriberCount(), 2);
+
+    Book fastBook;
+    constexpr int batches = 5000;
+    for (int batch = 1; batch <= batches; ++batch) {
+        for (Price price = 0; price < 8; ++price) {
+            publisher.update(1, Side::Buy, 1000 + price, static_cast<Quantity>(batch));
+        }
+        publisher.publish();
+        applyPackets(fastBook, fast.readAll());
+    }
+
+    const uint64_t published = static_cast<uint64_t>(batches) * 8;
+    EXPECT_GT(publisher.getStats().conflated, 0);
+
+    Book slowBook;
+    for (int round = 0; round < 1000 && slowBook != fastBook; ++round) {
+        applyPackets(slowBook, slow.readAll());
+        publisher.publish(); // Nothing new, just hands over what the slow one couldn't take before
+    }
+    EXPECT_EQ(slowBook, fastBook);
+    EXPECT_EQ(fastBook.at({1, 0, 1007}), static_cast<Quantity>(batches));
+    EXPECT_LT(publisher.getStats().levelsSent, published * 2); // The slow one skipped the totals that were replaced
+}
+
+// Test that closed connections are dropped on the next publish
+TEST_F(MarketDataPublisherTest, DisconnectedSubscribersAreDropped) {
+    MarketDataPublisher publisher{makeConfig()};
+    Subscriber subscriber{path};
+    publisher.publish();
+    ASSERT_EQ(publisher.getSubscriberCount(), 1);
+
+    subscriber.close();
+    publisher.update(1, Side::Buy, 10, 1);
+    publisher.publish();
+    EXPECT_EQ(publisher.getSubscriberCount(), 0);
+    EXPECT_EQ(publisher.getStats().disconnects, 1);
+}
+
+// Test that bad socket paths fail up front
+TEST_F(MarketDataPublisherTest, BadPathsThrow) {
+    EXPECT_THROW(MarketDataPublisher{MarketDataConfig{}}, std::invalid_argument);
+    MarketDataConfig config = makeConfig();
+    config.socketPath = "/nonexistent-dir/md.sock";
+    EXPECT_THROW(MarketDataPublisher{config}, std::system_error);
+}
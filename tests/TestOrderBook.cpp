@@ -310,4 +310,389 @@ TEST_F(OrderBookTest, MarketOrderMultipleOrdersAtDifferentTimes) {
     EXPECT_EQ(orderBook.reviewOrderStatus(order2.getOrderId()).filledQuantity, 13);
     EXPECT_EQ(orderBook.getBestBid(), 0);
     EXPECT_EQ(orderBook.getBestAsk(), 105);
-}
\ No newline at end of file
+}
+
+// Price ladder backend 
+
+TEST(OrderBookLadderTest, LadderRecentersWhenPriceLeavesWindow) {
+    OrderBookConfig config{};
+    config.ladderLevels = 8;
+    OrderBook orderBook{config};
+
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 100, 1, OrderType::Limit, 10, 10)), true);
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 1000, 2, OrderType::Limit, 5, 5)), true);
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 3, 3, OrderType::Limit, 7, 7)), true);
+
+    EXPECT_EQ(orderBook.getBestBid(), 1000);
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 22);
+
+    EXPECT_EQ(orderBook.cancelOrder(2), true);
+    EXPECT_EQ(orderBook.getBestBid(), 100);
+
+    // Sweep what is left after the window moved around
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Sell, 1, 4, OrderType::Limit, 17, 17)), true);
+    EXPECT_EQ(orderBook.getBestBid(), 0);
+    EXPECT_EQ(orderBook.getBestAsk(), 0);
+    EXPECT_EQ(orderBook.getTrades().size(), 2);
+    EXPECT_EQ(orderBook.getTrades()[0].getPrice(), 100);
+    EXPECT_EQ(orderBook.getTrades()[1].getPrice(), 3);
+}
+
+TEST(OrderBookLadderTest, BestPriceMovesAcrossBitmapWords) {
+    OrderBookConfig config{};
+    config.ladderLevels = 256;
+    OrderBook orderBook{config};
+
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Sell, 500, 1, OrderType::Limit, 1, 1)), true);
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Sell, 630, 2, OrderType::Limit, 1, 1)), true);
+    EXPECT_EQ(orderBook.getBestAsk(), 500);
+
+    EXPECT_EQ(orderBook.cancelOrder(1), true);
+    EXPECT_EQ(orderBook.getBestAsk(), 630);
+}
+
+TEST(OrderBookLadderTest, OffTickAndOutOfRangePricesAreRejected) {
+    OrderBookConfig config{};
+    config.tickSize = 5;
+    config.ladderLevels = 4;
+    config.maxLadderLevels = 16;
+    OrderBook orderBook{config};
+
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 102, 1, OrderType::Limit, 10, 10)), false);
+    EXPECT_EQ(orderBook.reviewOrderStatus(1).state, OrderState::Rejected);
+
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 100, 2, OrderType::Limit, 10, 10)), true);
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 200, 3, OrderType::Limit, 10, 10)), false);
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 175, 4, OrderType::Limit, 10, 10)), true);
+    EXPECT_EQ(orderBook.getBestBid(), 175);
+}
+
+TEST_F(OrderBookTest, CancelFromMiddleOfLevelKeepsFifoOrder) {
+    auto first = makeOrder(Side::Sell, 105, 5);
+    auto middle = makeOrder(Side::Sell, 105, 5);
+    auto last = makeOrder(Side::Sell, 105, 5);
+    EXPECT_EQ(orderBook.processOrder(first), true);
+    EXPECT_EQ(orderBook.processOrder(middle), true);
+    EXPECT_EQ(orderBook.processOrder(last), true);
+
+    EXPECT_EQ(orderBook.cancelOrder(middle.getOrderId()), true);
+    EXPECT_EQ(orderBook.getQuantityOfAsks(), 10);
+
+    EXPECT_EQ(orderBook.processOrder(makeOrder(Side::Buy, 105, 10)), true);
+
+    const auto& trades = orderBook.getTrades();
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].getMakerOrderId(), first.getOrderId());
+    EXPECT_EQ(trades[1].getMakerOrderId(), last.getOrderId());
+    EXPECT_EQ(orderBook.getBestAsk(), 0);
+}
+
+TEST(OrderBookIndexTest, CollidingOrderIdsStillResolve) {
+    OrderBookConfig config{};
+    config.expectedOpenOrders = 8;
+    config.statusRetention = 8;
+    OrderBook orderBook{config};
+
+    // Ids that are all the same modulo any power of two table size, then enough of them to force growth
+    constexpr OrderId stride = OrderId{1} << 32;
+    for (OrderId i = 1; i <= 64; ++i) {
+        EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 100, i * stride, OrderType::Limit, 1, 1)), true);
+    }
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 64);
+
+    EXPECT_EQ(orderBook.cancelOrder(10 * stride), true);
+    EXPECT_EQ(orderBook.cancelOrder(10 * stride), false);
+    EXPECT_EQ(orderBook.reviewOrderStatus(10 * stride).state, OrderState::Cancelled);
+    EXPECT_EQ(orderBook.reviewOrderStatus(64 * stride).state, OrderState::Processing);
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 100, 64 * stride, OrderType::Limit, 1, 1)), false);
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 63);
+}
+
+TEST_F(OrderBookTest, DepthTracksLevelAggregates) {
+    auto bid1 = makeOrder(Side::Buy, 100, 10);
+    auto bid2 = makeOrder(Side::Buy, 100, 5);
+    auto bid3 = makeOrder(Side::Buy, 98, 7);
+    auto ask1 = makeOrder(Side::Sell, 103, 4);
+    auto ask2 = makeOrder(Side::Sell, 105, 6);
+    for (const auto& order : {bid1, bid2, bid3, ask1, ask2}) {
+        EXPECT_EQ(orderBook.processOrder(order), true);
+    }
+
+    MarketDepth<4> depth{};
+    orderBook.getDepth(depth);
+    ASSERT_EQ(depth.bidLevels, 2);
+    ASSERT_EQ(depth.askLevels, 2);
+    EXPECT_EQ(depth.bids[0], (LevelSnapshot{100, 15, 2}));
+    EXPECT_EQ(depth.bids[1], (LevelSnapshot{98, 7, 1}));
+    EXPECT_EQ(depth.asks[0], (LevelSnapshot{103, 4, 1}));
+    EXPECT_EQ(depth.asks[1], (LevelSnapshot{105, 6, 1}));
+
+    // Partial fill of the first bid, then cancel the second
+    EXPECT_EQ(orderBook.processOrder(makeOrder(Side::Sell, 100, 3)), true);
+    EXPECT_EQ(orderBook.cancelOrder(bid2.getOrderId()), true);
+
+    orderBook.getDepth(depth, 1);
+    ASSERT_EQ(depth.bidLevels, 1);
+    EXPECT_EQ(depth.bids[0], (LevelSnapshot{100, 7, 1}));
+    EXPECT_EQ(depth.asks[0], (LevelSnapshot{103, 4, 1}));
+}
+
+TEST(OrderBookTradeSinkTest, SinkSeesEveryTradeAndWindowStaysBounded) {
+    OrderBookConfig config{};
+    config.recentTrades = 2;
+    OrderBook orderBook{config};
+
+    std::vector<TradeId> streamed{};
+    orderBook.setTradeSink([&streamed](const Trade& trade) {
+        streamed.push_back(trade.getTradeId());
+    });
+
+    for (OrderId id = 1; id <= 4; ++id) {
+        EXPECT_EQ(orderBook.processOrder(Order(Side::Sell, 100 + static_cast<Price>(id), id, OrderType::Limit, 1, 1)), true);
+    }
+    EXPECT_EQ(orderBook.processOrder(Order(Side::Buy, 200, 5, OrderType::Limit, 4, 4)), true);
+
+    EXPECT_EQ(streamed, (std::vector<TradeId>{1, 2, 3, 4}));
+
+    // Window only holds the latest two, oldest first
+    const auto& trades = orderBook.getTrades();
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].getTradeId(), 3);
+    EXPECT_EQ(trades[1].getTradeId(), 4);
+    EXPECT_EQ(trades[1].getPrice(), 104);
+}
+
+TEST_F(OrderBookTest, ProcessOrdersReportsEachOutcome) {
+    std::vector<Order> burst{
+        makeOrder(Side::Sell, 105, 10),
+        makeOrder(Side::Sell, 106, 5),
+        makeOrder(Side::Buy, 105, 4),
+        makeOrder(Side::Buy, tradingValueConstants::INVALID_PRICE, 50, OrderType::Market),
+        makeOrder(Side::Buy, 100, 3),
+    };
+    burst.push_back(burst[0]); // Duplicate id
+
+    std::array<OrderResult, 8> results{};
+    EXPECT_EQ(orderBook.processOrders(burst, results), burst.size());
+
+    EXPECT_EQ(results[0].accepted, true);
+    EXPECT_EQ(results[0].state, OrderState::Processing);
+    EXPECT_EQ(results[2].accepted, true);
+    EXPECT_EQ(results[2].state, OrderState::Filled);
+    EXPECT_EQ(results[2].filledQuantity, 4);
+    EXPECT_EQ(results[3].accepted, false);
+    EXPECT_EQ(results[3].state, OrderState::Expired);
+    EXPECT_EQ(results[4].orderId, burst[4].getOrderId());
+    EXPECT_EQ(results[4].state, OrderState::Processing);
+    EXPECT_EQ(results[5].accepted, false);
+    EXPECT_EQ(results[5].state, OrderState::Processing); // The original's, still resting
+
+    EXPECT_EQ(orderBook.getBestAsk(), 105);
+    EXPECT_EQ(orderBook.getQuantityOfAsks(), 11);
+    EXPECT_EQ(orderBook.getBestBid(), 100);
+
+    // Results buffer smaller than the burst caps the work
+    std::array<OrderResult, 1> oneResult{};
+    EXPECT_EQ(orderBook.processOrders(std::vector<Order>{makeOrder(Side::Buy, 99, 1), makeOrder(Side::Buy, 98, 1)}, oneResult), 1);
+    EXPECT_EQ(orderBook.getBestBid(), 100);
+}
+
+TEST_F(OrderBookTest, ImmediateOrCancelFillsWhatItCanAndNeverRests) {
+    Order resting = makeOrder(Side::Sell, 100, 5);
+    Order tooFar = makeOrder(Side::Sell, 103, 5);
+    ASSERT_TRUE(orderBook.processOrder(resting));
+    ASSERT_TRUE(orderBook.processOrder(tooFar));
+
+    Order ioc = makeOrder(Side::Buy, 101, 8, OrderType::ImmediateOrCancel);
+    EXPECT_TRUE(orderBook.processOrder(ioc));
+
+    OrderStatus status = orderBook.reviewOrderStatus(ioc.getOrderId());
+    EXPECT_EQ(status.state, OrderState::Expired);
+    EXPECT_EQ(status.filledQuantity, 5);
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 0);
+    EXPECT_EQ(orderBook.getBestAsk(), 103);
+
+    // Nothing inside the limit, nothing traded
+    Order missed = makeOrder(Side::Buy, 101, 1, OrderType::ImmediateOrCancel);
+    EXPECT_FALSE(orderBook.processOrder(missed));
+    EXPECT_EQ(orderBook.reviewOrderStatus(missed.getOrderId()).state, OrderState::Expired);
+}
+
+TEST_F(OrderBookTest, PostOnlyRestsOrRejectsButNeverTakes) {
+    Order ask = makeOrder(Side::Sell, 105, 5);
+    ASSERT_TRUE(orderBook.processOrder(ask));
+
+    Order crossing = makeOrder(Side::Buy, 105, 5, OrderType::PostOnly);
+    EXPECT_FALSE(orderBook.processOrder(crossing));
+    EXPECT_EQ(orderBook.reviewOrderStatus(crossing.getOrderId()).state, OrderState::Rejected);
+    EXPECT_TRUE(orderBook.getTrades().empty());
+    EXPECT_EQ(orderBook.getQuantityOfAsks(), 5);
+
+    Order passive = makeOrder(Side::Buy, 104, 5, OrderType::PostOnly);
+    EXPECT_TRUE(orderBook.processOrder(passive));
+    EXPECT_EQ(orderBook.getBestBid(), 104);
+    EXPECT_EQ(orderBook.reviewOrderStatus(passive.getOrderId()).state, OrderState::Processing);
+}
+
+TEST_F(OrderBookTest, FillOrKillOnlyCountsLiquidityInsideTheLimit) {
+    Order near = makeOrder(Side::Sell, 100, 4);
+    Order far = makeOrder(Side::Sell, 110, 10);
+    ASSERT_TRUE(orderBook.processOrder(near));
+    ASSERT_TRUE(orderBook.processOrder(far));
+
+    // Enough on the book overall but not at or below 101
+    Order killed = makeOrder(Side::Buy, 101, 6, OrderType::FillOrKill);
+    EXPECT_FALSE(orderBook.processOrder(killed));
+    EXPECT_EQ(orderBook.reviewOrderStatus(killed.getOrderId()).state, OrderState::Expired);
+    EXPECT_TRUE(orderBook.getTrades().empty());
+    EXPECT_EQ(orderBook.getQuantityOfAsks(), 14);
+
+    Order filled = makeOrder(Side::Buy, 110, 6, OrderType::FillOrKill);
+    EXPECT_TRUE(orderBook.processOrder(filled));
+    EXPECT_EQ(orderBook.reviewOrderStatus(filled.getOrderId()).state, OrderState::Filled);
+    EXPECT_EQ(orderBook.getBestAsk(), 110);
+    EXPECT_EQ(orderBook.getQuantityOfAsks(), 8);
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 0);
+}
+
+TEST_F(OrderBookTest, ModifySizeDownKeepsQueuePriority) {
+    Order first = makeOrder(Side::Sell, 100, 10);
+    Order second = makeOrder(Side::Sell, 100, 10);
+    ASSERT_TRUE(orderBook.processOrder(first));
+    ASSERT_TRUE(orderBook.processOrder(second));
+
+    EXPECT_TRUE(orderBook.modifyOrder(first.getOrderId(), 4, 100));
+    EXPECT_EQ(orderBook.getQuantityOfAsks(), 14);
+    EXPECT_EQ(orderBook.reviewOrderStatus(first.getOrderId()).remainingQuantity, 4);
+
+    ASSERT_TRUE(orderBook.processOrder(makeOrder(Side::Buy, 100, 6)));
+
+    const auto& trades = orderBook.getTrades();
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].getMakerOrderId(), first.getOrderId());
+    EXPECT_EQ(trades[0].getQuantity(), 4);
+    EXPECT_EQ(trades[1].getMakerOrderId(), second.getOrderId());
+    EXPECT_EQ(trades[1].getQuantity(), 2);
+    EXPECT_EQ(orderBook.reviewOrderStatus(first.getOrderId()).state, OrderState::Filled);
+}
+
+TEST_F(OrderBookTest, ModifySizeUpGoesToBackOfLevel) {
+    Order first = makeOrder(Side::Buy, 100, 5);
+    Order second = makeOrder(Side::Buy, 100, 5);
+    ASSERT_TRUE(orderBook.processOrder(first));
+    ASSERT_TRUE(orderBook.processOrder(second));
+
+    EXPECT_TRUE(orderBook.modifyOrder(first.getOrderId(), 8, 100));
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 13);
+
+    ASSERT_TRUE(orderBook.processOrder(makeOrder(Side::Sell, 100, 5)));
+    ASSERT_EQ(orderBook.getTrades().size(), 1);
+    EXPECT_EQ(orderBook.getTrades()[0].getMakerOrderId(), second.getOrderId());
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 8);
+}
+
+TEST_F(OrderBookTest, ModifyToCrossingPriceTradesAndRestsTheRest) {
+    Order bid = makeOrder(Side::Buy, 99, 4);
+    Order ask = makeOrder(Side::Sell, 101, 5);
+    ASSERT_TRUE(orderBook.processOrder(bid));
+    ASSERT_TRUE(orderBook.processOrder(ask));
+    ASSERT_TRUE(orderBook.processOrder(makeOrder(Side::Sell, 99, 1))); // Partially fills the bid first
+
+    EXPECT_TRUE(orderBook.modifyOrder(bid.getOrderId(), 8, 101));
+
+    OrderStatus status = orderBook.reviewOrderStatus(bid.getOrderId());
+    EXPECT_EQ(status.state, OrderState::Processing);
+    EXPECT_EQ(status.price, 101);
+    EXPECT_EQ(status.filledQuantity, 6); // 1 before the modify, 5 after
+    EXPECT_EQ(status.remainingQuantity, 3);
+    EXPECT_EQ(orderBook.getBestBid(), 101);
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 3);
+    EXPECT_EQ(orderBook.getBestAsk(), 0);
+    EXPECT_EQ(orderBook.reviewOrderStatus(ask.getOrderId()).state, OrderState::Filled);
+
+    // Fully filled on the modify means it's gone from the book
+    Order ask2 = makeOrder(Side::Sell, 105, 10);
+    ASSERT_TRUE(orderBook.processOrder(ask2));
+    EXPECT_TRUE(orderBook.modifyOrder(bid.getOrderId(), 2, 105));
+    EXPECT_EQ(orderBook.reviewOrderStatus(bid.getOrderId()).state, OrderState::Filled);
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 0);
+    EXPECT_EQ(orderBook.getQuantityOfAsks(), 8);
+    EXPECT_EQ(orderBook.cancelOrder(bid.getOrderId()), false);
+}
+
+TEST_F(OrderBookTest, RejectedModifyLeavesOrderUntouched) {
+    Order ask = makeOrder(Side::Sell, 105, 5);
+    Order post = makeOrder(Side::Buy, 100, 5, OrderType::PostOnly);
+    ASSERT_TRUE(orderBook.processOrder(ask));
+    ASSERT_TRUE(orderBook.processOrder(post));
+
+    EXPECT_FALSE(orderBook.modifyOrder(post.getOrderId(), 0, 100));
+    EXPECT_FALSE(orderBook.modifyOrder(post.getOrderId(), 5, 105)); // Post only can't cross
+
+    OrderStatus status = orderBook.reviewOrderStatus(post.getOrderId());
+    EXPECT_EQ(status.state, OrderState::Processing);
+    EXPECT_EQ(status.price, 100);
+    EXPECT_EQ(orderBook.getBestBid(), 100);
+    EXPECT_EQ(orderBook.getQuantityOfBids(), 5);
+    EXPECT_TRUE(orderBook.getTrades().empty());
+}
+
+TEST_F(OrderBookTest, PartiallyFilledRestingOrderReportsLiveQuantities) {
+    Order first = makeOrder(Side::Sell, 100, 10);
+    Order middle = makeOrder(Side::Sell, 100, 10);
+    Order last = makeOrder(Side::Sell, 100, 10);
+    ASSERT_TRUE(orderBook.processOrder(first));
+    ASSERT_TRUE(orderBook.processOrder(middle));
+    ASSERT_TRUE(orderBook.processOrder(last));
+
+    ASSERT_TRUE(orderBook.processOrder(makeOrder(Side::Buy, 100, 13)));
+
+    OrderStatus status = orderBook.reviewOrderStatus(middle.getOrderId());
+    EXPECT_EQ(status.state, OrderState::Processing);
+    EXPECT_EQ(status.filledQuantity, 3);
+    EXPECT_EQ(status.remainingQuantity, 7);
+
+    // Unlinking the new head and then the tail leaves the level empty and reusable
+    EXPECT_TRUE(orderBook.cancelOrder(middle.getOrderId()));
+    EXPECT_TRUE(orderBook.cancelOrder(last.getOrderId()));
+    EXPECT_EQ(orderBook.getBestAsk(), 0);
+    EXPECT_EQ(orderBook.getQuantityOfAsks(), 0);
+    EXPECT_EQ(orderBook.reviewOrderStatus(middle.getOrderId()).filledQuantity, 3);
+
+    Order again = makeOrder(Side::Sell, 100, 2);
+    ASSERT_TRUE(orderBook.processOrder(again));
+    ASSERT_TRUE(orderBook.processOrder(makeOrder(Side::Buy, 100, 2)));
+    EXPECT_EQ(orderBook.reviewOrderStatus(again.getOrderId()).state, OrderState::Filled);
+    EXPECT_EQ(orderBook.reviewOrderStatus(again.getOrderId()).filledQuantity, 2);
+}
+
+// Test that every change to a level's total is recorded once per level touched, including levels swept away
+TEST(OrderBookLevelUpdatesTest, LevelChangesAreRecordedWhenEnabled) {
+    OrderBookConfig config{};
+    config.arenaSize = 16 * 1024 * 1024;
+    config.levelUpdates = true;
+    OrderBook book{config};
+
+    EXPECT_TRUE(book.processOrder(Order(Side::Sell, 101, 1, OrderType::Limit, 5, 5)));
+    EXPECT_TRUE(book.processOrder(Order(Side::Sell, 101, 2, OrderType::Limit, 5, 5)));
+    EXPECT_TRUE(book.processOrder(Order(Side::Sell, 102, 3, OrderType::Limit, 4, 4)));
+    EXPECT_EQ(std::vector<LevelUpdate>(book.getLevelUpdates().begin(), book.getLevelUpdates().end()), (std::vector<LevelUpdate>{
+        {Side::Sell, 101, 5}, {Side::Sell, 101, 10}, {Side::Sell, 102, 4}}));
+    book.clearLevelUpdates();
+
+    // Sweeps 101 and takes part of 102, each level shows up once with its final total
+    EXPECT_TRUE(book.processOrder(Order(Side::Buy, 102, 4, OrderType::Limit, 12, 12)));
+    EXPECT_EQ(std::vector<LevelUpdate>(book.getLevelUpdates().begin(), book.getLevelUpdates().end()), (std::vector<LevelUpdate>{
+        {Side::Sell, 101, 0}, {Side::Sell, 102, 2}}));
+    book.clearLevelUpdates();
+
+    EXPECT_TRUE(book.processOrder(Order(Side::Buy, 99, 5, OrderType::Limit, 3, 3)));
+    EXPECT_TRUE(book.modifyOrder(5, 1, 99));
+    EXPECT_TRUE(book.cancelOrder(5));
+    EXPECT_EQ(std::vector<LevelUpdate>(book.getLevelUpdates().begin(), book.getLevelUpdates().end()), (std::vector<LevelUpdate>{
+        {Side::Buy, 99, 3}, {Side::Buy, 99, 1}, {Side::Buy, 99, 0}}));
+
+    OrderBook quiet{OrderBookConfig{.arenaSize = 16 * 1024 * 1024}};
+    EXPECT_TRUE(quiet.processOrder(Order(Side::Sell, 101, 1, OrderType::Limit, 5, 5)));
+    EXPECT_TRUE(quiet.getLevelUpdates().empty());
+}
@@ -0,0 +1,106 @@
+#include <cstdlib>
+#include <deque>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "OrderBook.h"
+
+// Long running add/cancel churn to make sure the book's memory footprint stays flat once it warms up
+// Default run is short enough for ctest, for a full soak run with e.g.
+//   ORDERBOOK_SOAK_OPS=300000000 ./TestOrderBookSoak
+namespace {
+
+	uint64_t soakOperations(){
+		if(const char* env = std::getenv("ORDERBOOK_SOAK_OPS"); env != nullptr){
+			return std::stoull(env);
+		}
+		return 2'000'000;
+	}
+
+}
+
+TEST(OrderBookSoakTest, FootprintStaysFlatUnderAddCancelChurn) {
+	OrderBookConfig config{};
+	config.statusRetention = 4096;
+	config.expectedOpenOrders = 4096;
+	OrderBook orderBook{config};
+
+	const uint64_t operations {soakOperations()};
+	const uint64_t warmup {operations / 10};
+	constexpr size_t maxOpenOrders {1000};
+
+	std::deque<OrderId> openOrders{};
+	OrderId nextOrderId {1};
+	size_t baseline {};
+
+	for(uint64_t op {}; op < operations; ++op){
+		if(op == warmup){
+			baseline = orderBook.getArenaBytesUsed();
+		}
+
+		if(openOrders.size() < maxOpenOrders && (op % 3 != 0 || openOrders.empty())){
+			// Bids sit on 90..99 and asks on 101..110 so the churn never crosses
+			const OrderId id {nextOrderId++};
+			const bool isBuy {(id & 1) == 0};
+			const Price price {isBuy ? static_cast<Price>(90 + id % 10) : static_cast<Price>(101 + id % 10)};
+			ASSERT_TRUE(orderBook.processOrder(Order(isBuy ? Side::Buy : Side::Sell, price, id, OrderType::Limit, 1 + id % 50, 1 + id % 50)));
+			openOrders.push_back(id);
+		}
+		else{
+			ASSERT_TRUE(orderBook.cancelOrder(openOrders.front()));
+			openOrders.pop_front();
+		}
+	}
+
+	EXPECT_EQ(orderBook.getArenaBytesUsed(), baseline);
+	EXPECT_EQ(orderBook.reviewOrderStatus(nextOrderId - 1).state, OrderState::Processing);
+}
+
+TEST(OrderBookSoakTest, FootprintStaysFlatWhileTrading) {
+	OrderBookConfig config{};
+	config.statusRetention = 4096;
+	config.expectedOpenOrders = 4096;
+	config.recentTrades = 1024;
+	OrderBook orderBook{config};
+
+	uint64_t tradeCount {};
+	orderBook.setTradeSink([&tradeCount](const Trade&){ ++tradeCount; });
+
+	const uint64_t operations {soakOperations()};
+	const uint64_t warmup {operations / 10};
+	size_t baseline {};
+
+	// Resting sells at a few prices get lifted by buys that sweep one or two levels
+	for(OrderId id {1}; id <= operations; ++id){
+		if(id == warmup){
+			baseline = orderBook.getArenaBytesUsed();
+		}
+
+		if(id % 4 != 0){
+			ASSERT_TRUE(orderBook.processOrder(Order(Side::Sell, static_cast<Price>(100 + id % 3), id, OrderType::Limit, 5, 5)));
+		}
+		else{
+			ASSERT_TRUE(orderBook.processOrder(Order(Side::Buy, 102, id, OrderType::Limit, 15, 15)));
+		}
+	}
+
+	EXPECT_EQ(orderBook.getArenaBytesUsed(), baseline);
+	EXPECT_GT(tradeCount, operations / 2);
+	EXPECT_EQ(orderBook.getTrades().size(), 1024);
+}
+
+TEST(OrderBookSoakTest, OldestFinishedStatusesAreDropped) {
+	OrderBookConfig config{};
+	config.statusRetention = 2;
+	OrderBook orderBook{config};
+
+	for(OrderId id {1}; id <= 3; ++id){
+		ASSERT_TRUE(orderBook.processOrder(Order(Side::Buy, 100, id, OrderType::Limit, 10, 10)));
+		ASSERT_TRUE(orderBook.cancelOrder(id));
+	}
+
+	// Order 1 fell out of the retention window, the newer two are still reviewable
+	EXPECT_EQ(orderBook.reviewOrderStatus(1).side, Side::Unknown);
+	EXPECT_EQ(orderBook.reviewOrderStatus(2).state, OrderState::Cancelled);
+	EXPECT_EQ(orderBook.reviewOrderStatus(3).state, OrderState::Cancelled);
+}
@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+#include "OrderEntryServer.h"
+#include "BinaryProtocol.h"
+
+#include <array>
+#include <chrono>
+#include <format>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using boost::asio::ip::tcp;
+
+// Runs an OrderEntryServer on its own io_context thread and records every message it hands over
+class OrderEntryServerTest : public ::testing::Test {
+protected:
+    boost::asio::io_context ioContext{1};
+    std::unique_ptr<OrderEntryServer> server;
+    std::thread network;
+    std::mutex mutex;
+    std::vector<std::pair<SessionId, std::string>> messages;
+    std::vector<uint32_t> numbers; // Session::getMessageCount as each message was handled
+
+    void start(OrderEntryConfig config = {}) {
+        config.address = "127.0.0.1";
+        config.port = 0;
+        server = std::make_unique<OrderEntryServer>(ioContext, config, [this](Session& session, std::string_view message) {
+            std::lock_guard lock{mutex};
+            messages.emplace_back(session.getId(), std::string{message});
+            numbers.push_back(session.getMessageCount());
+        });
+        network = std::thread{[this] { ioContext.run(); }};
+    }
+
+    // Runs fn on the network thread and waits for it, the server is only ever touched from there
+    template <typename Fn>
+    auto onServer(Fn fn) {
+        std::packaged_task<decltype(fn())()> task{fn};
+        auto result = task.get_future();
+        boost::asio::post(ioContext, [&task] { task(); });
+        return result.get();
+    }
+
+    void TearDown() override {
+        if (server) {
+            onServer([this] { server->stop(); });
+        }
+        ioContext.stop();
+        if (network.joinable()) {
+            network.join();
+        }
+    }
+
+    tcp::socket connect() {
+        tcp::socket socket{clients};
+        socket.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), server->getPort()));
+        return socket;
+    }
+
+    static void send(tcp::socket& socket, std::string_view data) {
+        boost::asio::write(socket, boost::asio::buffer(data.data(), data.size()));
+    }
+
+    bool waitForMessages(size_t count) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline) {
+            {
+                std::lock_guard lock{mutex};
+                if (messages.size() >= count) {
+                    return true;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    template <typename Predicate>
+    bool waitForServer(Predicate predicate) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (onServer([&] { return predicate(*server); })) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    std::vector<std::string> texts() {
+        std::lock_guard lock{mutex};
+        std::vector<std::string> result;
+        for (const auto& [session, text] : messages) {
+            result.push_back(text);
+        }
+        return result;
+    }
+
+private:
+    boost::asio::io_context clients;
+};
+
+// Test that messages split over several reads or packed into one come out whole, and the session stays open
+TEST_F(OrderEntryServerTest, MessagesAreFramedAcrossReads) {
+    start();
+    tcp::socket client = connect();
+
+    send(client, "BUY LIMIT 1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    send(client, "00 50\nSELL");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    send(client, " MARKET 3 4\r\n\nCANCEL 5\n");
+    ASSERT_TRUE(waitForMessages(3));
+    send(client, "MODIFY 5 100 1\n");
+    ASSERT_TRUE(waitForMessages(4));
+
+    EXPECT_EQ(texts(), (std::vector<std::string>{"BUY LIMIT 100 50", "SELL MARKET 3 4", "CANCEL 5", "MODIFY 5 100 1"}));
+    EXPECT_EQ(numbers, (std::vector<uint32_t>{1, 2, 3, 4})); // The blank line isn't a message
+    EXPECT_EQ(onServer([this] { return server->getSessionCount(); }), 1);
+    const OrderEntryStats stats = onServer([this] { return server->getStats(); });
+    EXPECT_EQ(stats.sessionsAccepted, 1);
+    EXPECT_EQ(stats.messages, 4);
+}
+
+// Test that many clients can stay connected at once and their messages are told apart by session
+TEST_F(OrderEntryServerTest, ManyConcurrentSessions) {
+    start();
+    constexpr size_t clientCount = 200;
+    constexpr size_t perClient = 5;
+    std::vector<tcp::socket> clients;
+    for (size_t i = 0; i < clientCount; ++i) {
+        clients.push_back(connect());
+    }
+    for (size_t round = 0; round < perClient; ++round) {
+        for (size_t i = 0; i < clientCount; ++i) {
+            send(clients[i], std::format("C{} BUY LIMIT 100 {}\n", i, round + 1));
+        }
+    }
+    ASSERT_TRUE(waitForMessages(clientCount * perClient));
+    EXPECT_EQ(onServer([this] { return server->getSessionCount(); }), clientCount);
+
+    // Every session's messages arrive in the order it sent them
+    std::lock_guard lock{mutex};
+    std::unordered_map<SessionId, std::vector<std::string>> perSession;
+    for (const auto& [session, text] : messages) {
+        perSession[session].push_back(text);
+    }
+    ASSERT_EQ(perSession.size(), clientCount);
+    for (const auto& [session, texts] : perSession) {
+        ASSERT_EQ(texts.size(), perClient);
+        for (size_t round = 0; round < perClient; ++round) {
+            EXPECT_TRUE(texts[round].ends_with(std::format("100 {}", round + 1))) << texts[round];
+        }
+    }
+}
+
+// Test that a message longer than the receive buffer is dropped up to its newline without closing the session
+TEST_F(OrderEntryServerTest, OversizedMessagesAreDropped) {
+    start(OrderEntryConfig{.receiveBufferSize = 16});
+    tcp::socket client = connect();
+    send(client, std::string(40, 'x'));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    send(client, "yyy\nBUY MARKET 1 2\n");
+    ASSERT_TRUE(waitForMessages(1));
+    EXPECT_EQ(texts(), (std::vector<std::string>{"BUY MARKET 1 2"}));
+    EXPECT_EQ(onServer([this] { return server->getStats().oversized; }), 1);
+}
+
+// Test that a client sending one message without a newline and hanging up still gets it through
+TEST_F(OrderEntryServerTest, LastMessageWithoutNewlineCountsOnClose) {
+    start();
+    {
+        tcp::socket client = connect();
+        send(client, "BUY LIMIT 100 50");
+    }
+    ASSERT_TRUE(waitForMessages(1));
+    EXPECT_EQ(texts(), (std::vector<std::string>{"BUY LIMIT 100 50"}));
+    EXPECT_TRUE(waitForServer([](const OrderEntryServer& s) { return s.getSessionCount() == 0 && s.getStats().sessionsClosed == 1; }));
+}
+
+// Test that connections past maxSessions are closed right away
+TEST_F(OrderEntryServerTest, SessionsPastTheLimitAreRefused) {
+    start(OrderEntryConfig{.maxSessions = 2});
+    tcp::socket first = connect();
+    tcp::socket second = connect();
+    ASSERT_TRUE(waitForServer([](const OrderEntryServer& s) { return s.getSessionCount() == 2; }));
+
+    tcp::socket third = connect();
+    std::array<char, 8> buffer{};
+    boost::system::error_code error;
+    (void)third.read_some(boost::asio::buffer(buffer), error);
+    EXPECT_EQ(error, boost::asio::error::eof);
+    EXPECT_EQ(onServer([this] { return server->getStats().sessionsRefused; }), 1);
+    EXPECT_EQ(onServer([this] { return server->getSessionCount(); }), 2);
+}
+
+// Test that binary sessions are framed by the length in the header, however the bytes are split across reads
+TEST_F(OrderEntryServerTest, BinaryMessagesAreFramedByLength) {
+    start(OrderEntryConfig{.protocol = OrderEntryProtocol::Binary});
+    tcp::socket client = connect();
+
+    std::string stream;
+    stream += asBytes(makeBinaryNewOrder(1, "AAPL", Side::Buy, OrderType::Limit, 100, 50));
+    stream += asBytes(makeBinaryCancel(2, "AAPL", 7));
+    stream += asBytes(makeBinaryModify(3, "", 8, 101, 2));
+    send(client, std::string_view(stream).substr(0, 3)); // Not even a whole header
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    send(client, std::string_view(stream).substr(3, 50));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    send(client, std::string_view(stream).substr(53));
+    ASSERT_TRUE(waitForMessages(3));
+
+    const std::vector<std::string> received = texts();
+    ASSERT_EQ(received.size(), 3);
+    EXPECT_EQ(received[0], asBytes(makeBinaryNewOrder(1, "AAPL", Side::Buy, OrderType::Limit, 100, 50)));
+    EXPECT_EQ(received[1], asBytes(makeBinaryCancel(2, "AAPL", 7)));
+    EXPECT_EQ(received[2], asBytes(makeBinaryModify(3, "", 8, 101, 2)));
+    EXPECT_EQ(onServer([this] { return server->getSessionCount(); }), 1);
+}
+
+// Test that a length shorter than the header or longer than the buffer closes the session, there's no resyncing
+TEST_F(OrderEntryServerTest, BinarySessionsWithBadLengthsAreClosed) {
+    start(OrderEntryConfig{.receiveBufferSize = 64, .protocol = OrderEntryProtocol::Binary});
+    for (const uint16_t length : {uint16_t{2}, uint16_t{65}}) {
+        tcp::socket client = connect();
+        BinaryNewOrder order = makeBinaryNewOrder(1, "AAPL", Side::Buy, OrderType::Limit, 100, 50);
+        order.header.length = length;
+        send(client, asBytes(order));
+        std::array<char, 8> buffer{};
+        boost::system::error_code error;
+        (void)client.read_some(boost::asio::buffer(buffer), error);
+        EXPECT_EQ(error, boost::asio::error::eof);
+    }
+    EXPECT_EQ(onServer([this] { return server->getStats().badFraming; }), 2);
+    EXPECT_EQ(texts().size(), 0);
+}
+
+// Test that replies queued between flushes go out in one write, in order, and only to their own session
+TEST_F(OrderEntryServerTest, RepliesAreCoalescedUntilFlush) {
+    start();
+    tcp::socket client = connect();
+    tcp::socket other = connect();
+    send(client, "HELLO\n");
+    send(other, "HELLO\n");
+    ASSERT_TRUE(waitForMessages(2));
+
+    const SessionId id = messages[0].first;
+    onServer([this, id] {
+        for (int i = 0; i < 100; ++i) {
+            server->send(id, std::format("REPLY {}\n", i));
+        }
+        server->send(0, "NOBODY\n");
+        server->flush();
+    });
+
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        expected += std::format("REPLY {}\n", i);
+    }
+    std::string received(expected.size(), '\0');
+    boost::asio::read(client, boost::asio::buffer(received));
+    EXPECT_EQ(received, expected);
+    EXPECT_EQ(other.available(), 0);
+
+    // The client can have it all before the write's completion handler counts it
+    const size_t size = expected.size();
+    EXPECT_TRUE(waitForServer([size](const OrderEntryServer& s) { return s.getStats().bytesSent >= size; }));
+    const OrderEntryStats stats = onServer([this] { return server->getStats(); });
+    EXPECT_EQ(stats.writes, 1);
+    EXPECT_EQ(stats.bytesSent, expected.size());
+}
+
+// Test that a client whose replies don't fit in its send buffer is disconnected instead of queued without limit
+TEST_F(OrderEntryServerTest, SlowConsumersAreDisconnected) {
+    start(OrderEntryConfig{.sendBufferSize = 64});
+    tcp::socket client = connect();
+    send(client, "HELLO\n");
+    ASSERT_TRUE(waitForMessages(1));
+
+    const SessionId id = messages[0].first;
+    onServer([this, id] {
+        server->send(id, std::string(40, 'x'));
+        server->send(id, std::string(40, 'y')); // Nothing was flushed, 80 bytes don't fit
+        server->flush();
+    });
+
+    EXPECT_TRUE(waitForServer([](const OrderEntryServer& s) { return s.getSessionCount() == 0; }));
+    EXPECT_EQ(onServer([this] { return server->getStats().slowConsumers; }), 1);
+}
+
+// Test that a session out of credits isn't framed or read any further and picks up where it stopped once released
+TEST_F(OrderEntryServerTest, SessionsStallWithoutCredits) {
+    start(OrderEntryConfig{.creditWindow = 2});
+    tcp::socket client = connect();
+    send(client, "ONE\nTWO\nTHREE\nFOUR\nFIVE\n");
+    ASSERT_TRUE(waitForMessages(2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(texts().size(), 2);
+    EXPECT_EQ(onServer([this] { return server->getStats().creditStalls; }), 1);
+
+    const SessionId id = messages[0].first;
+    onServer([this, id] { server->release(id); });
+    ASSERT_TRUE(waitForMessages(3));
+    onServer([this, id] { server->release(id, 2); });
+    ASSERT_TRUE(waitForMessages(5));
+
+    // Partial messages still get completed by later reads after a stall
+    send(client, "SI");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    onServer([this, id] { server->release(id, 3); });
+    send(client, "X\n");
+    ASSERT_TRUE(waitForMessages(6));
+    EXPECT_EQ(texts(), (std::vector<std::string>{"ONE", "TWO", "THREE", "FOUR", "FIVE", "SIX"}));
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "OrderParser.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+ParseError parse(std::string_view message) {
+    ParsedMessage parsed{};
+    return parseMessage(message, parsed);
+}
+
+}
+
+// Test that every order type parses, with and without a symbol
+TEST(OrderParserTest, NewOrders) {
+    ParsedMessage parsed{};
+    ASSERT_EQ(parseMessage("BUY LIMIT 100 50", parsed), ParseError::None);
+    EXPECT_EQ(parsed.kind, MessageKind::NewOrder);
+    EXPECT_TRUE(parsed.symbol.empty());
+    EXPECT_EQ(parsed.side, Side::Buy);
+    EXPECT_EQ(parsed.type, OrderType::Limit);
+    EXPECT_EQ(parsed.price, 100);
+    EXPECT_EQ(parsed.quantity, 50);
+
+    ASSERT_EQ(parseMessage("  AAPL\tSELL   FOK 4294967295 7 \r", parsed), ParseError::None);
+    EXPECT_EQ(parsed.symbol, "AAPL");
+    EXPECT_EQ(parsed.side, Side::Sell);
+    EXPECT_EQ(parsed.type, OrderType::FillOrKill);
+    EXPECT_EQ(parsed.price, 4294967295u);
+    EXPECT_EQ(parsed.quantity, 7);
+
+    const std::vector<std::pair<std::string_view, OrderType>> types{
+        {"BUY MARKET 1 1", OrderType::Market},
+        {"BUY IOC 1 1", OrderType::ImmediateOrCancel},
+        {"BUY POST 1 1", OrderType::PostOnly},
+    };
+    for (const auto& [message, type] : types) {
+        ASSERT_EQ(parseMessage(message, parsed), ParseError::None) << message;
+        EXPECT_EQ(parsed.type, type) << message;
+    }
+}
+
+// Test that cancels and modifies carry the order id
+TEST(OrderParserTest, CancelsAndModifies) {
+    ParsedMessage parsed{};
+    ASSERT_EQ(parseMessage("MSFT CANCEL 18446744073709551615", parsed), ParseError::None);
+    EXPECT_EQ(parsed.kind, MessageKind::Cancel);
+    EXPECT_EQ(parsed.symbol, "MSFT");
+    EXPECT_EQ(parsed.orderId, 18446744073709551615ull);
+
+    ASSERT_EQ(parseMessage("MODIFY 42 101 3", parsed), ParseError::None);
+    EXPECT_EQ(parsed.kind, MessageKind::Modify);
+    EXPECT_EQ(parsed.orderId, 42);
+    EXPECT_EQ(parsed.price, 101);
+    EXPECT_EQ(parsed.quantity, 3);
+}
+
+// Test that malformed input is turned down with the reason, nothing falls back to a default side or type
+TEST(OrderParserTest, MalformedInputHasAReason) {
+    EXPECT_EQ(parse(""), ParseError::Empty);
+    EXPECT_EQ(parse(" \t "), ParseError::Empty);
+    EXPECT_EQ(parse("AAPL HOLD LIMIT 1 1"), ParseError::UnknownVerb);
+    EXPECT_EQ(parse("buy LIMIT 1 1"), ParseError::UnknownVerb);
+    EXPECT_EQ(parse("BUY STOP 1 1"), ParseError::UnknownOrderType);
+    EXPECT_EQ(parse("BUY"), ParseError::MissingField);
+    EXPECT_EQ(parse("AAPL"), ParseError::MissingField);
+    EXPECT_EQ(parse("BUY LIMIT 100"), ParseError::MissingField);
+    EXPECT_EQ(parse("BUY LIMIT -100 5"), ParseError::BadPrice);
+    EXPECT_EQ(parse("BUY LIMIT 4294967296 5"), ParseError::BadPrice);
+    EXPECT_EQ(parse("BUY LIMIT 1e3 5"), ParseError::BadPrice);
+    EXPECT_EQ(parse("BUY LIMIT 100 0"), ParseError::BadQuantity);
+    EXPECT_EQ(parse("BUY LIMIT 100 5x"), ParseError::BadQuantity);
+    EXPECT_EQ(parse("CANCEL abc"), ParseError::BadOrderId);
+    EXPECT_EQ(parse("CANCEL"), ParseError::MissingField);
+    EXPECT_EQ(parse("MODIFY 1 100"), ParseError::MissingField);
+    EXPECT_EQ(parse("BUY LIMIT 100 5 extra"), ParseError::TrailingInput);
+    EXPECT_EQ(parse("CANCEL 1 2"), ParseError::TrailingInput);
+    EXPECT_EQ(parse("ABCDEFGHIJKLMNOPQ BUY LIMIT 1 1"), ParseError::SymbolTooLong);
+    EXPECT_EQ(parse("ABCDEFGHIJKLMNOP BUY LIMIT 1 1"), ParseError::None);
+    EXPECT_EQ(parse("AA\x01L BUY LIMIT 1 1"), ParseError::BadSymbol);
+    EXPECT_EQ(parse("\xC3\xA9 BUY LIMIT 1 1"), ParseError::BadSymbol);
+    EXPECT_EQ(toString(ParseError::BadPrice), "bad price");
+}
+
+// Test that symbols are printable ASCII without spaces and short enough, empty being the default book
+TEST(OrderParserTest, ValidSymbols) {
+    EXPECT_TRUE(isValidSymbol(""));
+    EXPECT_TRUE(isValidSymbol("BRK.B"));
+    EXPECT_TRUE(isValidSymbol("ABCDEFGHIJKLMNOP"));
+    EXPECT_FALSE(isValidSymbol("ABCDEFGHIJKLMNOPQ"));
+    EXPECT_FALSE(isValidSymbol("A B"));
+    EXPECT_FALSE(isValidSymbol(" A"));
+    EXPECT_FALSE(isValidSymbol(std::string_view("A\0B", 3)));
+    EXPECT_FALSE(isValidSymbol("A\x7F"));
+    EXPECT_FALSE(isValidSymbol("\xC3\xA9"));
+}
+
+// Test that the symbol view points into the message instead of a copy
+TEST(OrderParserTest, SymbolIsAViewIntoTheMessage) {
+    const std::string message = "GOOG BUY LIMIT 1 1";
+    ParsedMessage parsed{};
+    ASSERT_EQ(parseMessage(message, parsed), ParseError::None);
+    EXPECT_EQ(parsed.symbol.data(), message.data());
+}
+
+// Test that the newline scans agree everywhere, including past the 16 byte blocks
+TEST(OrderParserTest, NewlineScansAgree) {
+    for (size_t length = 0; length < 70; ++length) {
+        for (size_t position = 0; position <= length; ++position) {
+            std::string text(length, 'x');
+            if (position < length) {
+                text[position] = '\n';
+            }
+            const char* begin = text.data();
+            const char* end = begin + text.size();
+            const char* expected = begin + position;
+            EXPECT_EQ(findNewlineScalar(begin, end), expected);
+            EXPECT_EQ(findNewline(begin, end), expected);
+#if defined(__SSE2__)
+            EXPECT_EQ(findNewlineSse2(begin, end), expected);
+#endif
+        }
+    }
+}
+
+// Test that a buffer with several messages and an unfinished one is split right
+TEST(OrderParserTest, SeveralMessagesPerBuffer) {
+    const std::string_view buffer = "BUY LIMIT 1 1\r\n\nSELL MARKET 2 2\nCANCEL 3\nMODIFY 4";
+    std::vector<std::string_view> lines;
+    const size_t used = forEachMessage(buffer, [&lines](std::string_view line) { lines.push_back(line); });
+    EXPECT_EQ(lines, (std::vector<std::string_view>{"BUY LIMIT 1 1", "SELL MARKET 2 2", "CANCEL 3"}));
+    EXPECT_EQ(buffer.substr(used), "MODIFY 4");
+    EXPECT_EQ(forEachMessage("", [](std::string_view) { FAIL(); }), 0);
+}
@@ -4,14 +4,33 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <functional>
+#include <array>
+#include <vector>
+#include <algorithm>
 
 // Create a test harness class that extends Pipeline to access protected submit method
-class TestPipelineHarness : public Pipeline {
+// Messages are plain callables here so the tests can check what ran where
+class TestPipelineHarness : public Pipeline<TestPipelineHarness, std::function<void()>> {
 public:
+    TestPipelineHarness() = default;
+    explicit TestPipelineHarness(const PipelineConfig& config) : Pipeline(config) {}
+
+    void handleMessage(const Stage&, size_t, std::function<void()>& task) {
+        task();
+    }
+
     template <typename T>
     void submitTask(const Stage& stage, T&& task) {
-        submit(stage, std::forward<T>(task));
+        submit(stage, std::function<void()>(std::forward<T>(task)));
+    }
+
+    template <typename T>
+    void submitTask(const Stage& stage, size_t lane, T&& task) {
+        submit(stage, lane, std::function<void()>(std::forward<T>(task)));
     }
+
+    using Pipeline::getMatchingShards;
 };
 
 class PipelineTest : public ::testing::Test {
@@ -204,4 +223,207 @@ TEST_F(PipelineTest, TaskCompletionIsConsistent) {
     
     std::this_thread::sleep_for(std::chrono::milliseconds(200));
     EXPECT_EQ(value, 20);
-}
\ No newline at end of file
+}
+// Test that every matching shard has its own thread and keeps its own order
+TEST(PipelineShardTest, MatchingShardsRunOnTheirOwnThreadsInOrder) {
+    constexpr size_t shards = 3;
+    std::array<std::vector<int>, shards> seen;
+    std::array<std::thread::id, shards> threadIds;
+    std::atomic<int> logged(0);
+
+    {
+        TestPipelineHarness pipeline{PipelineConfig{.matchingShards = shards}};
+        EXPECT_EQ(pipeline.getMatchingShards(), shards);
+
+        for (int i = 0; i < 100; ++i) {
+            const size_t shard = static_cast<size_t>(i) % shards;
+            pipeline.submitTask(Stage::Matching, shard, [&seen, &threadIds, shard, i]() {
+                seen[shard].push_back(i);
+                threadIds[shard] = std::this_thread::get_id();
+            });
+        }
+        for (size_t shard = 0; shard < shards; ++shard) {
+            pipeline.submitTask(Stage::Logger, shard, [&logged]() { logged++; });
+        }
+        // Destructor drains everything
+    }
+
+    for (size_t shard = 0; shard < shards; ++shard) {
+        ASSERT_FALSE(seen[shard].empty());
+        EXPECT_TRUE(std::is_sorted(seen[shard].begin(), seen[shard].end()));
+    }
+    EXPECT_NE(threadIds[0], threadIds[1]);
+    EXPECT_NE(threadIds[1], threadIds[2]);
+    EXPECT_EQ(logged, static_cast<int>(shards));
+}
+
+// Test that matching work still reaches the logger when the pipeline shuts down right away
+TEST(PipelineShardTest, ShutdownDrainsStagesInOrder) {
+    std::atomic<int> logged(0);
+    {
+        TestPipelineHarness pipeline{PipelineConfig{.matchingShards = 2}};
+        for (int i = 0; i < 200; ++i) {
+            const size_t shard = static_cast<size_t>(i) % 2;
+            pipeline.submitTask(Stage::Matching, shard, [&pipeline, &logged, shard]() {
+                pipeline.submitTask(Stage::Logger, shard, [&logged]() { logged++; });
+            });
+        }
+    }
+    EXPECT_EQ(logged, 200);
+}
+
+namespace {
+PipelineConfig configWith(WaitStrategy strategy) {
+    PipelineConfig config{.matchingShards = 2};
+    config.sequencer.waitStrategy = strategy;
+    config.matching.waitStrategy = strategy;
+    config.logger.waitStrategy = strategy;
+    config.matching.spinCount = 16;
+    return config;
+}
+
+constexpr std::array<WaitStrategy, 4> waitStrategies {
+    WaitStrategy::BusySpin, WaitStrategy::SpinYield, WaitStrategy::SpinPark, WaitStrategy::Blocking
+};
+
+// Polls instead of sleeping a fixed time so a missed wake up shows as a failure rather than a hang
+bool waitFor(const std::atomic<int>& counter, int expected) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (counter.load() < expected && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return counter.load() >= expected;
+}
+}
+
+// Test that every wait strategy delivers messages through all stages and drains on shutdown
+TEST(PipelineWaitStrategyTest, EveryStrategyDeliversAndDrains) {
+    for (WaitStrategy strategy : waitStrategies) {
+        std::atomic<int> logged(0);
+        {
+            TestPipelineHarness pipeline{configWith(strategy)};
+            for (int i = 0; i < 100; ++i) {
+                const size_t shard = static_cast<size_t>(i) % 2;
+                pipeline.submitTask(Stage::Sequencer, [&pipeline, &logged, shard]() {
+                    pipeline.submitTask(Stage::Matching, shard, [&pipeline, &logged, shard]() {
+                        pipeline.submitTask(Stage::Logger, shard, [&logged]() { logged++; });
+                    });
+                });
+            }
+        }
+        EXPECT_EQ(logged, 100) << "strategy " << static_cast<int>(strategy);
+    }
+}
+
+// Test that workers which went to sleep on empty lanes are woken up by later messages
+TEST(PipelineWaitStrategyTest, ParkedWorkersWakeUpForNewMessages) {
+    for (WaitStrategy strategy : {WaitStrategy::SpinPark, WaitStrategy::Blocking}) {
+        std::atomic<int> handled(0);
+        TestPipelineHarness pipeline{configWith(strategy)};
+        for (int round = 1; round <= 5; ++round) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Long enough for every worker to park
+            pipeline.submitTask(Stage::Matching, 1, [&handled]() { handled++; });
+            pipeline.submitTask(Stage::Logger, 0, [&handled]() { handled++; });
+            EXPECT_TRUE(waitFor(handled, round * 2)) << "strategy " << static_cast<int>(strategy) << " round " << round;
+        }
+    }
+}
+
+// Test that pinning and SCHED_FIFO requests that can't be honoured leave the pipeline working
+TEST(PipelineWaitStrategyTest, UnavailablePinningAndPriorityAreIgnored) {
+    std::atomic<int> handled(0);
+    PipelineConfig config{};
+    config.matching.core = 1023; // No such core here, pthread_setaffinity_np refuses it
+    config.logger.waitStrategy = WaitStrategy::Blocking; // A realtime spinner could starve the test thread if it is allowed
+    config.logger.fifoPriority = 1;
+    TestPipelineHarness pipeline{config};
+    pipeline.submitTask(Stage::Matching, [&handled]() { handled++; });
+    pipeline.submitTask(Stage::Logger, [&handled]() { handled++; });
+    EXPECT_TRUE(waitFor(handled, 2));
+}
+
+// Records how the worker split the messages into batches. -1 holds the worker until release() so the rest queue up
+class BatchRecordingHarness : public Pipeline<BatchRecordingHarness, int> {
+private:
+    friend class Pipeline<BatchRecordingHarness, int>;
+
+    std::atomic<bool> released_{false};
+    size_t currentBatch_ = 0;
+
+    void handleMessage(const Stage&, size_t, int value) {
+        if (value < 0) {
+            while (!released_.load()) {
+                std::this_thread::yield();
+            }
+        } else {
+            handled.push_back(value);
+        }
+        ++currentBatch_;
+    }
+
+    void handleBatchEnd(const Stage& stage, size_t) {
+        if (stage == Stage::Matching) {
+            batchSizes.push_back(currentBatch_);
+        }
+        currentBatch_ = 0;
+    }
+
+public:
+    std::vector<int> handled;
+    std::vector<size_t> batchSizes;
+
+    explicit BatchRecordingHarness(const PipelineConfig& config) : Pipeline(config) {}
+
+    void send(int value) { submit(Stage::Matching, value); }
+    bool trySend(int value) { return trySubmit(Stage::Matching, 0, value); }
+    size_t depth() { return getQueueDepth(Stage::Matching, 0); }
+    void release() { released_ = true; }
+    void drain() { stop(); }
+};
+
+// Test that queued messages are handled in order in batches no bigger than the cap, each followed by the hook
+TEST(PipelineBatchTest, LanesDrainInCappedBatchesWithBatchEndHook) {
+    PipelineConfig config{};
+    config.matching.maxBatch = 4;
+    BatchRecordingHarness pipeline{config};
+
+    pipeline.send(-1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Worker is now stuck on the first message
+    for (int i = 0; i < 10; ++i) {
+        pipeline.send(i);
+    }
+    pipeline.release();
+    pipeline.drain();
+
+    ASSERT_EQ(pipeline.handled.size(), 10);
+    EXPECT_TRUE(std::is_sorted(pipeline.handled.begin(), pipeline.handled.end()));
+
+    size_t total = 0;
+    for (size_t size : pipeline.batchSizes) {
+        EXPECT_GE(size, 1);
+        EXPECT_LE(size, 4);
+        total += size;
+    }
+    EXPECT_EQ(total, 11);
+    EXPECT_GE(pipeline.batchSizes.size(), 3); // 11 messages can't fit in fewer batches of 4
+}
+
+// Test that trySubmit turns a full lane down instead of waiting and the producer sees how deep the lane is
+TEST(PipelineBatchTest, TrySubmitGivesUpOnAFullLane) {
+    PipelineConfig config{};
+    config.queueCapacity = 4;
+    BatchRecordingHarness pipeline{config};
+
+    pipeline.send(-1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Popped, the lane is empty again
+    EXPECT_EQ(pipeline.depth(), 0);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(pipeline.trySend(i));
+    }
+    EXPECT_EQ(pipeline.depth(), 4);
+    EXPECT_FALSE(pipeline.trySend(4));
+
+    pipeline.release();
+    pipeline.drain();
+    EXPECT_EQ(pipeline.handled, (std::vector<int>{0, 1, 2, 3}));
+}
@@ -2,6 +2,17 @@
 #include "TradingSystem.h"
 #include <thread>
 #include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
 
 class TradingSystemTest : public ::testing::Test {
 
@@ -51,4 +62,567 @@ TEST_F(TradingSystemTest, RapidConstructionDestructionCycles) {
             std::this_thread::sleep_for(std::chrono::milliseconds(50));
         }
     });
-}
\ No newline at end of file
+}
+// Test that clients keep their connections open and every order they send over them reaches the books
+TEST_F(TradingSystemTest, PersistentSessionsFeedTheEngine) {
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_system_sessions.bin").string();
+    TradingSystemConfig config{};
+    config.orderEntry.address = "127.0.0.1";
+    config.orderEntry.port = 0;
+    config.binaryEntry.address = "127.0.0.1";
+    config.binaryEntry.port = 0;
+    config.journal.path = path;
+    config.journal.truncate = true;
+    config.journal.fsync = JournalFsync::Never;
+
+    constexpr size_t clientCount = 3;
+    constexpr size_t perClient = 10;
+    {
+        TradingSystem tradingSystem{config};
+        std::thread network{[&tradingSystem] { tradingSystem.startServer(); }};
+        while (tradingSystem.getListeningPort() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        boost::asio::io_context clients;
+        std::vector<tcp::socket> sockets;
+        for (size_t i = 0; i < clientCount; ++i) {
+            sockets.emplace_back(clients).connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getListeningPort()));
+        }
+        for (size_t order = 0; order < perClient; ++order) {
+            for (tcp::socket& socket : sockets) {
+                boost::asio::write(socket, boost::asio::buffer(std::string_view{"SESS BUY LIMIT 100 1\n"}));
+            }
+        }
+
+        // Resting buys are all accepted, so they all end up in the journal
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::filesystem::file_size(path) < clientCount * perClient * sizeof(JournalRecord) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        tradingSystem.stopServer();
+        network.join();
+    }
+
+    JournalReader reader{path};
+    JournalRecord record{};
+    size_t orders = 0;
+    while (reader.next(record)) {
+        orders += record.type == JournalRecordType::NewOrder ? 1 : 0;
+    }
+    EXPECT_EQ(orders, clientCount * perClient);
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".symbols");
+}
+
+// Test that binary messages take the same path as text ones, same symbols, same order ids, bad ones turned down
+TEST_F(TradingSystemTest, BinarySessionsShareTheSequencer) {
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_system_binary.bin").string();
+    TradingSystemConfig config{};
+    config.orderEntry.address = "127.0.0.1";
+    config.orderEntry.port = 0;
+    config.binaryEntry.address = "127.0.0.1";
+    config.binaryEntry.port = 0;
+    config.journal.path = path;
+    config.journal.truncate = true;
+    config.journal.fsync = JournalFsync::Never;
+
+    const auto waitForRecords = [&path](size_t count) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::filesystem::file_size(path) < count * sizeof(JournalRecord) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    {
+        TradingSystem tradingSystem{config};
+        std::thread network{[&tradingSystem] { tradingSystem.startServer(); }};
+        while (tradingSystem.getListeningPort() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        boost::asio::io_context clients;
+        tcp::socket text{clients};
+        text.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getListeningPort()));
+        tcp::socket binary{clients};
+        binary.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getBinaryListeningPort()));
+
+        boost::asio::write(text, boost::asio::buffer(std::string_view{"BIN BUY LIMIT 100 5\n"}));
+        waitForRecords(1);
+
+        // Order 1 came in as text, the binary session cancels it and adds order 2
+        std::string messages;
+        messages += asBytes(makeBinaryCancel(7, "BIN", 1));
+        BinaryNewOrder badSide = makeBinaryNewOrder(8, "BIN", Side::Buy, OrderType::Limit, 99, 1);
+        badSide.side = 'Q';
+        messages += asBytes(badSide);
+        messages += asBytes(makeBinaryNewOrder(9, "BIN", Side::Sell, OrderType::Limit, 105, 3));
+        messages += asBytes(makeBinaryModify(10, "BIN", 2, 104, 2));
+        boost::asio::write(binary, boost::asio::buffer(messages));
+        waitForRecords(4);
+
+        tradingSystem.stopServer();
+        network.join();
+    }
+
+    JournalReader reader{path};
+    std::vector<JournalRecord> records;
+    JournalRecord record{};
+    while (reader.next(record)) {
+        records.push_back(record);
+    }
+    ASSERT_EQ(records.size(), 4);
+    EXPECT_EQ(records[0].type, JournalRecordType::NewOrder);
+    EXPECT_EQ(records[1].type, JournalRecordType::Cancel);
+    EXPECT_EQ(records[1].orderId, 1);
+    EXPECT_EQ(records[2].type, JournalRecordType::NewOrder);
+    EXPECT_EQ(records[2].orderId, 2); // The bad side never got an id
+    EXPECT_EQ(records[2].price, 105);
+    EXPECT_EQ(records[3].type, JournalRecordType::Modify);
+    EXPECT_EQ(records[3].price, 104);
+    for (const JournalRecord& each : records) {
+        EXPECT_EQ(each.symbol, records[0].symbol);
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".symbols");
+}
+
+// Test that both sides of a trade hear about it in their own protocol, and that rejects come back too
+TEST_F(TradingSystemTest, ExecutionReportsGoBackToTheirSessions) {
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_system_reports.bin").string();
+    TradingSystemConfig config{};
+    config.orderEntry.address = "127.0.0.1";
+    config.orderEntry.port = 0;
+    config.binaryEntry.address = "127.0.0.1";
+    config.binaryEntry.port = 0;
+    config.journal.path = path;
+    config.journal.truncate = true;
+    config.journal.fsync = JournalFsync::Never;
+    config.recover = false;
+
+    TradingSystem tradingSystem{config};
+    std::thread network{[&tradingSystem] { tradingSystem.startServer(); }};
+    while (tradingSystem.getListeningPort() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    boost::asio::io_context clients;
+    tcp::socket text{clients};
+    text.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getListeningPort()));
+    tcp::socket binary{clients};
+    binary.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getBinaryListeningPort()));
+
+    boost::asio::streambuf textReplies;
+    const auto readLine = [&] {
+        boost::asio::read_until(text, textReplies, '\n');
+        std::istream stream{&textReplies};
+        std::string line;
+        std::getline(stream, line);
+        return line;
+    };
+    const auto readReport = [&] {
+        BinaryReport report{};
+        boost::asio::read(binary, boost::asio::buffer(&report, sizeof(report)));
+        return report;
+    };
+
+    boost::asio::write(text, boost::asio::buffer(std::string_view{"REP SELL LIMIT 100 5\n"}));
+    EXPECT_EQ(readLine(), "ACCEPTED 1 1 100 5");
+
+    // Crosses the text order, the taker's fill comes after its ack
+    boost::asio::write(binary, boost::asio::buffer(asBytes(makeBinaryNewOrder(42, "REP", Side::Buy, OrderType::Limit, 100, 3))));
+    const BinaryReport accepted = readReport();
+    EXPECT_EQ(static_cast<char>(accepted.header.type), 'A');
+    EXPECT_EQ(accepted.clientOrderId, 42);
+    EXPECT_EQ(accepted.orderId, 2);
+    const BinaryReport fill = readReport();
+    EXPECT_EQ(static_cast<char>(fill.header.type), 'E');
+    EXPECT_EQ(fill.clientOrderId, 42);
+    EXPECT_EQ(fill.price, 100);
+    EXPECT_EQ(fill.quantity, 3);
+    EXPECT_EQ(fill.leaves, 0);
+    EXPECT_EQ(readLine(), "FILL 1 1 100 3 2");
+
+    boost::asio::write(text, boost::asio::buffer(std::string_view{"REP CANCEL 1\n"}));
+    EXPECT_EQ(readLine(), "CANCELLED 2 1 2");
+    // Turned down by the Sequencer, not a book, so it isn't ordered against the shard's reports
+    boost::asio::write(text, boost::asio::buffer(std::string_view{"REP BUY SIDEWAYS 1 1\n"}));
+    EXPECT_EQ(readLine().rfind("REJECTED 3 0 ", 0), 0);
+    // A legal command longer than a Command can carry is answered by the network thread instead of dropped
+    boost::asio::write(text, boost::asio::buffer(std::string_view{"ABCDEFGHIJKLMNOP MODIFY 18446744073709551615 4294967295 4294967295\n"}));
+    EXPECT_EQ(readLine(), "REJECTED 4 0 too long");
+
+    std::string oversized(64, '\0');
+    oversized[0] = static_cast<char>(oversized.size());
+    oversized[2] = 'O';
+    oversized[offsetof(BinaryNewOrder, clientOrderId)] = 44;
+    boost::asio::write(binary, boost::asio::buffer(oversized));
+    const BinaryReport tooLong = readReport();
+    EXPECT_EQ(static_cast<char>(tooLong.header.type), 'J');
+    EXPECT_EQ(tooLong.reason, static_cast<uint8_t>(RejectReason::Malformed));
+    EXPECT_EQ(tooLong.parseError, static_cast<uint8_t>(ParseError::TooLong));
+    EXPECT_EQ(tooLong.clientOrderId, 44);
+
+    // Order 2 filled completely, there's nothing left to cancel
+    boost::asio::write(binary, boost::asio::buffer(asBytes(makeBinaryCancel(43, "REP", 2))));
+    const BinaryReport unknown = readReport();
+    EXPECT_EQ(static_cast<char>(unknown.header.type), 'J');
+    EXPECT_EQ(unknown.clientOrderId, 43);
+    EXPECT_EQ(unknown.reason, static_cast<uint8_t>(RejectReason::UnknownOrder));
+
+    tradingSystem.stopServer();
+    network.join();
+    EXPECT_EQ(tradingSystem.getReportsDropped(), 0);
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".symbols");
+}
+
+// Test that a shard over its high water mark gets new orders answered busy while cancels still go through, and that
+// every answer hands its credit back so a session can send far more than its window
+TEST_F(TradingSystemTest, OverloadedShardsAnswerBusy) {
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_system_admission.bin").string();
+    TradingSystemConfig config{};
+    config.orderEntry.address = "127.0.0.1";
+    config.orderEntry.port = 0;
+    config.orderEntry.creditWindow = 4;
+    config.binaryEntry.address = "127.0.0.1";
+    config.binaryEntry.port = 0;
+    config.journal.path = path;
+    config.journal.truncate = true;
+    config.journal.fsync = JournalFsync::Never;
+    config.recover = false;
+    config.admission.highWater = 0.0; // Always over it
+    config.admission.lowWater = 0.0;
+
+    TradingSystem tradingSystem{config};
+    std::thread network{[&tradingSystem] { tradingSystem.startServer(); }};
+    while (tradingSystem.getListeningPort() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    boost::asio::io_context clients;
+    tcp::socket text{clients};
+    text.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getListeningPort()));
+
+    std::string burst;
+    constexpr size_t count = 100;
+    for (size_t i = 0; i < count; ++i) {
+        burst += "LOAD BUY LIMIT 100 1\nLOAD CANCEL 7\n";
+    }
+    boost::asio::write(text, boost::asio::buffer(burst));
+
+    // Answers from the Sequencer and the shard can come in either order, the message number says which is which
+    boost::asio::streambuf replies;
+    size_t busy = 0;
+    size_t unknown = 0;
+    std::set<uint64_t> answered;
+    for (size_t i = 0; i < 2 * count; ++i) {
+        boost::asio::read_until(text, replies, '\n');
+        std::istream stream{&replies};
+        std::string verb;
+        uint64_t sequence = 0;
+        std::string line;
+        stream >> verb >> sequence;
+        std::getline(stream, line);
+        answered.insert(sequence);
+        busy += verb == "REJECTED" && sequence % 2 == 1 && line == " 0 busy";
+        unknown += verb == "REJECTED" && sequence % 2 == 0 && line == " 7 unknown order";
+    }
+    EXPECT_EQ(busy, count);
+    EXPECT_EQ(unknown, count);
+    EXPECT_EQ(answered.size(), 2 * count);
+
+    tradingSystem.stopServer();
+    network.join();
+    const AdmissionStats stats = tradingSystem.getAdmissionStats();
+    EXPECT_EQ(stats.busyAtSequencer, count);
+    EXPECT_EQ(stats.busyAtEntry, 0);
+    EXPECT_EQ(stats.reportsDropped, 0);
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".symbols");
+}
+
+// Test that orders matched together keep their reports in order, a maker's fill never beats its own ack
+TEST_F(TradingSystemTest, BatchedOrdersAckBeforeTheirFills) {
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_system_batched.bin").string();
+    TradingSystemConfig config{};
+    config.orderEntry.address = "127.0.0.1";
+    config.orderEntry.port = 0;
+    config.binaryEntry.address = "127.0.0.1";
+    config.binaryEntry.port = 0;
+    config.journal.path = path;
+    config.journal.truncate = true;
+    config.journal.fsync = JournalFsync::Never;
+    config.recover = false;
+
+    TradingSystem tradingSystem{config};
+    std::thread network{[&tradingSystem] { tradingSystem.startServer(); }};
+    while (tradingSystem.getListeningPort() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    boost::asio::io_context clients;
+    tcp::socket text{clients};
+    text.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getListeningPort()));
+    boost::asio::write(text, boost::asio::buffer(std::string_view{"BAT SELL LIMIT 100 5\nBAT BUY LIMIT 100 3\nBAT BUY IOC 100 4\n"}));
+
+    boost::asio::streambuf replies;
+    std::vector<std::string> lines;
+    while (lines.size() < 8) {
+        boost::asio::read_until(text, replies, '\n');
+        std::istream stream{&replies};
+        std::string line;
+        std::getline(stream, line);
+        lines.push_back(line);
+    }
+    EXPECT_EQ(lines, (std::vector<std::string>{
+        "ACCEPTED 1 1 100 5",
+        "ACCEPTED 2 2 100 3", "FILL 2 2 100 3 0", "FILL 1 1 100 3 2",
+        "ACCEPTED 3 3 100 4", "FILL 3 3 100 2 2", "FILL 1 1 100 2 0", "EXPIRED 3 3 2"}));
+
+    tradingSystem.stopServer();
+    network.join();
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".symbols");
+}
+
+// Test that a Logger lane too small for the load makes matching wait instead of losing journal records
+TEST_F(TradingSystemTest, FullLoggerLaneLosesNothing) {
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_system_logger_stall.bin").string();
+    TradingSystemConfig config{};
+    config.orderEntry.address = "127.0.0.1";
+    config.orderEntry.port = 0;
+    config.binaryEntry.address = "127.0.0.1";
+    config.binaryEntry.port = 0;
+    config.journal.path = path;
+    config.journal.truncate = true;
+    config.journal.fsync = JournalFsync::EveryCommit;
+    config.recover = false;
+    config.pipeline.loggerQueueCapacity = 2;
+
+    constexpr size_t count = 50;
+    {
+        TradingSystem tradingSystem{config};
+        std::thread network{[&tradingSystem] { tradingSystem.startServer(); }};
+        while (tradingSystem.getListeningPort() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        boost::asio::io_context clients;
+        tcp::socket text{clients};
+        text.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getListeningPort()));
+
+        std::string burst;
+        for (size_t i = 0; i < count; ++i) {
+            burst += "LAG BUY LIMIT 100 1\nLAG SELL LIMIT 100 1\n";
+        }
+        boost::asio::write(text, boost::asio::buffer(burst));
+
+        boost::asio::streambuf replies;
+        size_t accepted = 0;
+        while (accepted < 2 * count) {
+            boost::asio::read_until(text, replies, '\n');
+            std::istream stream{&replies};
+            std::string line;
+            std::getline(stream, line);
+            accepted += line.starts_with("ACCEPTED");
+        }
+
+        tradingSystem.stopServer();
+        network.join();
+        EXPECT_EQ(tradingSystem.getAdmissionStats().reportsDropped, 0);
+    }
+
+    JournalReader reader{path};
+    JournalRecord record{};
+    size_t orders = 0;
+    size_t trades = 0;
+    while (reader.next(record)) {
+        orders += record.type == JournalRecordType::NewOrder;
+        trades += record.type == JournalRecordType::Trade;
+    }
+    EXPECT_FALSE(reader.hitGap());
+    EXPECT_EQ(orders, 2 * count);
+    EXPECT_EQ(trades, count);
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".symbols");
+}
+
+#ifndef _WIN32
+// Test that a journal that can't write keeps its records until it can, turning new orders down meanwhile
+TEST_F(TradingSystemTest, FailingJournalKeepsItsRecords) {
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_system_journal_failing.bin").string();
+    TradingSystemConfig config{};
+    config.orderEntry.address = "127.0.0.1";
+    config.orderEntry.port = 0;
+    config.binaryEntry.address = "127.0.0.1";
+    config.binaryEntry.port = 0;
+    config.journal.path = path;
+    config.journal.truncate = true;
+    config.journal.fsync = JournalFsync::Never;
+    config.journal.bufferSize = 4096; // 85 records
+    config.journal.bufferCount = 1;
+    config.recover = false;
+
+    // Past the file size limit writes fail with EFBIG (instead of killing us with SIGXFSZ)
+    rlimit original{};
+    ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &original), 0);
+    const auto previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+    const auto waitForSize = [&path](uintmax_t size) {
+        for (int i = 0; i < 5000 && std::filesystem::file_size(path) < size; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return std::filesystem::file_size(path);
+    };
+
+    constexpr size_t makers = 100;
+    {
+        TradingSystem tradingSystem{config};
+        std::thread network{[&tradingSystem] { tradingSystem.startServer(); }};
+        while (tradingSystem.getListeningPort() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        boost::asio::io_context clients;
+        tcp::socket text{clients};
+        text.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getListeningPort()));
+        std::string burst;
+        for (size_t i = 0; i < makers; ++i) {
+            burst += "SELL LIMIT 100 1\n";
+        }
+        boost::asio::write(text, boost::asio::buffer(burst));
+        ASSERT_EQ(waitForSize(makers * sizeof(JournalRecord)), makers * sizeof(JournalRecord));
+
+        // The taker and its trades are more than the one buffer holds, so the Logger has to commit halfway and can't
+        rlimit limited{original};
+        limited.rlim_cur = makers * sizeof(JournalRecord);
+        ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limited), 0);
+        boost::asio::write(text, boost::asio::buffer(std::string_view{"BUY LIMIT 100 100\n"}));
+        for (int i = 0; i < 5000 && tradingSystem.getAdmissionStats().journalFailures == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_GT(tradingSystem.getAdmissionStats().journalFailures, 0);
+
+        boost::asio::write(text, boost::asio::buffer(std::string_view{"BUY LIMIT 100 1\n"}));
+        boost::asio::streambuf replies;
+        std::string line;
+        while (!line.starts_with("REJECTED")) {
+            boost::asio::read_until(text, replies, '\n');
+            std::istream stream{&replies};
+            std::getline(stream, line);
+        }
+        EXPECT_EQ(line, "REJECTED 102 0 journal failing");
+
+        ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &original), 0);
+        EXPECT_EQ(waitForSize((2 * makers + 1) * sizeof(JournalRecord)), (2 * makers + 1) * sizeof(JournalRecord));
+        tradingSystem.stopServer();
+        network.join();
+    }
+    std::signal(SIGXFSZ, previousHandler);
+
+    JournalReader reader{path};
+    JournalRecord record{};
+    size_t orders = 0;
+    size_t trades = 0;
+    while (reader.next(record)) {
+        orders += record.type == JournalRecordType::NewOrder;
+        trades += record.type == JournalRecordType::Trade;
+    }
+    EXPECT_FALSE(reader.hitGap());
+    EXPECT_EQ(orders, makers + 1);
+    EXPECT_EQ(trades, makers);
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".symbols");
+}
+#endif
+
+// Test that recovery carries on after the last order id handed out, even when the book turned that order down
+TEST_F(TradingSystemTest, RecoveryNeverReissuesTurnedDownIds) {
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_system_turned_down.bin").string();
+    TradingSystemConfig config{};
+    config.orderEntry.address = "127.0.0.1";
+    config.orderEntry.port = 0;
+    config.binaryEntry.address = "127.0.0.1";
+    config.binaryEntry.port = 0;
+    config.journal.path = path;
+    config.journal.fsync = JournalFsync::Never;
+
+    const auto session = [&config](bool truncate, std::string_view orders, size_t answers) {
+        config.journal.truncate = truncate;
+        TradingSystem tradingSystem{config};
+        std::thread network{[&tradingSystem] { tradingSystem.startServer(); }};
+        while (tradingSystem.getListeningPort() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        boost::asio::io_context clients;
+        tcp::socket text{clients};
+        text.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getListeningPort()));
+        boost::asio::write(text, boost::asio::buffer(orders));
+
+        boost::asio::streambuf replies;
+        std::vector<std::string> lines;
+        while (lines.size() < answers) {
+            boost::asio::read_until(text, replies, '\n');
+            std::istream stream{&replies};
+            std::string line;
+            std::getline(stream, line);
+            lines.push_back(line);
+        }
+        tradingSystem.stopServer();
+        network.join();
+        return lines;
+    };
+
+    EXPECT_EQ(session(true, "BUY LIMIT 100 1\nSELL POST 100 1\n", 2), (std::vector<std::string>{"ACCEPTED 1 1 100 1", "REJECTED 2 2 refused"}));
+    EXPECT_EQ(session(false, "BUY LIMIT 99 1\n", 1), (std::vector<std::string>{"ACCEPTED 1 3 99 1"}));
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".symbols");
+}
+
+// Test that recovery only takes well formed lines from the symbol file and never hands out an id it has seen
+TEST_F(TradingSystemTest, RecoverySkipsBadSymbolLines) {
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_system_symbols.bin").string();
+    std::filesystem::remove(path);
+    const std::string symbols = "3 AAPL\ngarbage\n9 MSFT\n12 BAD\x01\n7 GO OG\n";
+    {
+        std::ofstream file{path + ".symbols", std::ios::trunc};
+        file << symbols;
+    }
+
+    TradingSystemConfig config{};
+    config.orderEntry.address = "127.0.0.1";
+    config.orderEntry.port = 0;
+    config.binaryEntry.address = "127.0.0.1";
+    config.binaryEntry.port = 0;
+    config.journal.path = path;
+    config.journal.fsync = JournalFsync::Never;
+    {
+        TradingSystem tradingSystem{config};
+        std::thread network{[&tradingSystem] { tradingSystem.startServer(); }};
+        while (tradingSystem.getListeningPort() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        boost::asio::io_context clients;
+        tcp::socket text{clients};
+        text.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), tradingSystem.getListeningPort()));
+        boost::asio::write(text, boost::asio::buffer(std::string{"AAPL BUY LIMIT 1 1\nNEW BUY LIMIT 1 1\n"}));
+
+        boost::asio::streambuf replies;
+        for (int i = 0; i < 2; ++i) {
+            boost::asio::read_until(text, replies, '\n');
+            std::istream stream{&replies};
+            std::string line;
+            std::getline(stream, line);
+            EXPECT_TRUE(line.starts_with("ACCEPTED")) << line;
+        }
+        tradingSystem.stopServer();
+        network.join();
+    }
+
+    std::ifstream file{path + ".symbols"};
+    const std::string contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    EXPECT_EQ(contents, symbols + "13 NEW\n");
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".symbols");
+}